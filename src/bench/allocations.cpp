@@ -0,0 +1,91 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "bench.h"
+
+/// Counts heap allocations. With glibc, malloc, calloc, realloc and aligned_alloc are replaced (the executable's
+/// definitions come before libc's), so allocations made by C code (stbi_load, fopen) count as well as operator new,
+/// which calls malloc. Elsewhere only operator new can be replaced portably, so only it is counted, and the bench
+/// says so (bench::counts_c_allocations()).
+/// In its own file so the compiler can't inline these into code that uses the standard library's allocators.
+
+/// --- ALLOCATION COUNTING ---
+static std::atomic<size_t> allocations{ 0 };
+
+size_t bench::allocation_count() { return allocations.load(std::memory_order_relaxed); }
+
+#ifdef __GLIBC__
+bool bench::counts_c_allocations() { return true; }
+
+// what glibc's own malloc functions are exported as. free() isn't replaced: glibc's frees all of these
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t size);
+extern "C" void* __libc_memalign(size_t align, size_t size);
+
+extern "C" void* malloc(size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t count, size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+//! @brief Counted even when it grows in place: the caller asked for more memory
+extern "C" void* realloc(void* p, size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+extern "C" void* aligned_alloc(size_t align, size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(align, size);
+}
+
+// malloc and aligned_alloc count them
+static void count_new() {  }
+#else
+bool bench::counts_c_allocations() { return false; }
+
+static void count_new() { allocations.fetch_add(1, std::memory_order_relaxed); }
+#endif
+
+void* operator new(size_t size)
+{
+    count_new();
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+void* operator new[](size_t size) { return ::operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// -- over-aligned (simd::aligned_allocator)
+void* operator new(size_t size, std::align_val_t align)
+{
+    count_new();
+    const auto a = (size_t) align;
+    size = (size + a - 1) / a * a; // aligned_alloc wants a multiple of the alignment
+#ifdef _MSC_VER
+    if (void* p = _aligned_malloc(size ? size : a, a))
+#else
+    if (void* p = std::aligned_alloc(a, size ? size : a))
+#endif
+        return p;
+    throw std::bad_alloc{};
+}
+void* operator new[](size_t size, std::align_val_t align) { return ::operator new(size, align); }
+#ifdef _MSC_VER
+void operator delete(void* p, std::align_val_t) noexcept { _aligned_free(p); }
+#else
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+#endif
+void operator delete[](void* p, std::align_val_t align) noexcept { ::operator delete(p, align); }
+void operator delete(void* p, size_t, std::align_val_t align) noexcept { ::operator delete(p, align); }
+void operator delete[](void* p, size_t, std::align_val_t align) noexcept { ::operator delete(p, align); }
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "bench.h"
+#include "simd.h"
+
+/// Usage: bench [--json] [--filter <text>] [--baseline <file.json>] [--threshold <percent>] [--min-time <ms>] [--res <dir>]
+///     --json       print the results as JSON (save this to a file to use it as a baseline later)
+///     --filter     only run benchmarks whose name contains <text>
+///     --baseline   compare against the results of a previous --json run.
+///                  Exits with 1 if any benchmark is slower than the baseline by more than --threshold percent (default 10)
+///     --min-time   how long to run each benchmark for (default 500 ms)
+///     --res        directory with the test images (default is the repo's res/)
+
+
+namespace bench
+{
+    static std::vector<benchmark>& registry()
+    {
+        static std::vector<benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    void add(std::string name, std::function<void(size_t)> run, size_t bytes_per_op)
+    {
+        registry().push_back({ std::move(name), std::move(run), bytes_per_op });
+    }
+
+    static std::string res_path =
+#ifdef OPENGL_RES_DIR
+        OPENGL_RES_DIR;
+#else
+        "../../res";
+#endif
+    const std::string& resource_path() { return res_path; }
+
+
+    /*! @brief Find how many iterations fill a sample, then take the median of a few samples.
+     *         The median is less affected by the OS interrupting the benchmark than the mean */
+    static result measure(const benchmark& b, std::chrono::nanoseconds min_time)
+    {
+        using clock = std::chrono::steady_clock;
+        constexpr int samples = 5;
+        const auto sample_time = min_time / samples;
+
+        // -- calibrate (also warms up caches and the allocator)
+        size_t iterations = 1;
+        for (;;)
+        {
+            const auto start = clock::now();
+            b.run(iterations);
+            const auto elapsed = clock::now() - start;
+            if (elapsed >= sample_time / 4 || iterations >= (size_t(1) << 40))
+            {
+                const double per_op = std::max(1.0, (double) std::chrono::nanoseconds(elapsed).count() / (double) iterations);
+                iterations = std::max<size_t>(1, size_t((double) sample_time.count() / per_op));
+                break;
+            }
+            iterations *= 8;
+        }
+
+        std::vector<double> ns(samples);
+        size_t allocs = 0;
+        for (double& sample : ns)
+        {
+            const size_t allocs_before = allocation_count();
+            const auto start = clock::now();
+            b.run(iterations);
+            sample = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() / (double) iterations;
+            allocs += allocation_count() - allocs_before;
+        }
+        std::sort(ns.begin(), ns.end());
+
+        const double median = ns[samples / 2];
+        return {
+            b.name, iterations, median,
+            b.bytes_per_op ? (double) b.bytes_per_op / median * 1e9 : 0.0,
+            (double) allocs / (double) (iterations * samples)
+        };
+    }
+
+
+    /// --- OUTPUT ---
+    static std::string json_escape(const std::string& str)
+    {
+        std::string out;
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    static void print_json(std::ostream& os, const std::vector<result>& results)
+    {
+        os << "{\n  \"isa\": \"" << simd::isa() << "\",\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const result& r = results[i];
+            os << "    { \"name\": \"" << json_escape(r.name) << "\", \"iterations\": " << r.iterations
+               << ", \"ns_per_op\": " << r.ns_per_op << ", \"bytes_per_second\": " << r.bytes_per_second
+               << ", \"allocs_per_op\": " << r.allocs_per_op << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        os << "  ]\n}\n";
+    }
+
+    static void print_row(const result& r)
+    {
+        std::cout << std::left << std::setw(48) << r.name << std::right << std::fixed
+                  << std::setw(12) << std::setprecision(2) << r.ns_per_op << " ns/op";
+        if (r.bytes_per_second > 0)
+            std::cout << std::setw(10) << std::setprecision(1) << r.bytes_per_second / (1024 * 1024) << " MiB/s";
+        else
+            std::cout << std::setw(16) << "";
+        std::cout << std::setw(10) << std::setprecision(2) << r.allocs_per_op << (counts_c_allocations() ? " allocs/op\n" : " news/op\n");
+    }
+
+
+    /// --- BASELINE ---
+    /*! @brief Read name -> ns_per_op from a file written by --json.
+     *         Only understands the format print_json() writes, not JSON in general */
+    static std::map<std::string, double> read_baseline(const char* filename)
+    {
+        std::ifstream file{ filename };
+        if (!file)
+        {
+            const std::string error_str = std::string{ "Could not open baseline file \"" } + filename + "\"";
+            std::cerr << error_str << '\n';
+            throw std::invalid_argument{error_str};
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        const std::string json = stream.str();
+
+        std::map<std::string, double> baseline;
+        const std::string name_key = "\"name\": \"", ns_key = "\"ns_per_op\": ";
+        for (size_t pos = json.find(name_key); pos != std::string::npos; pos = json.find(name_key, pos))
+        {
+            pos += name_key.size();
+            std::string name;
+            for (; pos < json.size() && json[pos] != '"'; pos++)
+            {
+                if (json[pos] == '\\')
+                    pos++;
+                name += json[pos];
+            }
+            const size_t ns_pos = json.find(ns_key, pos);
+            if (ns_pos == std::string::npos)
+                break;
+            baseline[name] = std::strtod(json.c_str() + ns_pos + ns_key.size(), nullptr);
+        }
+        return baseline;
+    }
+
+    //! @brief Print the change of every benchmark. @return how many got slower by more than @param threshold percent
+    static int compare(const std::vector<result>& results, const std::map<std::string, double>& baseline, double threshold)
+    {
+        int regressions = 0;
+        std::cerr << "\nCompared to baseline (threshold " << threshold << "%):\n";
+        for (const result& r : results)
+        {
+            const auto it = baseline.find(r.name);
+            std::cerr << std::left << std::setw(48) << r.name << std::right;
+            if (it == baseline.end() || it->second <= 0)
+            {
+                std::cerr << "  (new)\n";
+                continue;
+            }
+            const double change = (r.ns_per_op / it->second - 1) * 100;
+            const bool regressed = change > threshold;
+            regressions += regressed;
+            std::cerr << std::fixed << std::setprecision(1) << std::showpos << std::setw(10) << change << std::noshowpos
+                      << "%" << (regressed ? "  REGRESSION" : change < -threshold ? "  faster" : "") << '\n';
+        }
+        return regressions;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    bool json = false;
+    const char* filter = nullptr;
+    const char* baseline_file = nullptr;
+    double threshold = 10;
+    long min_time_ms = 500;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--json")
+            json = true;
+        else if (arg == "--filter" && has_value)
+            filter = argv[++i];
+        else if (arg == "--baseline" && has_value)
+            baseline_file = argv[++i];
+        else if (arg == "--threshold" && has_value)
+            threshold = std::strtod(argv[++i], nullptr);
+        else if (arg == "--min-time" && has_value)
+            min_time_ms = std::strtol(argv[++i], nullptr, 10);
+        else if (arg == "--res" && has_value)
+            bench::res_path = argv[++i];
+        else
+        {
+            std::cerr << "Unknown argument \"" << arg << "\". See the top of src/bench/bench.cpp for usage\n";
+            return 2;
+        }
+    }
+
+    bench::vec_suite();
+    bench::io_suite();
+    bench::pixel_suite();
+    bench::png_suite();
+    bench::vertex_suite();
+
+    if (!json)
+    {
+        std::cout << "instruction set: " << simd::isa() << '\n';
+        std::cout << "allocations counted: " << (bench::counts_c_allocations() ? "malloc, calloc, realloc, aligned_alloc (and operator new)"
+                                                                                 : "operator new only (news/op)") << '\n';
+    }
+
+    std::vector<bench::result> results;
+    for (const bench::benchmark& b : bench::registry())
+    {
+        if (filter && b.name.find(filter) == std::string::npos)
+            continue;
+        results.push_back(bench::measure(b, std::chrono::milliseconds(min_time_ms)));
+        if (!json)
+            bench::print_row(results.back());
+    }
+
+    if (json)
+        bench::print_json(std::cout, results);
+    if (baseline_file)
+        return bench::compare(results, bench::read_baseline(baseline_file), threshold) > 0 ? 1 : 0;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef OPENGL_BENCH_H
+#define OPENGL_BENCH_H
+#include <cstddef>
+#include <functional>
+#include <string>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// Tiny benchmark harness for the `bench` target. Benchmarks only use the CPU (no window or OpenGL context).
+/// Each suite (bench/*.cpp) registers its benchmarks with bench::add(), and main() (bench/bench.cpp) runs them.
+
+namespace bench
+{
+    struct benchmark
+    {
+        std::string name;
+        //! @brief Run the measured operation @param iterations times
+        std::function<void(size_t iterations)> run;
+        //! @brief How many bytes one operation reads or produces. Used for the bytes/s column (0 to leave it out)
+        size_t bytes_per_op = 0;
+    };
+
+    struct result
+    {
+        std::string name;
+        size_t iterations;
+        double ns_per_op;
+        double bytes_per_second;
+        //! @brief Heap allocations per operation (only operator new's if !counts_c_allocations())
+        double allocs_per_op;
+    };
+
+    void add(std::string name, std::function<void(size_t iterations)> run, size_t bytes_per_op=0);
+
+    //! @brief Keeps the compiler from optimizing away @param val and the work that produced it
+    template<typename Type>
+    inline void do_not_optimize(const Type& val)
+    {
+#ifdef _MSC_VER
+        static const volatile void* sink;
+        sink = &val;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "g"(&val) : "memory");
+#endif
+    }
+
+    //! @brief Number of heap allocations since the program started (see counts_c_allocations())
+    size_t allocation_count();
+    //! @brief Whether allocation_count() has malloc, calloc, realloc and aligned_alloc calls, or only operator new's
+    bool counts_c_allocations();
+
+    //! @brief Directory with the test images (res/)
+    const std::string& resource_path();
+
+    // -- suites
+    void vec_suite();
+    void io_suite();
+    void pixel_suite();
+    void png_suite();
+    void vertex_suite();
+}
+
+
+#endif //OPENGL_BENCH_H
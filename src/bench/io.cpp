@@ -0,0 +1,92 @@
+#include <filesystem>
+#include <fstream>
+#include "bench.h"
+#include "stb_image.h"
+#include "baked-texture.h"
+#include "util.h"
+
+/// File reading (util.cpp), image decoding (the stbi_load call in Texture's constructor)
+/// and mapping baked textures (baked-texture.h), which is what replaces decoding
+
+namespace bench
+{
+    static size_t file_size(const std::string& path)
+    {
+        std::ifstream file{ path, std::ios::binary | std::ios::ate };
+        return file ? (size_t) file.tellg() : 0;
+    }
+
+    static void add_image_benchmarks(const std::string& image)
+    {
+        const std::string path = resource_path() + "/" + image;
+        const size_t size = file_size(path);
+        if (size == 0)
+        {
+            std::cerr << "Skipping " << image << " benchmarks: could not open \"" << path << "\" (see --res)\n";
+            return;
+        }
+
+        add("read_file " + image, [path](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                const std::string content = read_file(path.c_str());
+                do_not_optimize(content);
+            }
+        }, size);
+
+        int width = 0, height = 0, channels = 0;
+        stbi_info(path.c_str(), &width, &height, &channels);
+        const auto decoded_size = size_t(width) * height * channels;
+
+        // what Texture's constructor does: open, read and decode
+        add("stbi_load " + image, [path](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                int w, h, c;
+                unsigned char* data = stbi_load(path.c_str(), &w, &h, &c, 0);
+                do_not_optimize(data);
+                stbi_image_free(data);
+            }
+        }, decoded_size);
+
+        // decoding only, without the file system
+        const std::string encoded = read_file(path.c_str());
+        add("stbi_load_from_memory " + image, [encoded](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                int w, h, c;
+                unsigned char* data = stbi_load_from_memory((const unsigned char*) encoded.data(), (int) encoded.size(),
+                                                            &w, &h, &c, 0);
+                do_not_optimize(data);
+                stbi_image_free(data);
+            }
+        }, decoded_size);
+
+        // what Texture(baked_texture::file) does without GL: map the file, and read every page like glTexImage2D would
+        int w, h, c;
+        unsigned char* pixels = stbi_load(path.c_str(), &w, &h, &c, 0);
+        const std::vector<unsigned char> baked = baked_texture::bake(pixels, w, h, c);
+        stbi_image_free(pixels);
+        const std::string baked_path = (std::filesystem::temp_directory_path() / image).replace_extension(baked_texture::extension).string();
+        std::ofstream{ baked_path, std::ios::binary }.write((const char*) baked.data(), (std::streamsize) baked.size());
+
+        add("baked_texture::file " + image, [baked_path](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                const baked_texture::file file{ baked_path.c_str() };
+                unsigned char sum = 0;
+                for (size_t level = 0; level < file.level_count(); level++)
+                    for (size_t offset = 0; offset < file.level_info(level).size; offset += 4096)
+                        sum += file.pixels(level)[offset];
+                do_not_optimize(sum);
+            }
+        }, decoded_size);
+    }
+
+
+    void io_suite()
+    {
+        add_image_benchmarks("heart.png");
+        add_image_benchmarks("opengl.png");
+    }
+}
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "pixel-ops.h"
+
+/// Preparing decoded images for upload (pixel-ops.h): the SIMD kernels next to their scalar reference,
+/// on a generated image so the numbers don't depend on the files in res/
+
+namespace bench
+{
+    constexpr int image_width = 512;
+    constexpr int image_height = 512;
+    constexpr size_t pixel_count = size_t(image_width) * image_height;
+
+    static std::vector<unsigned char> gen_image(int channels)
+    {
+        std::vector<unsigned char> image(pixel_count * channels);
+        for (size_t i = 0; i < image.size(); i++)
+            image[i] = (unsigned char) (i * 7 + i / 13);
+        return image;
+    }
+
+    //! @brief Benchmark a kernel that only reads @param input, once with pixel_ops (@param op) and once with pixel_ops::scalar (@param scalar_op)
+    template<typename Op, typename ScalarOp>
+    static void add_pair(const std::string& name, int channels, size_t bytes_per_op, Op op, ScalarOp scalar_op)
+    {
+        const std::vector<unsigned char> input = gen_image(channels);
+        add("pixel_ops::" + name, [input, op](size_t iterations) {
+            static std::vector<unsigned char> out(pixel_count * 4);
+            for (size_t i = 0; i < iterations; i++)
+            {
+                op(input.data(), out.data());
+                do_not_optimize(out.data());
+            }
+        }, bytes_per_op);
+        add("pixel_ops::scalar::" + name, [input, scalar_op](size_t iterations) {
+            static std::vector<unsigned char> out(pixel_count * 4);
+            for (size_t i = 0; i < iterations; i++)
+            {
+                scalar_op(input.data(), out.data());
+                do_not_optimize(out.data());
+            }
+        }, bytes_per_op);
+    }
+
+    void pixel_suite()
+    {
+        // -- channel expansion
+        for (int channels = 1; channels <= 3; channels++)
+            add_pair("expand_to_rgba " + std::to_string(channels) + " channels", channels, pixel_count * 4,
+                [channels](const unsigned char* src, unsigned char* dst) { pixel_ops::expand_to_rgba(src, dst, pixel_count, channels); },
+                [channels](const unsigned char* src, unsigned char* dst) { pixel_ops::scalar::expand_to_rgba(src, dst, pixel_count, channels); });
+
+        // -- in place kernels (the input is only the initial content of the buffer, results don't matter)
+        add_pair("premultiply_alpha", 4, pixel_count * 4,
+            [](const unsigned char*, unsigned char* rgba) { pixel_ops::premultiply_alpha(rgba, pixel_count); },
+            [](const unsigned char*, unsigned char* rgba) { pixel_ops::scalar::premultiply_alpha(rgba, pixel_count); });
+        add_pair("flip_vertically", 4, pixel_count * 4,
+            [](const unsigned char*, unsigned char* rgba) { pixel_ops::flip_vertically(rgba, image_width, image_height, 4); },
+            [](const unsigned char*, unsigned char* rgba) { pixel_ops::scalar::flip_vertically(rgba, image_width, image_height, 4); });
+
+        // -- mipmaps (one level: 512x512 -> 256x256)
+        add_pair("downsample box linear", 4, pixel_count * 4,
+            [](const unsigned char* src, unsigned char* dst) { pixel_ops::downsample(src, image_width, image_height, dst, pixel_ops::mip_filter::box, false); },
+            [](const unsigned char* src, unsigned char* dst) { pixel_ops::scalar::downsample(src, image_width, image_height, dst, pixel_ops::mip_filter::box, false); });
+        add_pair("downsample box srgb", 4, pixel_count * 4,
+            [](const unsigned char* src, unsigned char* dst) { pixel_ops::downsample(src, image_width, image_height, dst, pixel_ops::mip_filter::box, true); },
+            [](const unsigned char* src, unsigned char* dst) { pixel_ops::scalar::downsample(src, image_width, image_height, dst, pixel_ops::mip_filter::box, true); });
+        add_pair("downsample kaiser srgb", 4, pixel_count * 4,
+            [](const unsigned char* src, unsigned char* dst) { pixel_ops::downsample(src, image_width, image_height, dst, pixel_ops::mip_filter::kaiser, true); },
+            [](const unsigned char* src, unsigned char* dst) { pixel_ops::scalar::downsample(src, image_width, image_height, dst, pixel_ops::mip_filter::kaiser, true); });
+
+        // whole chain, what the texture loader does for each image
+        const std::vector<unsigned char> image = gen_image(4);
+        add("pixel_ops::generate_mipmaps srgb", [image](size_t iterations) {
+            static std::vector<unsigned char> chain(pixel_ops::mip_chain_size(image_width, image_height));
+            for (size_t i = 0; i < iterations; i++)
+            {
+                std::copy(image.begin(), image.end(), chain.begin());
+                pixel_ops::generate_mipmaps(chain.data(), image_width, image_height, pixel_ops::mip_filter::box, true);
+                do_not_optimize(chain.data());
+            }
+        }, pixel_count * 4);
+    }
+}
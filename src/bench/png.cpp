@@ -0,0 +1,88 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "png.h"
+#include "stb_image.h"
+
+/// PNG decoding (png.h) next to stbi_load_from_memory (see io.cpp), and the unfilter kernels next to their scalar reference.
+/// An image is only benchmarked if png::decode gives exactly the pixels stbi does
+
+namespace bench
+{
+    static void add_decode_benchmark(const std::string& image)
+    {
+        const std::string path = resource_path() + "/" + image;
+        std::vector<unsigned char> encoded;
+        {
+            std::ifstream file{ path, std::ios::binary };
+            encoded.assign(std::istreambuf_iterator<char>(file), {});
+        }
+
+        int width, height, channels;
+        unsigned char* expected = stbi_load_from_memory(encoded.data(), (int) encoded.size(), &width, &height, &channels, 0);
+        png::image decoded;
+        const bool same = expected && png::decode(encoded.data(), encoded.size(), decoded)
+                       && decoded.width == width && decoded.height == height && decoded.channels == channels
+                       && std::memcmp(decoded.pixels.data(), expected, decoded.pixels.size()) == 0;
+        stbi_image_free(expected);
+        if (!same)
+        {
+            std::cerr << "Skipping png::decode " << image << ": not decoded, or different pixels than stbi_load\n";
+            return;
+        }
+
+        add("png::decode " + image, [encoded](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                png::image out;
+                const bool ok = png::decode(encoded.data(), encoded.size(), out);
+                do_not_optimize(ok);
+                do_not_optimize(out.pixels.data());
+            }
+        }, decoded.pixels.size());
+    }
+
+    static void add_unfilter_benchmarks(png::row_filter filter, const std::string& name, int bytes_per_pixel)
+    {
+        constexpr size_t rows = 256;
+        const size_t row_size = 1024 * (size_t) bytes_per_pixel;
+        std::vector<unsigned char> filtered(rows * row_size);
+        for (size_t i = 0; i < filtered.size(); i++)
+            filtered[i] = (unsigned char) (i * 13 + i / 7);
+
+        const auto run = [filtered, filter, row_size, bytes_per_pixel](auto unfilter_row) {
+            return [filtered, filter, row_size, bytes_per_pixel, unfilter_row](size_t iterations) {
+                static std::vector<unsigned char> out(rows * 4 * 1024);
+                static const std::vector<unsigned char> zeros(4 * 1024);
+                for (size_t i = 0; i < iterations; i++)
+                {
+                    for (size_t y = 0; y < rows; y++)
+                        unfilter_row(filter, filtered.data() + y * row_size, y == 0 ? zeros.data() : out.data() + (y - 1) * row_size,
+                                     out.data() + y * row_size, row_size, bytes_per_pixel);
+                    do_not_optimize(out.data());
+                }
+            };
+        };
+        const std::string suffix = name + " " + std::to_string(bytes_per_pixel) + " bytes/pixel";
+        add("png::unfilter_row " + suffix, run(png::unfilter_row), rows * row_size);
+        add("png::scalar::unfilter_row " + suffix, run(png::scalar::unfilter_row), rows * row_size);
+    }
+
+    void png_suite()
+    {
+        add_decode_benchmark("heart.png");
+        add_decode_benchmark("opengl.png");
+
+        for (int bytes_per_pixel : { 3, 4 })
+        {
+            add_unfilter_benchmarks(png::row_filter::sub, "sub", bytes_per_pixel);
+            add_unfilter_benchmarks(png::row_filter::up, "up", bytes_per_pixel);
+            add_unfilter_benchmarks(png::row_filter::average, "average", bytes_per_pixel);
+            add_unfilter_benchmarks(png::row_filter::paeth, "paeth", bytes_per_pixel);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "mat.h"
+
+/// vec and mat arithmetic (vec.tpp, mat.tpp). Every operation reads its operands from arrays of `count` vecs,
+/// so the numbers include loads and stores, like real code does.
+/// "eager" evaluates (materializes) every operator on its own, like the hand-written operators before
+/// vec used expression templates. "fused" is the same expression evaluated by vec.h in one go.
+
+namespace bench
+{
+    constexpr size_t count = 1024; // power of 2, fits in L1
+
+    template<typename Type, size_t N>
+    static std::vector<vec<Type, N>> make_vecs(unsigned int seed)
+    {
+        std::vector<vec<Type, N>> v(count);
+        for (size_t i = 0; i < count; i++)
+            for (unsigned char j = 0; j < N; j++)
+                v[i][j] = Type((i * 7 + j * 3 + seed) % 11 + 1);
+        return v;
+    }
+
+    template<typename Type, size_t N>
+    static void add_vec_benchmarks(const std::string& type_name)
+    {
+        // static: the lambdas below run after this function returns
+        static std::vector<vec<Type, N>> a = make_vecs<Type, N>(1), b = make_vecs<Type, N>(2), c = make_vecs<Type, N>(3);
+        static std::vector<vec<Type, N>> out(count);
+        static constexpr Type s = 3;
+
+        using expr = decltype(a[0] + b[0] * s - c[0]);
+        const std::string temporaries = std::to_string(vec_expr_operations<expr>::value);
+
+        add(type_name + " a + b * s - c  eager (" + temporaries + " temporaries)", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                const size_t j = i & (count - 1);
+                const vec<Type, N> t0 = b[j] * s;
+                const vec<Type, N> t1 = a[j] + t0;
+                out[j] = t1 - c[j];
+            }
+            do_not_optimize(out);
+        }, 4 * sizeof(vec<Type, N>));
+
+        add(type_name + " a + b * s - c  fused (0 temporaries)", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                const size_t j = i & (count - 1);
+                out[j] = a[j] + b[j] * s - c[j];
+            }
+            do_not_optimize(out);
+        }, 4 * sizeof(vec<Type, N>));
+
+        add(type_name + " += a", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+                out[i & (count - 1)] += a[i & (count - 1)];
+            do_not_optimize(out);
+        }, 2 * sizeof(vec<Type, N>));
+
+        add(type_name + " dot_mult", [](size_t iterations) {
+            double sum = 0;
+            for (size_t i = 0; i < iterations; i++)
+                sum += a[i & (count - 1)].dot_mult(b[i & (count - 1)]);
+            do_not_optimize(sum);
+        }, 2 * sizeof(vec<Type, N>));
+
+        add(type_name + " length", [](size_t iterations) {
+            double sum = 0;
+            for (size_t i = 0; i < iterations; i++)
+                sum += a[i & (count - 1)].length();
+            do_not_optimize(sum);
+        }, sizeof(vec<Type, N>));
+
+        add(type_name + " normalized", [](size_t iterations) {
+            double sum = 0;
+            for (size_t i = 0; i < iterations; i++)
+                sum += a[i & (count - 1)].normalized().x;
+            do_not_optimize(sum);
+        }, sizeof(vec<Type, N>));
+
+        if constexpr (N == 3)
+            add(type_name + " cross_mult", [](size_t iterations) {
+                double sum = 0;
+                for (size_t i = 0; i < iterations; i++)
+                    sum += a[i & (count - 1)].cross_mult(b[i & (count - 1)]).z;
+                do_not_optimize(sum);
+            }, 2 * sizeof(vec<Type, N>));
+    }
+
+
+    void vec_suite()
+    {
+        add_vec_benchmarks<float,  3>("vec3<float>");
+        add_vec_benchmarks<float,  4>("vec4<float>");
+        add_vec_benchmarks<int,    3>("vec3<int>");
+        add_vec_benchmarks<double, 2>("vec2<double>");
+
+        static std::vector<vec4<float>> points = make_vecs<float, 4>(4), out(count);
+        static const mat4<float> m = mat4<float>::translation({ 1, 2, 3 }) * mat4<float>::rotation_z(0.5f);
+        add("mat4<float> * vec4<float>", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+                out[i & (count - 1)] = m * points[i & (count - 1)];
+            do_not_optimize(out);
+        }, 2 * sizeof(vec4<float>));
+    }
+}
@@ -0,0 +1,95 @@
+#include <vector>
+#include "bench.h"
+#include "primitive.h"
+#include "mat.h"
+#include "vertex-quantize.h"
+
+/// Vertex generation and conversion between interleaved vertices (what primitive::Shape2D uploads)
+/// and separate attribute streams (vec_stream), and quantization of interleaved vertices (vertex-quantize.h)
+
+namespace bench
+{
+    constexpr size_t vertex_count = 4096;
+    constexpr unsigned int vertex_length = 3 + 4 + 2; // position(3), color(4), tex_coord(2)
+
+    void vertex_suite()
+    {
+        // inputs come from a volatile so the compiler can't generate the vertices at compile time
+        static volatile float input = 0.25f;
+
+        add("Rectangle::gen_vertices", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                const float x = input;
+                const auto vertices = primitive::Rectangle::gen_vertices(x, x, x, x);
+                do_not_optimize(vertices);
+            }
+        }, 4 * 3 * sizeof(float));
+
+        add("mesh_gen::circle<64> at runtime", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                const float radius = input;
+                const auto circle = mesh_gen::circle<64>({ 0, 0 }, radius);
+                do_not_optimize(circle);
+            }
+        }, sizeof(mesh_gen::mesh<65, 3 * 64>::vertices));
+
+        // -- interleaving
+        static std::vector<float> interleaved(vertex_count * vertex_length);
+        for (size_t i = 0; i < interleaved.size(); i++)
+            interleaved[i] = float(i % 97) / 97;
+        static vec3_stream<float> positions;
+        static vec4_stream<float> colors;
+        static vec2_stream<float> tex_coords;
+        positions.from_interleaved(interleaved.data(), vertex_count, vertex_length, 0);
+        colors.from_interleaved(interleaved.data(), vertex_count, vertex_length, 3);
+        tex_coords.from_interleaved(interleaved.data(), vertex_count, vertex_length, 7);
+
+        add("deinterleave 4096 vertices into vec_streams", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                positions.from_interleaved(interleaved.data(), vertex_count, vertex_length, 0);
+                colors.from_interleaved(interleaved.data(), vertex_count, vertex_length, 3);
+                tex_coords.from_interleaved(interleaved.data(), vertex_count, vertex_length, 7);
+                do_not_optimize(positions);
+            }
+        }, vertex_count * vertex_length * sizeof(float));
+
+        add("interleave 4096 vertices from vec_streams", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                positions.to_interleaved(interleaved.data(), vertex_length, 0);
+                colors.to_interleaved(interleaved.data(), vertex_length, 3);
+                tex_coords.to_interleaved(interleaved.data(), vertex_length, 7);
+                do_not_optimize(interleaved);
+            }
+        }, vertex_count * vertex_length * sizeof(float));
+
+        static const mat4<float> m = mat4<float>::translation({ 1, 2, 3 }) * mat4<float>::rotation_z(0.5f);
+        add("mat4::transform_points 4096 interleaved", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                m.transform_points(interleaved.data(), vertex_count, vertex_length);
+                do_not_optimize(interleaved);
+            }
+        }, vertex_count * 3 * sizeof(float));
+
+        add("mat4::transform_points 4096 vec3_stream", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                m.transform_points(positions);
+                do_not_optimize(positions);
+            }
+        }, vertex_count * 3 * sizeof(float));
+
+        // half positions, byte colors and 16-bit tex_coords: 36 -> 16 bytes per vertex
+        add("vertex_quantize::quantize 4096 vertices", [](size_t iterations) {
+            for (size_t i = 0; i < iterations; i++)
+            {
+                const vertex_quantize::vertices quantized = vertex_quantize::quantize(interleaved, vertex_length);
+                do_not_optimize(quantized.data);
+            }
+        }, vertex_count * vertex_length * sizeof(float));
+    }
+}
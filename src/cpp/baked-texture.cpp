@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "baked-texture.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace baked_texture
+{
+    static constexpr size_t level_alignment = 64;
+
+    static size_t align(size_t offset) { return (offset + level_alignment - 1) / level_alignment * level_alignment; }
+
+    std::vector<unsigned char> bake(const unsigned char* pixels, int width, int height, int channels, options opts)
+    {
+        if (width <= 0 || height <= 0 || channels < 1 || channels > 4)
+        {
+            const std::string error_str = "Can't bake a " + std::to_string(width) + "x" + std::to_string(height)
+                                        + " image with " + std::to_string(channels) + " channels";
+            std::cerr << error_str << std::endl;
+            throw std::invalid_argument{error_str};
+        }
+
+        std::vector<unsigned char> chain(pixel_ops::mip_chain_size(width, height));
+        pixel_ops::expand_to_rgba(pixels, chain.data(), (size_t) width * height, channels);
+        if (opts.premultiply_alpha)
+            pixel_ops::premultiply_alpha(chain.data(), (size_t) width * height);
+        pixel_ops::generate_mipmaps(chain.data(), width, height, opts.mipmaps, opts.srgb);
+
+        std::vector<level> levels;
+        for (const pixel_ops::mip_level& l : pixel_ops::mip_levels(width, height))
+            levels.push_back({ 0, l.size, (std::uint32_t) l.width, (std::uint32_t) l.height });
+
+        size_t offset = align(sizeof(header) + levels.size() * sizeof(level));
+        for (level& l : levels)
+        {
+            l.offset = offset;
+            offset = align(offset + l.size);
+        }
+
+        std::vector<unsigned char> out(offset, 0);
+        header head{
+            { magic[0], magic[1], magic[2], magic[3] }, version, (std::uint32_t) width, (std::uint32_t) height,
+            GL_RGBA, GL_UNSIGNED_BYTE, (std::uint32_t) levels.size(), 0
+        };
+        std::memcpy(out.data(), &head, sizeof(head));
+        std::memcpy(out.data() + sizeof(head), levels.data(), levels.size() * sizeof(level));
+        size_t chain_offset = 0;
+        for (const level& l : levels)
+        {
+            std::memcpy(out.data() + l.offset, chain.data() + chain_offset, l.size);
+            chain_offset += l.size;
+        }
+        return out;
+    }
+
+    bool is_baked(std::string_view path)
+    {
+        return path.size() >= extension.size() && path.substr(path.size() - extension.size()) == extension;
+    }
+
+
+    file::file(const char* path)
+    {
+        std::string error_str;
+#ifdef _WIN32
+        const HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER file_size{};
+        if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &file_size))
+            error_str = "Could not open baked texture \"" + std::string{path} + "\"";
+        else if (file_size.QuadPart > 0)
+        {
+            this->mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (this->mapping)
+                this->data = (const unsigned char*) MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0);
+            this->length = (size_t) file_size.QuadPart;
+        }
+        if (handle != INVALID_HANDLE_VALUE)
+            CloseHandle(handle); // the mapping keeps the file open
+#else
+        const int fd = open(path, O_RDONLY);
+        struct stat st{};
+        if (fd < 0 || fstat(fd, &st) != 0)
+            error_str = "Could not open baked texture \"" + std::string{path} + "\"";
+        else if (st.st_size > 0)
+        {
+            void* mapped = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+                this->data = (const unsigned char*) mapped;
+            this->length = (size_t) st.st_size;
+        }
+        if (fd >= 0)
+            close(fd); // the mapping keeps the file open
+#endif
+        if (error_str.empty() && !this->data)
+            error_str = "Could not map baked texture \"" + std::string{path} + "\"";
+
+        // -- check the header and that every level is inside the file
+        if (error_str.empty())
+        {
+            this->head = (const header*) this->data;
+            this->levels = (const level*) (this->data + sizeof(header));
+            if (this->length < sizeof(header) || std::memcmp(this->head->magic, magic, sizeof(magic)) != 0)
+                error_str = "\"" + std::string{path} + "\" is not a baked texture";
+            else if (this->head->version != version)
+                error_str = "Baked texture \"" + std::string{path} + "\" has version " + std::to_string(this->head->version)
+                          + " (expected " + std::to_string(version) + "). Bake it again";
+            // the level sizes below are of 4-byte pixels, so that's the only format the file can have
+            else if (this->head->format != GL_RGBA || this->head->type != GL_UNSIGNED_BYTE)
+                error_str = "Baked texture \"" + std::string{path} + "\" is not GL_RGBA GL_UNSIGNED_BYTE. Bake it again";
+            else if (this->head->levels == 0 || sizeof(header) + this->head->levels * sizeof(level) > this->length)
+                error_str = "Baked texture \"" + std::string{path} + "\" is truncated";
+            else
+                for (size_t i = 0; i < this->head->levels; i++)
+                {
+                    // level 0 is the size of the image, and each level halves the one before, down to 1 (what GL expects of a mip chain)
+                    const level& l = this->levels[i];
+                    if (i >= 32 || l.width != std::max<std::uint32_t>(1, this->head->width >> i)
+                                || l.height != std::max<std::uint32_t>(1, this->head->height >> i))
+                    {
+                        error_str = "Baked texture \"" + std::string{path} + "\" has a level " + std::to_string(i) + " of "
+                                  + std::to_string(l.width) + "x" + std::to_string(l.height) + " pixels";
+                        break;
+                    }
+                    // glTexImage2D reads width * height RGBA pixels
+                    if (l.offset > this->length || l.size > this->length - l.offset || l.size < (std::uint64_t) l.width * l.height * 4)
+                    {
+                        error_str = "Baked texture \"" + std::string{path} + "\" is truncated";
+                        break;
+                    }
+                }
+        }
+
+        if (!error_str.empty())
+        {
+            this->unmap();
+            std::cerr << error_str << std::endl;
+            throw std::invalid_argument{error_str};
+        }
+    }
+
+    file::~file() { this->unmap(); }
+
+    void file::unmap()
+    {
+#ifdef _WIN32
+        if (this->data)
+            UnmapViewOfFile(this->data);
+        if (this->mapping)
+            CloseHandle(this->mapping);
+        this->mapping = nullptr;
+#else
+        if (this->data)
+            munmap((void*) this->data, this->length);
+#endif
+        this->data = nullptr;
+        this->head = nullptr;
+        this->levels = nullptr;
+    }
+
+    const level& file::level_info(size_t i) const
+    {
+        if (i >= this->level_count())
+            throw std::out_of_range{"STD::OUT_OF_RANGE Exception: Baked texture level out of range"};
+        return this->levels[i];
+    }
+
+    const unsigned char* file::pixels(size_t i) const { return this->data + this->level_info(i).offset; }
+}
@@ -0,0 +1,196 @@
+#include <numeric>
+#include <stdexcept>
+#include "batch-renderer.h"
+
+static constexpr unsigned char white_pixel[4] = { 255, 255, 255, 255 };
+
+BatchRenderer::BatchRenderer(size_t max_vertices)
+    : max_vertices(std::max<size_t>(max_vertices, 4)), white(1, 1, 4, white_pixel)
+{
+    this->vertices.reserve(this->max_vertices);
+    this->indices.reserve(this->max_vertices / 4 * 6);
+    this->textures.reserve(texture_slots);
+
+    glGenVertexArrays(1, &this->vertex_array);
+    glGenBuffers(1, &this->vertex_buffer);
+    glGenBuffers(1, &this->element_buffer);
+    gl_state::bind_vertex_array(this->vertex_array);
+    gl_state::bind_buffer(GL_ARRAY_BUFFER, this->vertex_buffer);
+    gl_state::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, this->element_buffer);
+
+    // position(3), color(4), tex_coord(2), texture slot(1): the attribute locations of the shaders
+    constexpr auto stride = (GLsizei) sizeof(batch_vertex);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(batch_vertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(batch_vertex, color));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(batch_vertex, tex_coord));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (void*) offsetof(batch_vertex, texture_slot));
+    glEnableVertexAttribArray(3);
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    gl_state::delete_vertex_arrays(1, &this->vertex_array);
+    gl_state::delete_buffers(1, &this->vertex_buffer);
+    gl_state::delete_buffers(1, &this->element_buffer);
+}
+
+void BatchRenderer::set_shader(ShaderProgram& shader)
+{
+    if (&shader == this->shader)
+        return;
+    if (!this->indices.empty())
+    {
+        this->current.shader_breaks++;
+        this->flush();
+    }
+    this->shader = &shader;
+    this->texture_data = shader.uniform("texture_data");
+    // slot i samples texture unit i
+    std::array<int, texture_slots> units{};
+    std::iota(units.begin(), units.end(), 0);
+    shader.set_uniform(this->texture_data, units);
+}
+
+float BatchRenderer::slot_of(GLuint texture)
+{
+    if (texture == 0)
+        texture = this->white.gl_texture;
+    for (size_t i = 0; i < this->textures.size(); i++)
+        if (this->textures[i] == texture)
+            return (float) i;
+    if (this->textures.size() == texture_slots)
+    {
+        this->current.texture_breaks++;
+        this->flush();
+    }
+    this->textures.push_back(texture);
+    return (float) (this->textures.size() - 1);
+}
+
+void BatchRenderer::reserve(size_t count)
+{
+    if (this->vertices.size() + count > this->max_vertices)
+    {
+        this->current.full_breaks++;
+        this->flush();
+    }
+}
+
+void BatchRenderer::quad(float x, float y, float width, float height, vec4<float> color, GLuint texture,
+                         vec2<float> uv_min, vec2<float> uv_max)
+{
+    this->quad({
+        batch_vertex{ { x,         y + height, 0 }, { color.x, color.y, color.z, color.w }, { uv_min.x, uv_max.y }, 0 }, //    top left
+        batch_vertex{ { x,         y,          0 }, { color.x, color.y, color.z, color.w }, { uv_min.x, uv_min.y }, 0 }, // bottom left
+        batch_vertex{ { x + width, y + height, 0 }, { color.x, color.y, color.z, color.w }, { uv_max.x, uv_max.y }, 0 }, //    top right
+        batch_vertex{ { x + width, y,          0 }, { color.x, color.y, color.z, color.w }, { uv_max.x, uv_min.y }, 0 }  // bottom right
+    }, texture);
+}
+
+void BatchRenderer::quad(float x, float y, float width, float height, vec4<float> color, const Texture& page, const atlas_region& region)
+{
+    this->quad(x, y, width, height, color, page.gl_texture, { region.u_min, region.v_min }, { region.u_max, region.v_max });
+}
+
+void BatchRenderer::quad(const std::array<batch_vertex, 4>& quad_vertices, GLuint texture)
+{
+    this->reserve(4);
+    const float slot = this->slot_of(texture);
+    const auto first = (unsigned int) this->vertices.size();
+    for (batch_vertex v : quad_vertices)
+    {
+        v.texture_slot = slot;
+        this->vertices.push_back(v);
+    }
+    // the same triangles as primitive::Rectangle
+    for (unsigned int i : { 0u, 1u, 3u,  0u, 2u, 3u })
+        this->indices.push_back(first + i);
+    this->current.quads++;
+}
+
+void BatchRenderer::triangle(const std::array<batch_vertex, 3>& triangle_vertices, GLuint texture)
+{
+    this->reserve(3);
+    const float slot = this->slot_of(texture);
+    const auto first = (unsigned int) this->vertices.size();
+    for (batch_vertex v : triangle_vertices)
+    {
+        v.texture_slot = slot;
+        this->vertices.push_back(v);
+    }
+    for (unsigned int i : { 0u, 1u, 2u })
+        this->indices.push_back(first + i);
+    this->current.triangles++;
+}
+
+void BatchRenderer::flush()
+{
+    if (this->indices.empty())
+        return;
+    if (!this->shader)
+    {
+        const char* error_str = "BatchRenderer has nothing to draw with. Call set_shader() first";
+        std::cerr << error_str << std::endl;
+        throw std::invalid_argument{error_str};
+    }
+
+    this->shader->use();
+    for (size_t i = 0; i < this->textures.size(); i++)
+    {
+        gl_state::active_texture(GL_TEXTURE0 + (GLenum) i);
+        gl_state::bind_texture(GL_TEXTURE_2D, this->textures[i]);
+    }
+    gl_state::active_texture(GL_TEXTURE0);
+
+    // new storage for every batch (orphaning), so the upload doesn't wait for the GPU to finish drawing the last one
+    const size_t vertex_bytes = this->vertices.size() * sizeof(batch_vertex);
+    const size_t index_bytes = this->indices.size() * sizeof(unsigned int);
+    gl_state::bind_vertex_array(this->vertex_array);
+    gl_state::bind_buffer(GL_ARRAY_BUFFER, this->vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) vertex_bytes, this->vertices.data(), GL_STREAM_DRAW);
+    gl_state::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, this->element_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr) index_bytes, this->indices.data(), GL_STREAM_DRAW);
+
+    ShaderProgram::flush_in_use();
+    glDrawElements(GL_TRIANGLES, (GLsizei) this->indices.size(), GL_UNSIGNED_INT, nullptr);
+
+    this->current.batches++;
+    this->current.vertices += this->vertices.size();
+    this->current.bytes += vertex_bytes + index_bytes;
+    this->vertices.clear();
+    this->indices.clear();
+    this->textures.clear();
+}
+
+BatchRenderer::stats BatchRenderer::end_frame()
+{
+    this->flush();
+    const stats result = this->current;
+    this->current = {  };
+    return result;
+}
+
+BatchRenderer::stats& BatchRenderer::stats::operator+=(const stats& other)
+{
+    this->batches        += other.batches;
+    this->quads          += other.quads;
+    this->triangles      += other.triangles;
+    this->vertices       += other.vertices;
+    this->shader_breaks  += other.shader_breaks;
+    this->texture_breaks += other.texture_breaks;
+    this->full_breaks    += other.full_breaks;
+    this->bytes          += other.bytes;
+    return *this;
+}
+
+
+std::ostream& operator<<(std::ostream& os, const BatchRenderer::stats& stats)
+{
+    return os << "batches: " << stats.batches << " draws for " << stats.quads << " quads and " << stats.triangles
+              << " triangles (" << stats.vertices << " vertices, " << stats.bytes / 1024 << " KiB), broken by "
+              << stats.shader_breaks << " shader changes, " << stats.texture_breaks << " texture changes and "
+              << stats.full_breaks << " full buffers\n";
+}
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "gl-backend.h"
+#include "gl-trace.h"
+
+namespace gl_backend
+{
+    //! @brief A pointer for every intercepted function, with the same types as glad's pointers
+    struct function_table
+    {
+#define OPENGL_GL_POINTER(kind, ret, name, params, args) decltype(::glad_##name) name = nullptr;
+        OPENGL_GL_FUNCTIONS(OPENGL_GL_POINTER)
+#undef OPENGL_GL_POINTER
+    };
+
+    static bool is_installed = false;
+    static mode installed_mode = mode::null;
+    //! @brief glad's pointers from before install(). Restored by uninstall()
+    static function_table saved;
+    //! @brief Where intercepted calls go: the driver (recording) or the null implementations
+    static function_table backend;
+
+    //! @brief GL_UNPACK_ALIGNMENT as set through glPixelStorei (4 until then, like a new context), for the size of uploads
+    static GLint unpack_alignment = 4;
+
+    static frame_stats current;
+    static frame_stats finished;
+    static size_t frames = 0;
+
+
+    /// --- STATS ---
+    // -- what each kind of function (see OPENGL_GL_FUNCTIONS) adds to the stats, besides the call itself
+    template<typename... Args> static void observe_other(Args...) {  }
+    template<typename... Args> static void observe_state(Args...) { current.state_changes++; }
+
+    static void observe_draw_arrays(GLenum, GLint, GLsizei count)
+    {
+        current.draw_calls++;
+        current.vertices += count;
+    }
+    static void observe_draw_elements(GLenum, GLsizei count, GLenum, const void*)
+    {
+        current.draw_calls++;
+        current.vertices += count;
+    }
+    static void observe_draw_instanced(GLenum, GLsizei count, GLenum, const void*, GLsizei instances)
+    {
+        current.draw_calls++;
+        current.vertices += (size_t) count * instances;
+    }
+    static void observe_pixel_store(GLenum pname, GLint param)
+    {
+        current.state_changes++;
+        if (pname == GL_UNPACK_ALIGNMENT)
+            unpack_alignment = param;
+    }
+    static void observe_buffer_data(GLenum, GLsizeiptr size, const void* data, GLenum)
+    {
+        // only allocates when there is no data
+        if (data)
+            current.bytes_uploaded += size;
+    }
+    static void observe_buffer_sub_data(GLenum, GLintptr, GLsizeiptr size, const void*)
+    {
+        current.bytes_uploaded += size;
+    }
+    static void observe_tex_image_2d(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type,
+                                     const void* pixels)
+    {
+        if (pixels)
+            current.bytes_uploaded += image_size(width, height, format, type, unpack_alignment);
+    }
+    static void observe_tex_sub_image_2d(GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format,
+                                         GLenum type, const void*)
+    {
+        current.bytes_uploaded += image_size(width, height, format, type, unpack_alignment);
+    }
+    // the layers of a 3D image are one after the other, like more rows
+    static void observe_tex_image_3d(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth, GLint, GLenum format,
+                                     GLenum type, const void* pixels)
+    {
+        if (pixels)
+            current.bytes_uploaded += image_size(width, height * depth, format, type, unpack_alignment);
+    }
+    static void observe_tex_sub_image_3d(GLenum, GLint, GLint, GLint, GLint, GLsizei width, GLsizei height, GLsizei depth,
+                                         GLenum format, GLenum type, const void*)
+    {
+        current.bytes_uploaded += image_size(width, height * depth, format, type, unpack_alignment);
+    }
+
+
+    /// --- WRAPPERS ---
+    // What glad's pointers point to while the backend is installed: count the call, then forward it to backend
+    // (through gl_trace while a capture is running)
+#define OPENGL_GL_WRAPPER(kind, ret, name, params, args) \
+    static ret APIENTRY wrap_##name params \
+    { \
+        current.calls++; \
+        current.per_function[(size_t) function::name]++; \
+        observe_##kind args; \
+        if (gl_trace::capturing()) \
+            return gl_trace::capture(function::name, backend.name) args; \
+        return backend.name args; \
+    }
+    OPENGL_GL_FUNCTIONS(OPENGL_GL_WRAPPER)
+#undef OPENGL_GL_WRAPPER
+
+
+    /// --- NULL IMPLEMENTATIONS ---
+    namespace null_gl
+    {
+        //! @brief Every object (buffer, texture, shader, program, etc.) gets a different id, like in a real context
+        static GLuint next_id = 1;
+
+        static void APIENTRY gen(GLsizei n, GLuint* ids)
+        {
+            for (GLsizei i = 0; i < n; i++)
+                ids[i] = next_id++;
+        }
+        static GLuint APIENTRY create_program() { return next_id++; }
+        static GLuint APIENTRY create_shader(GLenum) { return next_id++; }
+
+        //! @brief Everything compiles and links, and has no info log
+        static void APIENTRY get_object_iv(GLuint, GLenum pname, GLint* params)
+        {
+            *params = pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS ? GL_TRUE : 0;
+        }
+        static void APIENTRY get_info_log(GLuint, GLsizei size, GLsizei* length, GLchar* log)
+        {
+            if (length)
+                *length = 0;
+            if (log && size > 0)
+                log[0] = '\0';
+        }
+        static void APIENTRY get_integerv(GLenum, GLint* data) { *data = 0; }
+        //! @brief Writes to a mapped buffer go to memory that is thrown away. One per target, like real mappings
+        static void* APIENTRY map_buffer_range(GLenum target, GLintptr, GLsizeiptr length, GLbitfield)
+        {
+            static std::unordered_map<GLenum, std::vector<unsigned char>> mapped;
+            std::vector<unsigned char>& memory = mapped[target];
+            memory.resize(std::max<size_t>(memory.size(), (size_t) length));
+            return memory.data();
+        }
+        static GLboolean APIENTRY unmap_buffer(GLenum) { return GL_TRUE; }
+        static const GLubyte* APIENTRY get_string(GLenum) { return (const GLubyte*) "null"; }
+
+        template<typename Type> static Type zero() { return Type(); }
+
+        static function_table make_table()
+        {
+            function_table t;
+            // by default, do nothing and return 0
+#define OPENGL_GL_NULL(kind, ret, name, params, args) t.name = [] params -> ret { return zero<ret>(); };
+            OPENGL_GL_FUNCTIONS(OPENGL_GL_NULL)
+#undef OPENGL_GL_NULL
+            t.glGenBuffers         = gen;
+            t.glGenSamplers        = gen;
+            t.glGenTextures        = gen;
+            t.glGenVertexArrays    = gen;
+            t.glCreateProgram      = create_program;
+            t.glCreateShader       = create_shader;
+            t.glGetShaderiv        = get_object_iv;
+            t.glGetProgramiv       = get_object_iv;
+            t.glGetShaderInfoLog   = get_info_log;
+            t.glGetProgramInfoLog  = get_info_log;
+            t.glGetIntegerv        = get_integerv;
+            t.glGetString          = get_string;
+            t.glMapBufferRange     = map_buffer_range;
+            t.glUnmapBuffer        = unmap_buffer;
+            return t;
+        }
+    }
+
+
+
+    void install(mode m)
+    {
+        if (!is_installed)
+        {
+#define OPENGL_GL_SAVE(kind, ret, name, params, args) saved.name = glad_##name;
+            OPENGL_GL_FUNCTIONS(OPENGL_GL_SAVE)
+#undef OPENGL_GL_SAVE
+        }
+
+        if (m == mode::recording)
+        {
+#define OPENGL_GL_CHECK(kind, ret, name, params, args) \
+            if (saved.name == nullptr) \
+            { \
+                const char* error_str = "Cannot record GL calls: " #name " is not loaded. Call gladLoadGLLoader() first."; \
+                std::cerr << error_str; \
+                throw std::invalid_argument{error_str}; \
+            }
+            OPENGL_GL_FUNCTIONS(OPENGL_GL_CHECK)
+#undef OPENGL_GL_CHECK
+            backend = saved;
+        }
+        else
+            backend = null_gl::make_table();
+
+#define OPENGL_GL_INSTALL(kind, ret, name, params, args) glad_##name = wrap_##name;
+        OPENGL_GL_FUNCTIONS(OPENGL_GL_INSTALL)
+#undef OPENGL_GL_INSTALL
+
+        is_installed   = true;
+        installed_mode = m;
+        current  = {  };
+        finished = {  };
+        frames   = 0;
+    }
+
+    void uninstall()
+    {
+        if (!is_installed)
+            return;
+#define OPENGL_GL_RESTORE(kind, ret, name, params, args) glad_##name = saved.name;
+        OPENGL_GL_FUNCTIONS(OPENGL_GL_RESTORE)
+#undef OPENGL_GL_RESTORE
+        is_installed = false;
+    }
+
+    bool installed() { return is_installed; }
+    mode current_mode() { return installed_mode; }
+
+    const frame_stats& frame() { return current; }
+
+    frame_stats end_frame()
+    {
+        const frame_stats result = current;
+        if (gl_trace::capturing())
+            gl_trace::detail::record_end_frame();
+        finished += current;
+        current = {  };
+        frames++;
+        return result;
+    }
+
+    frame_stats totals()
+    {
+        frame_stats result = finished;
+        result += current;
+        return result;
+    }
+
+    size_t frame_count() { return frames; }
+
+    const char* function_name(function f)
+    {
+        static constexpr const char* names[] = {
+#define OPENGL_GL_NAME(kind, ret, name, params, args) #name,
+            OPENGL_GL_FUNCTIONS(OPENGL_GL_NAME)
+#undef OPENGL_GL_NAME
+        };
+        return (size_t) f < function_count ? names[(size_t) f] : "unknown";
+    }
+
+    size_t image_size(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint row_alignment)
+    {
+        size_t channels;
+        switch (format)
+        {
+            case GL_RED:  channels = 1; break;
+            case GL_RG:   channels = 2; break;
+            case GL_RGB:
+            case GL_BGR:  channels = 3; break;
+            default:      channels = 4; break;
+        }
+        size_t channel_size;
+        switch (type)
+        {
+            case GL_UNSIGNED_BYTE:
+            case GL_BYTE:           channel_size = 1; break;
+            case GL_UNSIGNED_SHORT:
+            case GL_SHORT:
+            case GL_HALF_FLOAT:     channel_size = 2; break;
+            default:                channel_size = 4; break;
+        }
+        if (width <= 0 || height <= 0)
+            return 0;
+        const size_t row = (size_t) width * channels * channel_size;
+        const size_t alignment = row_alignment > 0 ? (size_t) row_alignment : 1;
+        const size_t padded_row = (row + alignment - 1) / alignment * alignment;
+        return padded_row * (height - 1) + row;
+    }
+
+    frame_stats& frame_stats::operator+=(const frame_stats& other)
+    {
+        this->calls          += other.calls;
+        this->state_changes  += other.state_changes;
+        this->draw_calls     += other.draw_calls;
+        this->vertices       += other.vertices;
+        this->bytes_uploaded += other.bytes_uploaded;
+        for (size_t i = 0; i < function_count; i++)
+            this->per_function[i] += other.per_function[i];
+        return *this;
+    }
+}
+
+
+std::ostream& operator<<(std::ostream& os, const gl_backend::frame_stats& stats)
+{
+    os << stats.calls << " GL calls, " << stats.state_changes << " state changes, "
+       << stats.draw_calls << " draw calls, " << stats.vertices << " vertices, "
+       << stats.bytes_uploaded << " bytes uploaded\n";
+    for (size_t i = 0; i < gl_backend::function_count; i++)
+        if (stats.per_function[i] != 0)
+            os << "    " << std::left << std::setw(28) << gl_backend::function_name((gl_backend::function) i)
+               << stats.per_function[i] << '\n';
+    return os;
+}
@@ -0,0 +1,194 @@
+#include <array>
+#include "gl-state.h"
+
+namespace gl_state
+{
+    //! @brief Binding that could be anything (after invalidate()), so the next bind always reaches GL
+    static constexpr GLuint unknown = ~GLuint(0);
+
+    static constexpr std::array<GLenum, 3> texture_targets = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP };
+    static constexpr std::array<GLenum, 7> buffer_targets = {
+        GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_PIXEL_PACK_BUFFER,
+        GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GL_UNIFORM_BUFFER
+    };
+
+    //! @brief Index of @param target in @param targets, or targets.size() if it isn't tracked
+    template<size_t N>
+    static size_t index_of(const std::array<GLenum, N>& targets, GLenum target)
+    {
+        size_t i = 0;
+        while (i < N && targets[i] != target)
+            i++;
+        return i;
+    }
+
+    // a new context has everything bound to 0
+    static GLuint program = 0;
+    static GLenum unit = GL_TEXTURE0;
+    static std::array<std::array<GLuint, texture_targets.size()>, max_texture_units> textures{};
+    static std::array<GLuint, max_texture_units> samplers{};
+    static GLuint vertex_array = 0;
+    static std::array<GLuint, buffer_targets.size()> buffers{};
+
+    static stats skip_stats;
+
+
+    void use_program(GLuint p)
+    {
+        if (p == program)
+        {
+            skip_stats.programs_skipped++;
+            return;
+        }
+        glUseProgram(p);
+        program = p;
+        skip_stats.issued++;
+    }
+
+    void active_texture(GLenum u)
+    {
+        if (u == unit)
+        {
+            skip_stats.active_textures_skipped++;
+            return;
+        }
+        glActiveTexture(u);
+        unit = u;
+        skip_stats.issued++;
+    }
+
+    void bind_texture(GLenum target, GLuint texture)
+    {
+        const size_t t = index_of(texture_targets, target);
+        const size_t u = unit - GL_TEXTURE0;
+        if (t < texture_targets.size() && u < max_texture_units)
+        {
+            if (textures[u][t] == texture)
+            {
+                skip_stats.textures_skipped++;
+                return;
+            }
+            textures[u][t] = texture;
+        }
+        glBindTexture(target, texture);
+        skip_stats.issued++;
+    }
+
+    void bind_sampler(GLuint u, GLuint sampler)
+    {
+        if (u < max_texture_units)
+        {
+            if (samplers[u] == sampler)
+            {
+                skip_stats.samplers_skipped++;
+                return;
+            }
+            samplers[u] = sampler;
+        }
+        glBindSampler(u, sampler);
+        skip_stats.issued++;
+    }
+
+    void bind_vertex_array(GLuint array)
+    {
+        if (array == vertex_array)
+        {
+            skip_stats.vertex_arrays_skipped++;
+            return;
+        }
+        glBindVertexArray(array);
+        vertex_array = array;
+        // the element buffer binding is part of the vertex array
+        buffers[index_of(buffer_targets, GL_ELEMENT_ARRAY_BUFFER)] = unknown;
+        skip_stats.issued++;
+    }
+
+    void bind_buffer(GLenum target, GLuint buffer)
+    {
+        const size_t t = index_of(buffer_targets, target);
+        if (t < buffer_targets.size())
+        {
+            if (buffers[t] == buffer)
+            {
+                skip_stats.buffers_skipped++;
+                return;
+            }
+            buffers[t] = buffer;
+        }
+        glBindBuffer(target, buffer);
+        skip_stats.issued++;
+    }
+
+
+    void delete_program(GLuint p)
+    {
+        // a program that is in use stays in use, but its name can be given to a new program
+        glDeleteProgram(p);
+        if (program == p)
+            program = unknown;
+    }
+
+    void delete_textures(GLsizei n, const GLuint* ids)
+    {
+        glDeleteTextures(n, ids);
+        for (GLsizei i = 0; i < n; i++)
+            for (auto& unit_textures : textures)
+                for (GLuint& texture : unit_textures)
+                    if (texture == ids[i])
+                        texture = 0;
+    }
+
+    void delete_samplers(GLsizei n, const GLuint* ids)
+    {
+        glDeleteSamplers(n, ids);
+        for (GLsizei i = 0; i < n; i++)
+            for (GLuint& sampler : samplers)
+                if (sampler == ids[i])
+                    sampler = 0;
+    }
+
+    void delete_vertex_arrays(GLsizei n, const GLuint* ids)
+    {
+        glDeleteVertexArrays(n, ids);
+        for (GLsizei i = 0; i < n; i++)
+            if (vertex_array == ids[i])
+            {
+                vertex_array = 0;
+                buffers[index_of(buffer_targets, GL_ELEMENT_ARRAY_BUFFER)] = unknown;
+            }
+    }
+
+    void delete_buffers(GLsizei n, const GLuint* ids)
+    {
+        glDeleteBuffers(n, ids);
+        for (GLsizei i = 0; i < n; i++)
+            for (GLuint& buffer : buffers)
+                if (buffer == ids[i])
+                    buffer = 0;
+    }
+
+
+    void invalidate()
+    {
+        program = unknown;
+        unit    = unknown;
+        for (auto& unit_textures : textures)
+            unit_textures.fill(unknown);
+        samplers.fill(unknown);
+        vertex_array = unknown;
+        buffers.fill(unknown);
+    }
+
+    const stats& counters() { return skip_stats; }
+    void reset_counters() { skip_stats = {  }; }
+}
+
+
+std::ostream& operator<<(std::ostream& os, const gl_state::stats& stats)
+{
+    return os << stats.skipped() << " redundant binds skipped (" << stats.programs_skipped << " programs, "
+              << stats.active_textures_skipped << " texture units, " << stats.textures_skipped << " textures, "
+              << stats.samplers_skipped << " samplers, "
+              << stats.vertex_arrays_skipped << " vertex arrays, " << stats.buffers_skipped << " buffers), "
+              << stats.issued << " issued\n";
+}
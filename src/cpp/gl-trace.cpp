@@ -0,0 +1,710 @@
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "gl-trace.h"
+
+namespace gl_trace
+{
+    static constexpr char          magic[8]  = { 'G', 'L', 'T', 'R', 'A', 'C', 'E', '\0' };
+    static constexpr std::uint32_t version   = 1;
+    static constexpr std::uint16_t end_frame = 0xFFFF;
+    //! @brief Most arguments any intercepted function has (glTexSubImage3D)
+    static constexpr size_t max_args = 11;
+
+    //! @brief Where the data behind a pointer argument is and how big it is
+    struct pointer_data
+    {
+        pointer_kind kind;
+        size_t size = 0;
+    };
+
+    //! @brief Number of values glGetIntegerv writes for @param pname. The output is the caller's, so never more than it has
+    static size_t integers_of(GLenum pname)
+    {
+        switch (pname)
+        {
+            case GL_COLOR_CLEAR_VALUE:
+            case GL_COLOR_WRITEMASK:
+            case GL_SCISSOR_BOX:
+            case GL_VIEWPORT:             return 4;
+            case GL_ALIASED_LINE_WIDTH_RANGE:
+            case GL_DEPTH_RANGE:
+            case GL_MAX_VIEWPORT_DIMS:
+            case GL_POLYGON_MODE:         return 2;
+            // e.g. GL_NUM_EXTENSIONS and GL_NUM_PROGRAM_BINARY_FORMATS, the ones the repo asks for
+            default:                      return 1;
+        }
+    }
+
+    /*! @brief How to store pointer argument @param arg of @param f, given all its arguments in @param slots.
+     *  @param unpack_alignment the current GL_UNPACK_ALIGNMENT, for the size of pixel data */
+    static pointer_data pointer_data_of(gl_backend::function f, size_t arg, const std::uint64_t* slots, GLint unpack_alignment)
+    {
+        using gl_backend::function;
+        const auto as = [slots](size_t i) { return detail::from_slot<GLint>(slots[i]); };
+        switch (f)
+        {
+            case function::glBufferData:         return { pointer_kind::input, (size_t) detail::from_slot<GLsizeiptr>(slots[1]) };
+            case function::glBufferSubData:      return { pointer_kind::input, (size_t) detail::from_slot<GLsizeiptr>(slots[2]) };
+            case function::glDeleteBuffers:
+            case function::glDeleteSamplers:
+            case function::glDeleteTextures:
+            case function::glDeleteVertexArrays: return { pointer_kind::input, as(0) * sizeof(GLuint) };
+            case function::glGenBuffers:
+            case function::glGenSamplers:
+            case function::glGenTextures:
+            case function::glGenVertexArrays:    return { pointer_kind::output, as(0) * sizeof(GLuint) };
+            // indices/attributes come from the bound buffers
+            case function::glDrawElements:
+            case function::glDrawElementsInstanced:
+            case function::glVertexAttribPointer: return { pointer_kind::offset };
+            case function::glGetIntegerv:        return { pointer_kind::output, integers_of((GLenum) as(0)) * sizeof(GLint) };
+            // every program and shader parameter of GL 3.3 is one value
+            case function::glGetProgramiv:
+            case function::glGetShaderiv:        return { pointer_kind::output, sizeof(GLint) };
+            case function::glGetProgramInfoLog:
+            case function::glGetShaderInfoLog:   return arg == 2 ? pointer_data{ pointer_kind::output, sizeof(GLsizei) }
+                                                                 : pointer_data{ pointer_kind::output, (size_t) as(1) };
+            case function::glGetUniformLocation:
+                return { pointer_kind::input, std::strlen(detail::from_slot<const char*>(slots[1])) + 1 };
+            // the size depends on the uniform's type, which the call doesn't have. Callers have room for a mat4
+            case function::glGetUniformfv:
+            case function::glGetUniformiv:
+            case function::glGetUniformuiv:      return { pointer_kind::output, 16 * sizeof(GLfloat) };
+            // the lengths (arg 3) are written with the strings
+            case function::glShaderSource:       return { arg == 2 ? pointer_kind::strings : pointer_kind::null };
+            case function::glTexImage2D:
+                return { pointer_kind::input, gl_backend::image_size(as(3), as(4), as(6), as(7), unpack_alignment) };
+            case function::glTexSubImage2D:
+                return { pointer_kind::input, gl_backend::image_size(as(4), as(5), as(6), as(7), unpack_alignment) };
+            // the layers are one after the other, like more rows
+            case function::glTexImage3D:
+                return { pointer_kind::input, gl_backend::image_size(as(3), as(4) * as(5), as(7), as(8), unpack_alignment) };
+            case function::glTexSubImage3D:
+                return { pointer_kind::input, gl_backend::image_size(as(5), as(6) * as(7), as(8), as(9), unpack_alignment) };
+            case function::glSamplerParameterfv:
+            case function::glTexParameterfv:
+                return { pointer_kind::input, (as(1) == GL_TEXTURE_BORDER_COLOR ? 4 : 1) * sizeof(GLfloat) };
+            case function::glGetActiveUniform:   return arg == 6 ? pointer_data{ pointer_kind::output, (size_t) as(2) }
+                                                                 : pointer_data{ pointer_kind::output, sizeof(GLint) };
+            // 4 byte values (float, int or uint), count * components of them
+            case function::glUniform1fv:
+            case function::glUniform1iv:
+            case function::glUniform1uiv:        return { pointer_kind::input, as(1) * 1 * sizeof(GLfloat) };
+            case function::glUniform2fv:
+            case function::glUniform2iv:
+            case function::glUniform2uiv:        return { pointer_kind::input, as(1) * 2 * sizeof(GLfloat) };
+            case function::glUniform3fv:
+            case function::glUniform3iv:
+            case function::glUniform3uiv:        return { pointer_kind::input, as(1) * 3 * sizeof(GLfloat) };
+            case function::glUniform4fv:
+            case function::glUniform4iv:
+            case function::glUniform4uiv:        return { pointer_kind::input, as(1) * 4 * sizeof(GLfloat) };
+            case function::glUniformMatrix2fv:   return { pointer_kind::input, as(1) * 4 * sizeof(GLfloat) };
+            case function::glUniformMatrix3fv:   return { pointer_kind::input, as(1) * 9 * sizeof(GLfloat) };
+            case function::glUniformMatrix4fv:   return { pointer_kind::input, as(1) * 16 * sizeof(GLfloat) };
+            default:                             return { pointer_kind::null };
+        }
+    }
+
+
+    /// --- CAPTURE ---
+    static std::ofstream out;
+    static bool active = false;
+    //! @brief Bytes written so far, to align data
+    static size_t position = 0;
+    static GLint unpack_alignment = 4;
+    //! @brief Buffer bound to GL_PIXEL_UNPACK_BUFFER: while there is one, pixel pointers are offsets into it
+    static GLuint unpack_buffer = 0;
+    //! @brief Range returned by the last glMapBufferRange of each target, and what it held before glUnmapBuffer
+    struct mapping
+    {
+        GLenum target;
+        const unsigned char* data;
+        size_t size;
+    };
+    static std::vector<mapping> mappings;
+    static std::vector<unsigned char> unmapped;
+
+    static void write(const void* data, size_t size)
+    {
+        out.write((const char*) data, (std::streamsize) size);
+        position += size;
+    }
+    template<typename Type>
+    static void write_value(Type val) { write(&val, sizeof(Type)); }
+
+    //! @brief Size, then @param size bytes of @param data starting at a multiple of 8
+    static void write_data(const void* data, size_t size)
+    {
+        static constexpr char padding[8] = {  };
+        write_value((std::uint32_t) size);
+        write(padding, (8 - position % 8) % 8);
+        write(data, size);
+    }
+
+    static void write_pointer(gl_backend::function f, size_t arg, const std::uint64_t* slots)
+    {
+        const void* ptr = detail::from_slot<const void*>(slots[arg]);
+        pointer_data data = pointer_data_of(f, arg, slots, unpack_alignment);
+        const bool reads_pixels = f == gl_backend::function::glTexImage2D || f == gl_backend::function::glTexSubImage2D
+                               || f == gl_backend::function::glTexImage3D || f == gl_backend::function::glTexSubImage3D;
+        if (reads_pixels && unpack_buffer != 0)
+            data.kind = pointer_kind::offset;
+        if (ptr == nullptr && data.kind != pointer_kind::offset)
+            data.kind = pointer_kind::null;
+
+        write_value(data.kind);
+        switch (data.kind)
+        {
+            case pointer_kind::null:
+                break;
+            case pointer_kind::offset:
+                write_value(slots[arg]);
+                break;
+            case pointer_kind::input:
+            case pointer_kind::output:
+                write_data(ptr, data.size);
+                break;
+            case pointer_kind::strings:
+            {
+                // glShaderSource(shader, count, strings, lengths): a null length (or a negative one) means null-terminated
+                const auto count   = detail::from_slot<GLsizei>(slots[1]);
+                const auto strings = detail::from_slot<const GLchar* const*>(slots[2]);
+                const auto lengths = detail::from_slot<const GLint*>(slots[3]);
+                write_value((std::uint32_t) count);
+                for (GLsizei i = 0; i < count; i++)
+                {
+                    const size_t length = lengths && lengths[i] >= 0 ? (size_t) lengths[i] : std::strlen(strings[i]);
+                    // stored with a null terminator, so replay doesn't need the lengths
+                    std::string str{ strings[i], length };
+                    write_data(str.c_str(), length + 1);
+                }
+                break;
+            }
+        }
+    }
+
+    void start_capture(const char* filename)
+    {
+        stop_capture();
+        if (!gl_backend::installed())
+        {
+            const char* error_str = "Cannot capture GL calls: gl_backend is not installed";
+            std::cerr << error_str << '\n';
+            throw std::invalid_argument{error_str};
+        }
+        out.open(filename, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            const std::string error_str = std::string{ "Could not create trace file \"" } + filename + "\"";
+            std::cerr << error_str << '\n';
+            throw std::invalid_argument{error_str};
+        }
+
+        position = 0;
+        unpack_alignment = 4;
+        unpack_buffer = 0;
+        mappings.clear();
+        write(magic, sizeof(magic));
+        write_value(version);
+        write_value((std::uint32_t) gl_backend::function_count);
+        for (size_t i = 0; i < gl_backend::function_count; i++)
+        {
+            const std::string_view name = gl_backend::function_name((gl_backend::function) i);
+            write_value((std::uint8_t) name.size());
+            write(name.data(), name.size());
+        }
+        active = true;
+    }
+
+    void stop_capture()
+    {
+        if (!active)
+            return;
+        active = false;
+        out.close();
+    }
+
+    bool capturing() { return active; }
+
+    void detail::record(gl_backend::function f, const std::uint64_t* slots, const unsigned char* sizes, size_t count,
+                        const std::uint64_t* result, unsigned char result_size)
+    {
+        using gl_backend::function;
+        if (f == function::glPixelStorei && from_slot<GLenum>(slots[0]) == GL_UNPACK_ALIGNMENT)
+            unpack_alignment = from_slot<GLint>(slots[1]);
+        else if (f == function::glBindBuffer && from_slot<GLenum>(slots[0]) == GL_PIXEL_UNPACK_BUFFER)
+            unpack_buffer = from_slot<GLuint>(slots[1]);
+        else if (f == function::glDeleteBuffers)
+        {
+            // deleting the bound buffer unbinds it
+            const auto ids = from_slot<const GLuint*>(slots[1]);
+            for (GLsizei i = 0; i < from_slot<GLsizei>(slots[0]); i++)
+                if (ids[i] == unpack_buffer)
+                    unpack_buffer = 0;
+        }
+        else if (f == function::glMapBufferRange)
+        {
+            const auto target = from_slot<GLenum>(slots[0]);
+            std::erase_if(mappings, [target](const mapping& m) { return m.target == target; });
+            mappings.push_back({ target, from_slot<const unsigned char*>(*result), (size_t) from_slot<GLsizeiptr>(slots[2]) });
+        }
+
+        write_value((std::uint16_t) f);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (sizes[i] != 0)
+                write(&slots[i], sizes[i]);
+            else
+                write_pointer(f, i, slots);
+        }
+        if (result_size != 0)
+            write(result, result_size);
+        if (f == function::glUnmapBuffer)
+            write_data(unmapped.data(), unmapped.size());
+    }
+
+    void detail::record_end_frame() { write_value(end_frame); }
+
+    void detail::prepare(gl_backend::function f, const std::uint64_t* slots)
+    {
+        if (f != gl_backend::function::glUnmapBuffer)
+            return;
+        // the range is gone after the call
+        unmapped.clear();
+        const auto target = from_slot<GLenum>(slots[0]);
+        for (const mapping& m : mappings)
+            if (m.target == target && m.data)
+                unmapped.assign(m.data, m.data + m.size);
+        std::erase_if(mappings, [target](const mapping& m) { return m.target == target; });
+    }
+
+
+    /// --- REPLAY ---
+    //! @brief Kinds of names (ids) that the driver picks, so they can be different when replaying
+    enum class object : unsigned char
+    {
+        none, buffer, texture, vertex_array, shader, program,
+        //! @brief Uniform location. Only unique within a program
+        location,
+        sampler,
+    };
+    static constexpr size_t object_kinds = 8;
+
+    //! @brief What kind of object argument @param arg of @param f names
+    static object object_of(gl_backend::function f, size_t arg)
+    {
+        using gl_backend::function;
+        switch (f)
+        {
+            case function::glAttachShader:       return arg == 0 ? object::program : object::shader;
+            case function::glBindBuffer:         return arg == 1 ? object::buffer : object::none;
+            case function::glBindSampler:        return arg == 1 ? object::sampler : object::none;
+            case function::glBindTexture:        return arg == 1 ? object::texture : object::none;
+            case function::glDeleteBuffers:
+            case function::glGenBuffers:         return arg == 1 ? object::buffer : object::none;
+            case function::glDeleteSamplers:
+            case function::glGenSamplers:        return arg == 1 ? object::sampler : object::none;
+            case function::glSamplerParameterfv:
+            case function::glSamplerParameteri:  return arg == 0 ? object::sampler : object::none;
+            case function::glDeleteTextures:
+            case function::glGenTextures:        return arg == 1 ? object::texture : object::none;
+            case function::glDeleteVertexArrays:
+            case function::glGenVertexArrays:    return arg == 1 ? object::vertex_array : object::none;
+            case function::glBindVertexArray:    return arg == 0 ? object::vertex_array : object::none;
+            case function::glCompileShader:
+            case function::glDeleteShader:
+            case function::glGetShaderInfoLog:
+            case function::glGetShaderiv:
+            case function::glShaderSource:       return arg == 0 ? object::shader : object::none;
+            case function::glDeleteProgram:
+            case function::glGetActiveUniform:
+            case function::glGetProgramInfoLog:
+            case function::glGetProgramiv:
+            case function::glGetUniformLocation:
+            case function::glGetUniformfv:
+            case function::glGetUniformiv:
+            case function::glGetUniformuiv:
+            case function::glLinkProgram:
+            case function::glUseProgram:         return arg == 0 ? object::program : object::none;
+            case function::glUniform1f:
+            case function::glUniform1fv:
+            case function::glUniform1i:
+            case function::glUniform1iv:
+            case function::glUniform1uiv:
+            case function::glUniform2f:
+            case function::glUniform2fv:
+            case function::glUniform2iv:
+            case function::glUniform2uiv:
+            case function::glUniform3f:
+            case function::glUniform3fv:
+            case function::glUniform3iv:
+            case function::glUniform3uiv:
+            case function::glUniform4f:
+            case function::glUniform4fv:
+            case function::glUniform4iv:
+            case function::glUniform4uiv:
+            case function::glUniformMatrix2fv:
+            case function::glUniformMatrix3fv:
+            case function::glUniformMatrix4fv:   return arg == 0 ? object::location : object::none;
+            default:                             return object::none;
+        }
+    }
+
+    //! @brief What kind of object the return value of @param f names
+    static object result_object_of(gl_backend::function f)
+    {
+        switch (f)
+        {
+            case gl_backend::function::glCreateProgram:      return object::program;
+            case gl_backend::function::glCreateShader:       return object::shader;
+            case gl_backend::function::glGetUniformLocation: return object::location;
+            default:                                         return object::none;
+        }
+    }
+
+    //! @brief A decoded call
+    struct call
+    {
+        gl_backend::function f;
+        unsigned char arg_count = 0;
+        //! @brief Arguments as captured. Input data and strings point into the trace, outputs to what was captured
+        std::array<std::uint64_t, max_args> slots{};
+        std::array<pointer_kind, max_args> pointers{};
+        std::array<object, max_args> objects{};
+        //! @brief Bytes behind each input/output pointer
+        std::array<std::uint32_t, max_args> sizes{};
+        object result_object = object::none;
+        //! @brief Captured return value
+        std::uint64_t result = 0;
+        //! @brief What glUnmapBuffer's mapped range held, in the trace
+        const unsigned char* unmapped = nullptr;
+        std::uint32_t unmapped_size = 0;
+    };
+
+    //! @brief Reads the trace file from memory
+    struct reader
+    {
+        const unsigned char* data;
+        size_t size;
+        size_t pos = 0;
+
+        [[nodiscard]] bool done() const { return this->pos >= this->size; }
+
+        const unsigned char* take(size_t count)
+        {
+            if (count > this->size - this->pos)
+            {
+                const char* error_str = "Trace file ends in the middle of a call";
+                std::cerr << error_str << '\n';
+                throw std::invalid_argument{error_str};
+            }
+            const unsigned char* ptr = this->data + this->pos;
+            this->pos += count;
+            return ptr;
+        }
+        void read(void* dst, size_t count) { std::memcpy(dst, this->take(count), count); }
+        template<typename Type>
+        Type read_value()
+        {
+            Type val;
+            this->read(&val, sizeof(Type));
+            return val;
+        }
+        //! @brief Data written by write_data()
+        std::pair<const unsigned char*, std::uint32_t> read_data()
+        {
+            const auto size = this->read_value<std::uint32_t>();
+            this->take((8 - this->pos % 8) % 8);
+            return { this->take(size), size };
+        }
+    };
+
+    struct replayer::state
+    {
+        //! @brief The whole file, as 64 bit words so the data in it is aligned
+        std::vector<std::uint64_t> file;
+        std::vector<std::vector<call>> frames;
+        //! @brief The last frame has no end_frame()
+        bool partial = false;
+        //! @brief String arrays of glShaderSource calls. Moving a vector doesn't move its data, so calls can point to them
+        std::vector<std::vector<const char*>> string_arrays;
+        //! @brief Where outputs (and remapped id arrays) of each argument go
+        std::array<std::vector<std::uint64_t>, max_args> scratch;
+        //! @brief Captured id -> id during replay, for each kind of object.
+        //!        Locations are keyed by (captured program << 32 | location)
+        std::array<std::unordered_map<std::uint64_t, std::uint64_t>, object_kinds> ids;
+        //! @brief Program used by the trace (captured id), for mapping uniform locations
+        std::uint64_t program = 0;
+        //! @brief Range mapped by the last glMapBufferRange of each target during replay
+        std::unordered_map<GLenum, unsigned char*> mapped;
+        std::array<call_timing, gl_backend::function_count> timings{};
+
+        template<typename Ret, typename... Args>
+        void decode(reader& r, call& c, Ret (APIENTRYP)(Args...))
+        {
+            static constexpr std::array<unsigned char, sizeof...(Args)> sizes{ detail::slot_size<Args>()... };
+            c.arg_count = sizeof...(Args);
+            for (size_t i = 0; i < sizes.size(); i++)
+            {
+                c.objects[i] = object_of(c.f, i);
+                if (sizes[i] != 0)
+                {
+                    r.read(&c.slots[i], sizes[i]);
+                    continue;
+                }
+                c.pointers[i] = r.read_value<pointer_kind>();
+                switch (c.pointers[i])
+                {
+                    case pointer_kind::null:
+                        break;
+                    case pointer_kind::offset:
+                        c.slots[i] = r.read_value<std::uint64_t>();
+                        break;
+                    case pointer_kind::input:
+                    case pointer_kind::output:
+                    {
+                        const auto [data, size] = r.read_data();
+                        c.slots[i] = detail::to_slot(data);
+                        c.sizes[i] = size;
+                        auto& scratch = this->scratch[i];
+                        scratch.resize(std::max<size_t>(scratch.size(), (size + 7) / 8));
+                        break;
+                    }
+                    case pointer_kind::strings:
+                    {
+                        std::vector<const char*> strings(r.read_value<std::uint32_t>());
+                        for (const char*& str : strings)
+                            str = (const char*) r.read_data().first;
+                        c.slots[i] = detail::to_slot(strings.data());
+                        this->string_arrays.push_back(std::move(strings));
+                        break;
+                    }
+                    default:
+                    {
+                        const char* error_str = "Trace file has an unknown pointer kind";
+                        std::cerr << error_str << '\n';
+                        throw std::invalid_argument{error_str};
+                    }
+                }
+            }
+            if constexpr (!std::is_void_v<Ret>)
+                if constexpr (detail::slot_size<Ret>() != 0)
+                    r.read(&c.result, detail::slot_size<Ret>());
+            c.result_object = result_object_of(c.f);
+            if (c.f == gl_backend::function::glUnmapBuffer)
+                std::tie(c.unmapped, c.unmapped_size) = r.read_data();
+        }
+
+        [[nodiscard]] std::uint64_t key(object o, std::uint64_t captured) const
+        {
+            return o == object::location ? this->program << 32 | (captured & 0xFFFFFFFF) : captured;
+        }
+        [[nodiscard]] std::uint64_t map(object o, std::uint64_t captured) const
+        {
+            const auto& ids = this->ids[(size_t) o];
+            const auto it = ids.find(this->key(o, captured));
+            // ids that weren't created in the trace (0, location -1, etc.) stay the same
+            return it == ids.end() ? captured : it->second;
+        }
+    };
+
+    template<typename Ret, typename... Args, size_t... I>
+    static std::uint64_t invoke(Ret (APIENTRYP fn)(Args...), const std::uint64_t* args, std::index_sequence<I...>)
+    {
+        if constexpr (std::is_void_v<Ret>)
+        {
+            fn(detail::from_slot<Args>(args[I])...);
+            return 0;
+        }
+        else
+            return detail::to_slot(fn(detail::from_slot<Args>(args[I])...));
+    }
+    template<typename Ret, typename... Args>
+    static std::uint64_t invoke(Ret (APIENTRYP fn)(Args...), const std::uint64_t* args)
+    {
+        return invoke(fn, args, std::index_sequence_for<Args...>{});
+    }
+
+
+    replayer::replayer(const char* filename)
+        : s{ std::make_unique<state>() }
+    {
+        std::ifstream file{ filename, std::ios::binary | std::ios::ate };
+        if (!file)
+        {
+            const std::string error_str = std::string{ "Could not open trace file \"" } + filename + "\"";
+            std::cerr << error_str << '\n';
+            throw std::invalid_argument{error_str};
+        }
+        const auto size = (size_t) file.tellg();
+        this->s->file.resize((size + 7) / 8);
+        file.seekg(0);
+        file.read((char*) this->s->file.data(), (std::streamsize) size);
+
+        reader r{ (const unsigned char*) this->s->file.data(), size };
+        char file_magic[sizeof(magic)];
+        r.read(file_magic, sizeof(magic));
+        if (std::memcmp(file_magic, magic, sizeof(magic)) != 0 || r.read_value<std::uint32_t>() != version)
+        {
+            const std::string error_str = std::string{ "\"" } + filename + "\" is not a GL trace (or is from another version)";
+            std::cerr << error_str << '\n';
+            throw std::invalid_argument{error_str};
+        }
+
+        // functions are stored by index, so map the indices of the file to the current ones by name
+        std::vector<gl_backend::function> functions(r.read_value<std::uint32_t>());
+        for (gl_backend::function& f : functions)
+        {
+            const auto length = r.read_value<std::uint8_t>();
+            const std::string_view name{ (const char*) r.take(length), length };
+            size_t i = 0;
+            while (i < gl_backend::function_count && name != gl_backend::function_name((gl_backend::function) i))
+                i++;
+            if (i == gl_backend::function_count)
+            {
+                const std::string error_str = std::string{ "Trace uses " } + std::string{ name } + ", which gl_backend doesn't know";
+                std::cerr << error_str << '\n';
+                throw std::invalid_argument{error_str};
+            }
+            f = (gl_backend::function) i;
+        }
+
+        this->s->frames.emplace_back();
+        while (!r.done())
+        {
+            const auto index = r.read_value<std::uint16_t>();
+            if (index == end_frame)
+            {
+                this->s->frames.emplace_back();
+                continue;
+            }
+            if (index >= functions.size())
+            {
+                const char* error_str = "Trace file has a call to an unknown function";
+                std::cerr << error_str << '\n';
+                throw std::invalid_argument{error_str};
+            }
+            call& c = this->s->frames.back().emplace_back();
+            c.f = functions[index];
+            switch (c.f)
+            {
+#define OPENGL_GL_DECODE(kind, ret, name, params, args) \
+                case gl_backend::function::name: this->s->decode(r, c, (decltype(::glad_##name)) nullptr); break;
+                OPENGL_GL_FUNCTIONS(OPENGL_GL_DECODE)
+#undef OPENGL_GL_DECODE
+            }
+        }
+        // calls after the last end_frame()
+        if (this->s->frames.back().empty() && this->s->frames.size() > 1)
+            this->s->frames.pop_back();
+        else
+            this->s->partial = true;
+    }
+
+    replayer::~replayer() = default;
+
+    size_t replayer::frame_count() const { return this->s->frames.size(); }
+    bool replayer::last_frame_partial() const { return this->s->partial; }
+
+    size_t replayer::call_count(size_t i) const
+    {
+        if (i >= this->s->frames.size())
+            throw std::out_of_range{"STD::OUT_OF_RANGE Exception: Trace frame index out of range"};
+        return this->s->frames[i].size();
+    }
+
+    double replayer::play_frame(size_t i)
+    {
+        using clock = std::chrono::steady_clock;
+        if (i >= this->s->frames.size())
+            throw std::out_of_range{"STD::OUT_OF_RANGE Exception: Trace frame index out of range"};
+
+        state& st = *this->s;
+        double frame_ns = 0;
+        for (const call& c : st.frames[i])
+        {
+            // -- point outputs to scratch memory, and map ids to the ones created in this replay
+            std::array<std::uint64_t, max_args> args = c.slots;
+            for (size_t a = 0; a < c.arg_count; a++)
+            {
+                if (c.pointers[a] == pointer_kind::output)
+                    args[a] = detail::to_slot(st.scratch[a].data());
+                else if (c.objects[a] != object::none && c.pointers[a] == pointer_kind::input)
+                {
+                    // glDelete* arrays
+                    const auto captured = detail::from_slot<const GLuint*>(c.slots[a]);
+                    auto mapped = (GLuint*) st.scratch[a].data();
+                    for (size_t id = 0; id < c.sizes[a] / sizeof(GLuint); id++)
+                        mapped[id] = (GLuint) st.map(c.objects[a], captured[id]);
+                    args[a] = detail::to_slot(mapped);
+                }
+                else if (c.objects[a] != object::none && c.pointers[a] == pointer_kind::null)
+                    args[a] = st.map(c.objects[a], c.slots[a]);
+            }
+            // glGetUniform*v(program, location, ...): the location belongs to that program, not the one in use
+            if (c.f == gl_backend::function::glGetUniformfv || c.f == gl_backend::function::glGetUniformiv
+                || c.f == gl_backend::function::glGetUniformuiv)
+            {
+                const auto& locations = st.ids[(size_t) object::location];
+                if (const auto it = locations.find(c.slots[0] << 32 | (c.slots[1] & 0xFFFFFFFF)); it != locations.end())
+                    args[1] = it->second;
+            }
+            if (c.f == gl_backend::function::glUseProgram)
+                st.program = c.slots[0];
+            // write what the application wrote to the mapped range
+            if (c.f == gl_backend::function::glUnmapBuffer)
+                if (unsigned char* mapped = st.mapped[detail::from_slot<GLenum>(c.slots[0])])
+                    std::memcpy(mapped, c.unmapped, c.unmapped_size);
+
+            const auto start = clock::now();
+            std::uint64_t result = 0;
+            switch (c.f)
+            {
+#define OPENGL_GL_DISPATCH(kind, ret, name, params, args_) \
+                case gl_backend::function::name: result = invoke(::glad_##name, args.data()); break;
+                OPENGL_GL_FUNCTIONS(OPENGL_GL_DISPATCH)
+#undef OPENGL_GL_DISPATCH
+            }
+            const double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+            frame_ns += ns;
+            call_timing& timing = st.timings[(size_t) c.f];
+            timing.calls++;
+            timing.total_ns += ns;
+
+            if (c.f == gl_backend::function::glMapBufferRange)
+                st.mapped[detail::from_slot<GLenum>(c.slots[0])] = detail::from_slot<unsigned char*>(result);
+
+            // -- remember the ids this call created
+            if (c.result_object != object::none)
+            {
+                // glGetUniformLocation(program, name): the location belongs to that program, not the one in use
+                const std::uint64_t key = c.result_object == object::location
+                    ? c.slots[0] << 32 | (c.result & 0xFFFFFFFF)
+                    : c.result;
+                st.ids[(size_t) c.result_object][key] = result;
+            }
+            for (size_t a = 0; a < c.arg_count; a++)
+                if (c.pointers[a] == pointer_kind::output && c.objects[a] != object::none)
+                {
+                    // glGen*
+                    const auto captured = detail::from_slot<const GLuint*>(c.slots[a]);
+                    const auto created  = (const GLuint*) st.scratch[a].data();
+                    for (size_t id = 0; id < c.sizes[a] / sizeof(GLuint); id++)
+                        st.ids[(size_t) c.objects[a]][captured[id]] = created[id];
+                }
+        }
+        return frame_ns;
+    }
+
+    const std::array<call_timing, gl_backend::function_count>& replayer::timings() const { return this->s->timings; }
+
+    void replayer::reset_timings() { this->s->timings = {  }; }
+}
@@ -1,8 +1,23 @@
 #include "shader-program.h"
+#include "gl-backend.h"
+#include "gl-trace.h"
+#include "gl-state.h"
+#include "program-cache.h"
+#include "shader-variants.h"
 #include "event-handlers.h"
 #include "primitive.h"
 #include "texture.h"
+#include "texture-registry.h"
+#include "texture-atlas.h"
+#include "batch-renderer.h"
+#include "mesh.h"
+#include "sampler-cache.h"
+#include "streaming-texture.h"
 #include "util.h"
+#include <cctype>
+#include <cmath>
+#include <optional>
+#include <vector>
 using std::string;
 
 #define Win_Width      800
@@ -12,43 +27,86 @@ using std::string;
 
 #define Shaders_Path  "../../src/shaders"
 #define Resource_Path "../../res"
+#define Shader_Cache_Path "shader-cache"
 
 
-int main() {
-    // initialize GLFW
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); // version 3.x
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // version x.3
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    // glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // For MacOS
-    // glfwWindowHint(GLFW_FLOATING, True); // window is "always on top". Let user decide in context-menu
-    glfwWindowHint(GLFW_TRANSPARENT_FRAMEBUFFER, True); // transparent window
-
-    // create a window of size 800x600 called "LearnOpenGL"
-    GLFWwindow* window = glfwCreateWindow(Win_Width, Win_Height, "LearnOpenGL", nullptr, nullptr);
-    if (window == nullptr)
+/// Command line options:
+///     --headless <frames>  draw <frames> frames (default 1) with the null GL backend: no window or GPU needed.
+///                          Prints the GL stats of each frame
+///     --gl-stats           count GL calls (see gl-backend.h) and print the stats of all frames on exit
+///     --capture <file>     write every GL call to a trace file, to replay with gl_replay (see gl-trace.h)
+///     --no-shader-cache    compile every shader program instead of loading it from the cache (see program-cache.h)
+int main(int argc, char** argv) {
+    bool headless = false;
+    bool gl_stats = false;
+    int headless_frames = 1;
+    const char* capture_file = nullptr;
+    bool shader_cache = true;
+    for (int i = 1; i < argc; i++)
     {
-        std::cout << "Failed to create window" << std::endl;
-        glfwTerminate();
-        return 1;
+        const string arg = argv[i];
+        if (arg == "--headless")
+        {
+            headless = true;
+            if (i + 1 < argc && std::isdigit(argv[i + 1][0]))
+                headless_frames = std::stoi(argv[++i]);
+        }
+        else if (arg == "--gl-stats")
+            gl_stats = true;
+        else if (arg == "--capture" && i + 1 < argc)
+            capture_file = argv[++i];
+        else if (arg == "--no-shader-cache")
+            shader_cache = false;
     }
-    glfwMakeContextCurrent(window);
-    // set minimum size to 200x200. max size is any
-    glfwSetWindowSizeLimits(window, Win_Min_Width, Win_Min_Height, Any, Any);
-    // register events
-    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* window, int width, int height){
-        // the space OpenGL will work with relative to the window
-        glViewport(0, 0, width, height);
-    });
+
     // flip textures on the y-axis when loading them
     stbi_set_flip_vertically_on_load(true);
 
-    // initialize GLAD
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    GLFWwindow* window = nullptr;
+    if (headless)
+        gl_backend::install(gl_backend::mode::null);
+    else
     {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
+        // initialize GLFW
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); // version 3.x
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // version x.3
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        // glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // For MacOS
+        // glfwWindowHint(GLFW_FLOATING, True); // window is "always on top". Let user decide in context-menu
+        glfwWindowHint(GLFW_TRANSPARENT_FRAMEBUFFER, True); // transparent window
+
+        // create a window of size 800x600 called "LearnOpenGL"
+        window = glfwCreateWindow(Win_Width, Win_Height, "LearnOpenGL", nullptr, nullptr);
+        if (window == nullptr)
+        {
+            std::cout << "Failed to create window" << std::endl;
+            glfwTerminate();
+            return 1;
+        }
+        glfwMakeContextCurrent(window);
+        // set minimum size to 200x200. max size is any
+        glfwSetWindowSizeLimits(window, Win_Min_Width, Win_Min_Height, Any, Any);
+        // register events
+        glfwSetFramebufferSizeCallback(window, [](GLFWwindow* window, int width, int height){
+            // the space OpenGL will work with relative to the window
+            glViewport(0, 0, width, height);
+        });
+
+        // initialize GLAD
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+        if (shader_cache)
+            program_cache::init((GLADloadproc)glfwGetProcAddress, Shader_Cache_Path);
+        ShaderProgram::enable_parallel_compile((GLADloadproc)glfwGetProcAddress);
+        if (gl_stats || capture_file)
+            gl_backend::install(gl_backend::mode::recording);
     }
+    if (capture_file)
+        gl_trace::start_capture(capture_file);
 
 
 
@@ -56,11 +114,22 @@ int main() {
     //ShaderProgram basic_shader{  };
     //primitive::Rectangle rectangle{ vec2<float>{-1, 0.5}, vec2<float>{1, 1} };
 
-    ShaderProgram tex_shader{
-        Shaders_Path"/texture.vert.glsl",
-        Shaders_Path"/texture.frag.glsl"
+    // every shader is a variant of these (see shader-variants.h).
+    // They compile while the textures and shapes are loaded
+    ShaderVariants basic_shaders{
+        Shaders_Path"/basic.vert.glsl",
+        Shaders_Path"/basic.frag.glsl"
     };
-    Texture heart_tex{ Resource_Path"/heart.png" };
+    basic_shaders.prebuild({ shader_feature::textured,
+                            shader_feature::vertex_color | shader_feature::textured | shader_feature::texture_slots,
+                            shader_feature::textured | shader_feature::instanced,
+                            shader_feature::textured | shader_feature::alpha_test,
+                            shader_feature::vertex_color });
+    // images decode on worker threads and upload a few per frame (see texture-loader.h).
+    // The registry loads each file once, however many times it's asked for
+    TextureLoader texture_loader;
+    TextureRegistry textures{ texture_loader };
+    TextureHandle heart_tex = textures.get(Resource_Path"/heart.png");
     primitive::Shape2D tex_rectangle{
         std::array<float, 3*4 + 4*4 + 2*4> {
            //position //color       // tex_coord
@@ -74,7 +143,68 @@ int main() {
         }
     };
 
-    // ShaderProgram uniform_color_shader{ nullptr, Shaders_Path"/uniform-color.frag.glsl" };
+    // small images share one texture (see texture-atlas.h): both sprites are drawn with one bind
+    TextureAtlas atlas{ atlas_options{ .page_size = 1024 } };
+    const atlas_region logo_region = atlas.add(Resource_Path"/opengl.png");
+    const atlas_region heart_region = atlas.add(Resource_Path"/heart.png");
+    atlas.upload();
+    const auto textured_quad = [](float x, float y, float width, float height) {
+        return std::array<float, 3*4 + 4*4 + 2*4> {
+           //position                     //color       // tex_coord
+            x,         y + height, 0,   1, 1, 1, 1,   0, 1, //    top left
+            x,         y,          0,   1, 1, 1, 1,   0, 0, // bottom left
+            x + width, y + height, 0,   1, 1, 1, 1,   1, 1, //    top right
+            x + width, y,          0,   1, 1, 1, 1,   1, 0  // bottom right
+        };
+    };
+    const std::array<unsigned int, 6> quad_indices{ 0, 1, 3,  0, 2, 3 };
+    primitive::Shape2D logo_sprite{ textured_quad(-1.0f, -1.0f, 1.0f, 0.41f), 3 + 4 + 2, quad_indices, logo_region };
+    primitive::Shape2D heart_sprite{ textured_quad(-1.0f, -0.5f, 0.4f, 0.4f), 3 + 4 + 2, quad_indices, heart_region };
+
+    // wrap and filter modes are sampler objects bound to the texture unit (see sampler-cache.h), not state of each texture
+    SamplerCache samplers;
+    const sampler_state tex_sampling{  };
+    const sampler_state atlas_sampling{ .wrap_s = GL_CLAMP_TO_EDGE, .wrap_t = GL_CLAMP_TO_EDGE, .wrap_r = GL_CLAMP_TO_EDGE };
+
+    // an image generated every frame goes through pixel unpack buffers (see streaming-texture.h)
+    std::optional<StreamingTexture> heatmap{ std::in_place, 64, 64 };
+    primitive::Shape2D heatmap_quad{ textured_quad(0.5f, -1.0f, 0.5f, 0.5f), 3 + 4 + 2, quad_indices };
+
+    // many small sprites with a few textures: one vertex buffer and one draw call (see batch-renderer.h)
+    std::optional<BatchRenderer> batch{ std::in_place };
+    ShaderProgram& batch_shader = basic_shaders.get(shader_feature::vertex_color | shader_feature::textured | shader_feature::texture_slots);
+
+    // one shape drawn many times with one draw call: each copy has its own transform, color and image (see primitive.h)
+    primitive::Shape2D marker{ textured_quad(-0.05f, -0.05f, 0.1f, 0.1f), 3 + 4 + 2, quad_indices };
+    std::vector<primitive::shape_instance> markers(64);
+    ShaderProgram& instanced_shader = basic_shaders.get(shader_feature::textured | shader_feature::instanced);
+    instanced_shader.set_uniform("texture_data", 0);
+
+    // sizes and attribute layout chosen at runtime (see mesh.h): positions in one buffer, byte colors in another
+    std::optional<Mesh> fan;
+    {
+        static constexpr auto circle = mesh_gen::circle<48>({ -0.6f, 0.6f }, 0.25f);
+        std::vector<float> positions;
+        std::vector<unsigned char> colors;
+        for (size_t i = 0; i < circle.vertex_count; i++)
+        {
+            positions.insert(positions.end(), &circle.vertices[i * circle.vertex_length], &circle.vertices[i * circle.vertex_length + 3]);
+            colors.insert(colors.end(), { (unsigned char) (i * 5), 128, (unsigned char) (255 - i * 5), 255 });
+        }
+        VertexLayout layout;
+        layout.add(0, 3).add(1, 4, GL_UNSIGNED_BYTE, true, 1);
+        fan.emplace(layout, std::initializer_list<std::span<const std::byte>>{ std::as_bytes(std::span(positions)), std::as_bytes(std::span(colors)) },
+                    circle.indices);
+    }
+    ShaderProgram& color_shader = basic_shaders.get(shader_feature::vertex_color);
+    // the same vertices in less memory: 16 bytes each instead of 36 (see vertex-quantize.h)
+    static constexpr auto panel = mesh_gen::rounded_rect<8>({ 0.55f, 0.95f }, { 0.4f, 0.25f }, 0.05f, { 0.2f, 0.4f, 0.8f, 1 });
+    const vertex_quantize::vertices small_panel = vertex_quantize::quantize(panel.vertices, panel.vertex_length);
+    std::optional<Mesh> panel_mesh{ std::in_place, small_panel, panel.indices };
+    if (gl_stats || headless)
+        std::cout << small_panel.stats;
+
+    // ShaderProgram& uniform_color_shader = basic_shaders.get(0);
     // uniform_color_shader.set_uniform("color", {0.5f, 0.4f, 0.3f, 0.0f});
     // primitive::Triangle triangle{ std::array<float, 3*3> {
     //     0.0f, -0.5f, 0.0f, // bottom left
@@ -82,10 +212,7 @@ int main() {
     //     0.5f,  0.5f, 0.0f, //    top middle
     // } };
     //
-    // ShaderProgram gradient_shader{
-    //     Shaders_Path"/gradient.vert.glsl",
-    //     Shaders_Path"/gradient.frag.glsl"
-    // };
+    // ShaderProgram& gradient_shader = basic_shaders.get(shader_feature::vertex_color);
     // // triangle acts like a mask?? // doesn't blend with other shapes and bg
     // primitive::Shape2D gradient_triangle{
     //     std::array<float, 3*3 + 4*3> {
@@ -105,8 +232,14 @@ int main() {
     std::cout << vec3<char>{51, 52, 53};
     std::cout << vec4<char>{54, 55, 56, 57};
 
+    ShaderProgram& tex_shader = basic_shaders.get(shader_feature::textured);
+    std::cout << program_cache::counters();
+
     // -- set texture uniforms
     tex_shader.set_uniform("texture_data", 0);
+    // the heart's soft edges are cut off at the shader's default alpha_cutoff
+    ShaderProgram& cutout_shader = basic_shaders.get(shader_feature::textured | shader_feature::alpha_test);
+    cutout_shader.set_uniform("texture_data", 0);
 
 
     //! @brief Fill the color buffer with this color. Acts as a background color
@@ -120,11 +253,27 @@ int main() {
     // glPolygonMode(GL_FRONT_AND_BACK, GL_POINT); // only draws the outline of a shape
 
     //! @brief Render loop
-    while(!glfwWindowShouldClose(window))
+    for (int frame = 0; headless ? frame < headless_frames : !glfwWindowShouldClose(window); frame++)
     {
-        onKeyDown(window, GLFW_KEY_ESCAPE, [&window]() {
-            closeWindow(window);
-        });
+        if (!headless)
+            onKeyDown(window, GLFW_KEY_ESCAPE, [&window]() {
+                closeWindow(window);
+            });
+
+        // upload the textures that finished decoding
+        texture_loader.upload();
+        // a wave moving across the heatmap, written straight into the buffer the GPU copies from
+        unsigned char* heat = heatmap->begin_update();
+        for (int y = 0; y < heatmap->height(); y++)
+            for (int x = 0; x < heatmap->width(); x++, heat += 4)
+            {
+                const auto val = (unsigned char) (127.5f + 127.5f * std::sin((float) (x + y + frame) / 8.0f));
+                heat[0] = val;
+                heat[1] = 0;
+                heat[2] = 255 - val;
+                heat[3] = 255;
+            }
+        heatmap->end_update();
 
         // clear previous frame
         glClear(GL_COLOR_BUFFER_BIT);
@@ -132,11 +281,49 @@ int main() {
         // basic_shader.use();
         // rectangle.draw();
         //
-        glActiveTexture(GL_TEXTURE0); // texture unit
-        heart_tex.use();
+        gl_state::active_texture(GL_TEXTURE0); // texture unit
+        samplers.bind(0, tex_sampling);
+        heart_tex->use();
         tex_shader.use();
         // TODO: app crashes when drawing with texture shader when frag uses the color input (exit code -1073741819 (0xC0000005))
         tex_rectangle.draw();
+        samplers.bind(0, atlas_sampling);
+        atlas.use(logo_region.page);
+        logo_sprite.draw();
+        cutout_shader.use();
+        heart_sprite.draw();
+        tex_shader.use();
+        heatmap->use();
+        heatmap_quad.draw();
+        batch->set_shader(batch_shader);
+        for (int i = 0; i < 16; i++)
+        {
+            const float x = 0.0f + (float) (i % 8) * 0.12f, y = 0.3f + (float) (i / 8) * 0.12f;
+            batch->quad(x, y, 0.1f, 0.1f, { 1, 1, 1, 1 }, atlas.page(heart_region.page), heart_region);
+        }
+        batch->quad(0.0f, 0.6f, 0.2f, 0.2f, { 1, 1, 1, 1 }, heart_tex->gl_texture);
+        batch->quad(0.3f, 0.6f, 0.2f, 0.2f, { 1, 1, 1, 1 }, heatmap->gl_texture);
+        batch->triangle({
+            batch_vertex{ { 0.6f, 0.6f, 0 }, { 1, 0, 0, 1 }, {  }, 0 },
+            batch_vertex{ { 0.9f, 0.6f, 0 }, { 0, 1, 0, 1 }, {  }, 0 },
+            batch_vertex{ { 0.75f, 0.9f, 0 }, { 0, 0, 1, 1 }, {  }, 0 }
+        });
+        const BatchRenderer::stats batch_stats = batch->end_frame();
+        // a ring of spinning hearts, moved every frame
+        for (size_t i = 0; i < markers.size(); i++)
+        {
+            const float angle = (float) i / (float) markers.size() * 6.2831853f + (float) frame * 0.01f;
+            markers[i] = primitive::shape_instance::at(-0.5f + 0.4f * std::cos(angle), 0.4f * std::sin(angle), 0.5f, angle)
+                .with_region(heart_region)
+                .with_color({ 1, (float) i / (float) markers.size(), 1, 1 });
+        }
+        marker.set_instances(markers);
+        instanced_shader.use();
+        atlas.use(heart_region.page);
+        marker.draw_instanced();
+        color_shader.use();
+        fan->draw();
+        panel_mesh->draw();
         //
         //uniform_color_shader.use();
         //triangle.draw();
@@ -156,13 +343,50 @@ int main() {
          *  @param indices offset of indices to use from the Element Array */
         // glDrawElements(GL_TRIANGLES, 6, Unsigned_Int, nullptr); // * USE FOR MORE COMPLEX SHAPES
 
+        const StreamingTexture::stats heatmap_stats = heatmap->end_frame();
+        if (gl_backend::installed())
+        {
+            const gl_backend::frame_stats stats = gl_backend::end_frame();
+            if (headless)
+            {
+                std::cout << "frame " << frame << ": " << stats << "    " << gl_state::counters()
+                          << "    " << texture_loader.counters() << "    " << heatmap_stats << "    " << batch_stats;
+                gl_state::reset_counters();
+            }
+        }
+        if (headless)
+            continue;
+
         // transition from one frame to another with no flickers
         glfwSwapBuffers(window);
         // call events
         glfwPollEvents();
     }
 
+    if (gl_stats || headless)
+    {
+        std::cout << textures.counters();
+        for (const TextureRegistry::asset& asset : textures.assets())
+            std::cout << "    " << asset;
+        std::cout << samplers.counters() << heatmap->totals();
+    }
+    // the trace ends with the last frame: replaying the teardown would delete objects the next repeat still draws with
+    gl_trace::stop_capture();
+    // delete the GL textures while the context still exists
+    heart_tex.reset();
+    atlas = TextureAtlas{};
+    samplers = SamplerCache{};
+    heatmap.reset();
+    batch.reset();
+    fan.reset();
+    panel_mesh.reset();
+    basic_shaders.clear();
 
-    glfwTerminate();
+    if (gl_stats && gl_backend::frame_count() > 0)
+        std::cout << "GL stats of " << gl_backend::frame_count() << " frames: " << gl_backend::totals()
+                  << "    " << gl_state::counters();
+
+    if (!headless)
+        glfwTerminate();
     return 0;
 }
\ No newline at end of file
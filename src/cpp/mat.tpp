@@ -0,0 +1,562 @@
+/// --- MAT2 ---
+template<typename Type>
+mat2<Type> mat2<Type>::rotation(Type angle)
+requires std::is_floating_point_v<Type>
+{
+    const Type c = std::cos(angle), s = std::sin(angle);
+    return { { c, s }, { -s, c } };
+}
+
+template<typename Type>
+mat2<Type> mat2<Type>::scaling(const vec2<Type>& s)
+{
+    return { { s.x, 0 }, { 0, s.y } };
+}
+
+template<typename Type>
+vec2<Type>& mat2<Type>::operator[](unsigned char i)
+{
+    if (i < 2)
+        return this->cols[i];
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: mat2 only has 2 columns"};
+}
+template<typename Type>
+const vec2<Type>& mat2<Type>::operator[](unsigned char i) const
+{
+    if (i < 2)
+        return this->cols[i];
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: mat2 only has 2 columns"};
+}
+
+template<typename Type>
+mat2<Type> mat2<Type>::transposed() const
+{
+    const auto& c = this->cols;
+    return { { c[0].x, c[1].x }, { c[0].y, c[1].y } };
+}
+
+template<typename Type>
+Type mat2<Type>::determinant() const
+{
+    const auto& c = this->cols;
+    return c[0].x * c[1].y - c[1].x * c[0].y;
+}
+
+template<typename Type>
+mat2<Type> mat2<Type>::inverse() const
+requires std::is_floating_point_v<Type>
+{
+    const Type det = this->determinant();
+    if (det == 0)
+        throw std::domain_error{"STD::DOMAIN_ERROR Exception: mat2 is singular (determinant is 0) and has no inverse"};
+
+    const auto& c = this->cols;
+    const Type inv_det = 1 / det;
+    return {
+        {  c[1].y * inv_det, -c[0].y * inv_det },
+        { -c[1].x * inv_det,  c[0].x * inv_det }
+    };
+}
+
+template<typename Type>
+mat2<Type> mat2<Type>::operator*(const mat2& other) const
+{
+    return { *this * other.cols[0], *this * other.cols[1] };
+}
+
+template<typename Type>
+vec2<Type> mat2<Type>::operator*(const vec2<Type>& v) const
+{
+    const auto& c = this->cols;
+    return {
+        c[0].x * v.x + c[1].x * v.y,
+        c[0].y * v.x + c[1].y * v.y
+    };
+}
+
+template<typename Type>
+mat2<Type> mat2<Type>::operator*(Type val) const
+{
+    return { this->cols[0] * val, this->cols[1] * val };
+}
+
+template<typename Type>
+std::array<Type, 2*2> mat2<Type>::to_array() const
+{
+    const auto& c = this->cols;
+    return { c[0].x, c[0].y, c[1].x, c[1].y };
+}
+
+
+
+/// --- MAT3 ---
+template<typename Type>
+mat3<Type>::mat3(const mat4<Type>& m)
+    : cols{ vec3<Type>{ m.cols[0] }, vec3<Type>{ m.cols[1] }, vec3<Type>{ m.cols[2] } } {  }
+
+template<typename Type>
+mat3<Type> mat3<Type>::translation(const vec2<Type>& t)
+{
+    mat3<Type> m{ 1 };
+    m.cols[2] = { t.x, t.y, 1 };
+    return m;
+}
+
+template<typename Type>
+mat3<Type> mat3<Type>::rotation(Type angle)
+requires std::is_floating_point_v<Type>
+{
+    const Type c = std::cos(angle), s = std::sin(angle);
+    return { { c, s, 0 }, { -s, c, 0 }, { 0, 0, 1 } };
+}
+
+template<typename Type>
+mat3<Type> mat3<Type>::scaling(const vec2<Type>& s)
+{
+    return { { s.x, 0, 0 }, { 0, s.y, 0 }, { 0, 0, 1 } };
+}
+
+template<typename Type>
+vec3<Type>& mat3<Type>::operator[](unsigned char i)
+{
+    if (i < 3)
+        return this->cols[i];
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: mat3 only has 3 columns"};
+}
+template<typename Type>
+const vec3<Type>& mat3<Type>::operator[](unsigned char i) const
+{
+    if (i < 3)
+        return this->cols[i];
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: mat3 only has 3 columns"};
+}
+
+template<typename Type>
+mat3<Type> mat3<Type>::transposed() const
+{
+    const auto& c = this->cols;
+    return {
+        { c[0].x, c[1].x, c[2].x },
+        { c[0].y, c[1].y, c[2].y },
+        { c[0].z, c[1].z, c[2].z }
+    };
+}
+
+template<typename Type>
+Type mat3<Type>::determinant() const
+{
+    const auto& c = this->cols;
+    return c[0].x * (c[1].y * c[2].z - c[2].y * c[1].z)
+         - c[1].x * (c[0].y * c[2].z - c[2].y * c[0].z)
+         + c[2].x * (c[0].y * c[1].z - c[1].y * c[0].z);
+}
+
+template<typename Type>
+mat3<Type> mat3<Type>::inverse() const
+requires std::is_floating_point_v<Type>
+{
+    const Type det = this->determinant();
+    if (det == 0)
+        throw std::domain_error{"STD::DOMAIN_ERROR Exception: mat3 is singular (determinant is 0) and has no inverse"};
+
+    // transpose of the cofactor matrix, divided by the determinant
+    const auto& c = this->cols;
+    const Type inv_det = 1 / det;
+    return {
+        {
+            (c[1].y * c[2].z - c[2].y * c[1].z) * inv_det,
+            (c[2].y * c[0].z - c[0].y * c[2].z) * inv_det,
+            (c[0].y * c[1].z - c[1].y * c[0].z) * inv_det
+        },
+        {
+            (c[2].x * c[1].z - c[1].x * c[2].z) * inv_det,
+            (c[0].x * c[2].z - c[2].x * c[0].z) * inv_det,
+            (c[1].x * c[0].z - c[0].x * c[1].z) * inv_det
+        },
+        {
+            (c[1].x * c[2].y - c[2].x * c[1].y) * inv_det,
+            (c[2].x * c[0].y - c[0].x * c[2].y) * inv_det,
+            (c[0].x * c[1].y - c[1].x * c[0].y) * inv_det
+        }
+    };
+}
+
+template<typename Type>
+mat3<Type> mat3<Type>::operator*(const mat3& other) const
+{
+    return { *this * other.cols[0], *this * other.cols[1], *this * other.cols[2] };
+}
+
+template<typename Type>
+vec3<Type> mat3<Type>::operator*(const vec3<Type>& v) const
+{
+    // a linear combination of the columns. For float this is 3 SIMD multiply-adds (see vec.h)
+    return this->cols[0] * v.x + this->cols[1] * v.y + this->cols[2] * v.z;
+}
+
+template<typename Type>
+mat3<Type> mat3<Type>::operator*(Type val) const
+{
+    return { this->cols[0] * val, this->cols[1] * val, this->cols[2] * val };
+}
+
+template<typename Type>
+std::array<Type, 3*3> mat3<Type>::to_array() const
+{
+    const auto& c = this->cols;
+    return { c[0].x, c[0].y, c[0].z, c[1].x, c[1].y, c[1].z, c[2].x, c[2].y, c[2].z };
+}
+
+
+
+/// --- MAT4 ---
+template<typename Type>
+mat4<Type>::mat4(const mat3<Type>& m)
+    : cols{ vec4<Type>{ m.cols[0], 0 }, vec4<Type>{ m.cols[1], 0 },
+            vec4<Type>{ m.cols[2], 0 }, vec4<Type>{ 0, 0, 0, 1 } } {  }
+
+template<typename Type>
+mat4<Type> mat4<Type>::translation(const vec3<Type>& t)
+{
+    mat4<Type> m{ 1 };
+    m.cols[3] = { t, 1 };
+    return m;
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::scaling(const vec3<Type>& s)
+{
+    mat4<Type> m{ 1 };
+    m.cols[0].x = s.x;
+    m.cols[1].y = s.y;
+    m.cols[2].z = s.z;
+    return m;
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::rotation(Type angle, const vec3<Type>& axis)
+requires std::is_floating_point_v<Type>
+{
+    const Type len = (Type) axis.length();
+    const Type x = axis.x / len, y = axis.y / len, z = axis.z / len;
+    const Type c = std::cos(angle), s = std::sin(angle), t = 1 - c;
+    return {
+        { t*x*x + c,   t*x*y + s*z, t*x*z - s*y, 0 },
+        { t*x*y - s*z, t*y*y + c,   t*y*z + s*x, 0 },
+        { t*x*z + s*y, t*y*z - s*x, t*z*z + c,   0 },
+        { 0,           0,           0,           1 }
+    };
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::rotation_z(Type angle)
+requires std::is_floating_point_v<Type>
+{
+    const Type c = std::cos(angle), s = std::sin(angle);
+    return {
+        {  c, s, 0, 0 },
+        { -s, c, 0, 0 },
+        {  0, 0, 1, 0 },
+        {  0, 0, 0, 1 }
+    };
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::ortho(Type left, Type right, Type bottom, Type top, Type near, Type far)
+requires std::is_floating_point_v<Type>
+{
+    return {
+        { 2 / (right - left),                0,                                 0,                             0 },
+        { 0,                                 2 / (top - bottom),                0,                             0 },
+        { 0,                                 0,                                 -2 / (far - near),             0 },
+        { -(right + left) / (right - left), -(top + bottom) / (top - bottom), -(far + near) / (far - near), 1 }
+    };
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::perspective(Type fov_y, Type aspect, Type near, Type far)
+requires std::is_floating_point_v<Type>
+{
+    const Type f = 1 / std::tan(fov_y / 2);
+    return {
+        { f / aspect, 0, 0,                                0 },
+        { 0,          f, 0,                                0 },
+        { 0,          0, (far + near) / (near - far),     -1 },
+        { 0,          0, 2 * far * near / (near - far),    0 }
+    };
+}
+
+template<typename Type>
+vec4<Type>& mat4<Type>::operator[](unsigned char i)
+{
+    if (i < 4)
+        return this->cols[i];
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: mat4 only has 4 columns"};
+}
+template<typename Type>
+const vec4<Type>& mat4<Type>::operator[](unsigned char i) const
+{
+    if (i < 4)
+        return this->cols[i];
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: mat4 only has 4 columns"};
+}
+
+template<typename Type>
+bool mat4<Type>::is_affine() const
+{
+    const auto& c = this->cols;
+    return c[0].w == 0 && c[1].w == 0 && c[2].w == 0 && c[3].w == 1;
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::transposed() const
+{
+    const auto& c = this->cols;
+    return {
+        { c[0].x, c[1].x, c[2].x, c[3].x },
+        { c[0].y, c[1].y, c[2].y, c[3].y },
+        { c[0].z, c[1].z, c[2].z, c[3].z },
+        { c[0].w, c[1].w, c[2].w, c[3].w }
+    };
+}
+
+template<typename Type>
+Type mat4<Type>::determinant() const
+{
+    const auto& c = this->cols;
+    // 2x2 sub-determinants of the bottom two rows
+    const Type s0 = c[0].z * c[1].w - c[1].z * c[0].w;
+    const Type s1 = c[0].z * c[2].w - c[2].z * c[0].w;
+    const Type s2 = c[0].z * c[3].w - c[3].z * c[0].w;
+    const Type s3 = c[1].z * c[2].w - c[2].z * c[1].w;
+    const Type s4 = c[1].z * c[3].w - c[3].z * c[1].w;
+    const Type s5 = c[2].z * c[3].w - c[3].z * c[2].w;
+
+    return c[0].x * (c[1].y * s5 - c[2].y * s4 + c[3].y * s3)
+         - c[1].x * (c[0].y * s5 - c[2].y * s2 + c[3].y * s1)
+         + c[2].x * (c[0].y * s4 - c[1].y * s2 + c[3].y * s0)
+         - c[3].x * (c[0].y * s3 - c[1].y * s1 + c[2].y * s0);
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::inverse() const
+requires std::is_floating_point_v<Type>
+{
+    if (this->is_affine())
+        return this->inverse_affine();
+
+    // cofactor expansion with shared 2x2 sub-determinants (rows 0-1 and rows 2-3)
+    const auto& c = this->cols;
+    const Type a0 = c[0].x * c[1].y - c[1].x * c[0].y;
+    const Type a1 = c[0].x * c[2].y - c[2].x * c[0].y;
+    const Type a2 = c[0].x * c[3].y - c[3].x * c[0].y;
+    const Type a3 = c[1].x * c[2].y - c[2].x * c[1].y;
+    const Type a4 = c[1].x * c[3].y - c[3].x * c[1].y;
+    const Type a5 = c[2].x * c[3].y - c[3].x * c[2].y;
+    const Type b0 = c[0].z * c[1].w - c[1].z * c[0].w;
+    const Type b1 = c[0].z * c[2].w - c[2].z * c[0].w;
+    const Type b2 = c[0].z * c[3].w - c[3].z * c[0].w;
+    const Type b3 = c[1].z * c[2].w - c[2].z * c[1].w;
+    const Type b4 = c[1].z * c[3].w - c[3].z * c[1].w;
+    const Type b5 = c[2].z * c[3].w - c[3].z * c[2].w;
+
+    const Type det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+    if (det == 0)
+        throw std::domain_error{"STD::DOMAIN_ERROR Exception: mat4 is singular (determinant is 0) and has no inverse"};
+    const Type inv_det = 1 / det;
+
+    return {
+        {
+            ( c[1].y * b5 - c[2].y * b4 + c[3].y * b3) * inv_det,
+            (-c[0].y * b5 + c[2].y * b2 - c[3].y * b1) * inv_det,
+            ( c[0].y * b4 - c[1].y * b2 + c[3].y * b0) * inv_det,
+            (-c[0].y * b3 + c[1].y * b1 - c[2].y * b0) * inv_det
+        },
+        {
+            (-c[1].x * b5 + c[2].x * b4 - c[3].x * b3) * inv_det,
+            ( c[0].x * b5 - c[2].x * b2 + c[3].x * b1) * inv_det,
+            (-c[0].x * b4 + c[1].x * b2 - c[3].x * b0) * inv_det,
+            ( c[0].x * b3 - c[1].x * b1 + c[2].x * b0) * inv_det
+        },
+        {
+            ( c[1].w * a5 - c[2].w * a4 + c[3].w * a3) * inv_det,
+            (-c[0].w * a5 + c[2].w * a2 - c[3].w * a1) * inv_det,
+            ( c[0].w * a4 - c[1].w * a2 + c[3].w * a0) * inv_det,
+            (-c[0].w * a3 + c[1].w * a1 - c[2].w * a0) * inv_det
+        },
+        {
+            (-c[1].z * a5 + c[2].z * a4 - c[3].z * a3) * inv_det,
+            ( c[0].z * a5 - c[2].z * a2 + c[3].z * a1) * inv_det,
+            (-c[0].z * a4 + c[1].z * a2 - c[3].z * a0) * inv_det,
+            ( c[0].z * a3 - c[1].z * a1 + c[2].z * a0) * inv_det
+        }
+    };
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::inverse_affine() const
+requires std::is_floating_point_v<Type>
+{
+    // | A t |^-1   | A^-1  -A^-1 * t |
+    // | 0 1 |    = | 0      1        |
+    const mat3<Type> inv{ mat3<Type>{ *this }.inverse() };
+    const vec3<Type> t{ this->cols[3] };
+    const vec3<Type> inv_t = inv * t;
+
+    mat4<Type> m{ inv };
+    m.cols[3] = { -inv_t.x, -inv_t.y, -inv_t.z, 1 };
+    return m;
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::operator*(const mat4& other) const
+{
+    return { *this * other.cols[0], *this * other.cols[1], *this * other.cols[2], *this * other.cols[3] };
+}
+
+template<typename Type>
+vec4<Type> mat4<Type>::operator*(const vec4<Type>& v) const
+{
+    if constexpr (std::is_same_v<Type, float>)
+    {
+        // a linear combination of the columns: 4 broadcasts, 4 multiplies and 3 adds
+        const auto& c = this->cols;
+        simd::f32x4 r = simd::mul(c[0].packed(), simd::splat(v.x));
+        r = simd::add(r, simd::mul(c[1].packed(), simd::splat(v.y)));
+        r = simd::add(r, simd::mul(c[2].packed(), simd::splat(v.z)));
+        r = simd::add(r, simd::mul(c[3].packed(), simd::splat(v.w)));
+        return vec4<float>{ r };
+    }
+    else
+        return this->cols[0] * v.x + this->cols[1] * v.y + this->cols[2] * v.z + this->cols[3] * v.w;
+}
+
+template<typename Type>
+mat4<Type> mat4<Type>::operator*(Type val) const
+{
+    return { this->cols[0] * val, this->cols[1] * val, this->cols[2] * val, this->cols[3] * val };
+}
+
+template<typename Type>
+vec3<Type> mat4<Type>::transform_point(const vec3<Type>& p) const
+{
+    const vec4<Type> r = *this * vec4<Type>{ p, 1 };
+    if (this->is_affine())
+        return vec3<Type>{ r };
+    return { r.x / r.w, r.y / r.w, r.z / r.w };
+}
+
+template<typename Type>
+vec3<Type> mat4<Type>::transform_vector(const vec3<Type>& v) const
+{
+    return vec3<Type>{ *this * vec4<Type>{ v, 0 } };
+}
+
+template<typename Type>
+void mat4<Type>::transform_points(vec3_stream<Type>& points) const
+{
+    const auto& c = this->cols;
+    const bool affine = this->is_affine();
+    const size_t n = points.size();
+    Type* __restrict xs = points.component(0);
+    Type* __restrict ys = points.component(1);
+    Type* __restrict zs = points.component(2);
+
+    size_t i = 0;
+    if constexpr (std::is_same_v<Type, float>)
+    {
+        // broadcast every matrix element once, then transform simd::width points per iteration
+        using packet = simd::f32xN;
+        packet m[4][4];
+        for (unsigned char col = 0; col < 4; col++)
+            for (unsigned char row = 0; row < 4; row++)
+                m[col][row] = simd::splat(c[col][row], packet{});
+
+        for (; i + simd::width <= n; i += simd::width)
+        {
+            const packet x = simd::load(xs + i, packet{});
+            const packet y = simd::load(ys + i, packet{});
+            const packet z = simd::load(zs + i, packet{});
+            packet out[4];
+            for (unsigned char row = 0; row < (affine ? 3 : 4); row++)
+                out[row] = simd::add(simd::add(simd::mul(m[0][row], x), simd::mul(m[1][row], y)),
+                                     simd::add(simd::mul(m[2][row], z), m[3][row]));
+            if (!affine)
+                for (unsigned char row = 0; row < 3; row++)
+                    out[row] = simd::div(out[row], out[3]);
+            simd::store(xs + i, out[0]);
+            simd::store(ys + i, out[1]);
+            simd::store(zs + i, out[2]);
+        }
+    }
+    for (; i < n; i++)
+    {
+        const Type x = xs[i], y = ys[i], z = zs[i];
+        Type out[4];
+        for (unsigned char row = 0; row < 4; row++)
+            out[row] = c[0][row] * x + c[1][row] * y + c[2][row] * z + c[3][row];
+        if (!affine)
+            for (unsigned char row = 0; row < 3; row++)
+                out[row] /= out[3];
+        xs[i] = out[0];
+        ys[i] = out[1];
+        zs[i] = out[2];
+    }
+}
+
+template<typename Type>
+void mat4<Type>::transform_points(float* vertices, size_t count, unsigned int vertex_length, unsigned int offset) const
+requires std::is_same_v<Type, float>
+{
+    if (offset + 3 > vertex_length)
+    {
+        const char* error_str = "Position does not fit in the vertex. "
+                                "@param<offset> + 3 has to be at most @param<vertex_length>.";
+        std::cerr << error_str;
+        throw std::invalid_argument{error_str};
+    }
+
+    const auto& c = this->cols;
+    const bool affine = this->is_affine();
+    const simd::f32x4 c0 = c[0].packed(), c1 = c[1].packed(), c2 = c[2].packed(), c3 = c[3].packed();
+    for (size_t i = 0; i < count; i++)
+    {
+        float* p = vertices + i * vertex_length + offset;
+        simd::f32x4 r = simd::add(simd::add(simd::mul(c0, simd::splat(p[0])), simd::mul(c1, simd::splat(p[1]))),
+                                  simd::add(simd::mul(c2, simd::splat(p[2])), c3));
+        if (!affine)
+            r = simd::div(r, simd::splat(simd::lane(r, 3)));
+        vec4<float> out{ r };
+        p[0] = out.x;
+        p[1] = out.y;
+        p[2] = out.z;
+    }
+}
+
+
+
+// --- PRINTING MATS ---
+// printed row by row, so they read like they would on paper
+template<typename Type>
+std::ostream& operator<<(std::ostream& os, const mat2<Type>& m)
+{
+    os << "{ " << m.cols[0].x << ", " << m.cols[1].x << " }\n"
+       << "{ " << m.cols[0].y << ", " << m.cols[1].y << " }\n";
+    return os;
+}
+
+template<typename Type>
+std::ostream& operator<<(std::ostream& os, const mat3<Type>& m)
+{
+    for (unsigned char row = 0; row < 3; row++)
+        os << "{ " << m.cols[0][row] << ", " << m.cols[1][row] << ", " << m.cols[2][row] << " }\n";
+    return os;
+}
+
+template<typename Type>
+std::ostream& operator<<(std::ostream& os, const mat4<Type>& m)
+{
+    for (unsigned char row = 0; row < 4; row++)
+        os << "{ " << m.cols[0][row] << ", " << m.cols[1][row] << ", " << m.cols[2][row] << ", " << m.cols[3][row] << " }\n";
+    return os;
+}
@@ -0,0 +1,147 @@
+namespace mesh_gen
+{
+    // -- helpers
+    /*! @brief Write vertex @param i of @param m
+     *  @param top_left, size the bounding box of the shape, used for tex_coord */
+    template<size_t v_count, size_t i_count>
+    constexpr void put_vertex(mesh<v_count, i_count>& m, size_t i, vec2<float> pos, rgba<float> color,
+                              vec2<float> top_left, vec2<float> size)
+    {
+        float* v = m.vertices.data() + i * mesh<v_count, i_count>::vertex_length;
+        v[0] = pos.x;
+        v[1] = pos.y;
+        v[2] = 0.0f;
+        for (unsigned char c = 0; c < 4; c++)
+            v[3 + c] = color[c];
+        v[7] = size.x == 0 ? 0.0f : (pos.x - top_left.x) / size.x;
+        v[8] = size.y == 0 ? 0.0f : (pos.y - (top_left.y - size.y)) / size.y;
+    }
+
+    //! @brief Point on a circle. @param angle radians, counter-clockwise from the +x axis
+    constexpr vec2<float> on_circle(vec2<float> center, float radius, double angle)
+    {
+        return { center.x + radius * (float) constexpr_math::cos(angle),
+                 center.y + radius * (float) constexpr_math::sin(angle) };
+    }
+
+    //! @brief Fan of triangles (center, rim[i], rim[i+1]) around vertex 0. The last triangle closes the loop
+    template<size_t v_count, size_t i_count>
+    constexpr void fan_indices(mesh<v_count, i_count>& m)
+    {
+        constexpr size_t rim = v_count - 1;
+        for (size_t i = 0; i < rim; i++)
+        {
+            m.indices[i * 3 + 0] = 0;
+            m.indices[i * 3 + 1] = (unsigned int) (1 + i);
+            m.indices[i * 3 + 2] = (unsigned int) (1 + (i + 1) % rim);
+        }
+    }
+
+
+
+    constexpr mesh<4, 6> rect(vec2<float> position, vec2<float> dimensions, rgba<float> color)
+    {
+        mesh<4, 6> m;
+        const float x = position.x, y = position.y, w = dimensions.x, h = dimensions.y;
+        put_vertex(m, 0, { x,     y     }, color, position, dimensions); //    top left
+        put_vertex(m, 1, { x,     y - h }, color, position, dimensions); // bottom left
+        put_vertex(m, 2, { x + w, y     }, color, position, dimensions); //    top right
+        put_vertex(m, 3, { x + w, y - h }, color, position, dimensions); // bottom right
+        m.indices = { 0, 1, 3,  0, 3, 2 };
+        return m;
+    }
+
+    template<size_t sides> requires (sides >= 3)
+    constexpr mesh<sides, 3 * (sides - 2)> ngon(vec2<float> center, float radius, rgba<float> color, float rotation)
+    {
+        mesh<sides, 3 * (sides - 2)> m;
+        const vec2<float> top_left{ center.x - radius, center.y + radius };
+        const vec2<float> size{ 2 * radius, 2 * radius };
+        for (size_t i = 0; i < sides; i++)
+            put_vertex(m, i, on_circle(center, radius, rotation + 2 * constexpr_math::pi * (double) i / sides),
+                       color, top_left, size);
+
+        // a convex polygon can be split into triangles that all share the first vertex
+        for (size_t i = 0; i < sides - 2; i++)
+        {
+            m.indices[i * 3 + 0] = 0;
+            m.indices[i * 3 + 1] = (unsigned int) (i + 1);
+            m.indices[i * 3 + 2] = (unsigned int) (i + 2);
+        }
+        return m;
+    }
+
+    template<size_t segments> requires (segments >= 3)
+    constexpr mesh<segments + 1, 3 * segments> circle(vec2<float> center, float radius, rgba<float> color)
+    {
+        mesh<segments + 1, 3 * segments> m;
+        const vec2<float> top_left{ center.x - radius, center.y + radius };
+        const vec2<float> size{ 2 * radius, 2 * radius };
+        put_vertex(m, 0, center, color, top_left, size);
+        for (size_t i = 0; i < segments; i++)
+            put_vertex(m, 1 + i, on_circle(center, radius, 2 * constexpr_math::pi * (double) i / segments),
+                       color, top_left, size);
+        fan_indices(m);
+        return m;
+    }
+
+    template<size_t corner_segments> requires (corner_segments >= 1)
+    constexpr mesh<1 + 4 * (corner_segments + 1), 3 * 4 * (corner_segments + 1)>
+    rounded_rect(vec2<float> position, vec2<float> dimensions, float radius, rgba<float> color)
+    {
+        mesh<1 + 4 * (corner_segments + 1), 3 * 4 * (corner_segments + 1)> m;
+        const float x = position.x, y = position.y, w = dimensions.x, h = dimensions.y;
+        put_vertex(m, 0, { x + w / 2, y - h / 2 }, color, position, dimensions);
+
+        // centers of the corner arcs, counter-clockwise starting from the top right
+        const std::array<vec2<float>, 4> corners = {
+            vec2<float>{ x + w - radius, y - radius     }, //    top right
+            vec2<float>{ x + radius,     y - radius     }, //    top left
+            vec2<float>{ x + radius,     y - h + radius }, // bottom left
+            vec2<float>{ x + w - radius, y - h + radius }  // bottom right
+        };
+        size_t v = 1;
+        for (size_t c = 0; c < 4; c++)
+            for (size_t s = 0; s <= corner_segments; s++)
+            {
+                // each arc covers a quarter turn, starting where the previous one ended
+                const double angle = constexpr_math::pi / 2 * ((double) c + (double) s / corner_segments);
+                put_vertex(m, v++, on_circle(corners[c], radius, angle), color, position, dimensions);
+            }
+        fan_indices(m);
+        return m;
+    }
+
+    template<size_t columns, size_t rows> requires (columns >= 1 && rows >= 1)
+    constexpr mesh<(columns + 1) * (rows + 1), 6 * columns * rows>
+    grid(vec2<float> position, vec2<float> dimensions, rgba<float> color)
+    {
+        mesh<(columns + 1) * (rows + 1), 6 * columns * rows> m;
+        for (size_t r = 0; r <= rows; r++)
+            for (size_t c = 0; c <= columns; c++)
+                put_vertex(m, r * (columns + 1) + c,
+                           { position.x + dimensions.x * (float) c / columns,
+                             position.y - dimensions.y * (float) r / rows },
+                           color, position, dimensions);
+
+        size_t i = 0;
+        for (size_t r = 0; r < rows; r++)
+            for (size_t c = 0; c < columns; c++)
+            {
+                const auto top_left     = (unsigned int) (r * (columns + 1) + c);
+                const auto bottom_left  = (unsigned int) (top_left + columns + 1);
+                // same triangles as rect()
+                for (unsigned int index : { top_left, bottom_left, bottom_left + 1,  top_left, bottom_left + 1, top_left + 1 })
+                    m.indices[i++] = index;
+            }
+        return m;
+    }
+
+    template<size_t v_count, size_t i_count>
+    constexpr void set_color(mesh<v_count, i_count>& m, size_t i, rgba<float> color)
+    {
+        float* v = m.vertices.data() + i * mesh<v_count, i_count>::vertex_length;
+        for (unsigned char c = 0; c < 4; c++)
+            v[3 + c] = color[c];
+    }
+}
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "mesh.h"
+#include "shader-program.h"
+
+size_t vertex_attribute::bytes() const
+{
+    // the packed types hold all 4 components in one value
+    if (this->type == GL_INT_2_10_10_10_REV || this->type == GL_UNSIGNED_INT_2_10_10_10_REV)
+        return VertexLayout::size_of(this->type);
+    return VertexLayout::size_of(this->type) * this->components;
+}
+
+size_t VertexLayout::size_of(GLenum type)
+{
+    switch (type)
+    {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:               return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:                  return 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+        case GL_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV: return 4;
+        default:                             return 0;
+    }
+}
+
+VertexLayout& VertexLayout::add(GLuint location, GLint components, GLenum type, bool normalized, size_t stream)
+{
+    const bool packed = type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV;
+    if (components < 1 || components > 4 || size_of(type) == 0 || (packed && components != 4))
+    {
+        const std::string error_str = "Vertex attribute " + std::to_string(location) + " can't have " + std::to_string(components)
+                                    + " components of type " + std::to_string(type);
+        std::cerr << error_str << std::endl;
+        throw std::invalid_argument{error_str};
+    }
+
+    if (stream >= this->strides.size())
+        this->strides.resize(stream + 1, 0);
+    const vertex_attribute attribute{ location, components, type, normalized, stream, (this->strides[stream] + 3) / 4 * 4 };
+    this->strides[stream] = (attribute.offset + attribute.bytes() + 3) / 4 * 4;
+    this->_attributes.push_back(attribute);
+    return *this;
+}
+
+VertexLayout VertexLayout::shape2d()
+{
+    VertexLayout layout;
+    layout.add(0, 3).add(1, 4).add(2, 2);
+    return layout;
+}
+
+size_t VertexLayout::vertex_bytes() const
+{
+    size_t bytes = 0;
+    for (const size_t stride : this->strides)
+        bytes += stride;
+    return bytes;
+}
+
+
+Mesh::Mesh(const VertexLayout& layout, std::initializer_list<std::span<const std::byte>> streams, std::span<const unsigned int> indices,
+           GLenum mode, GLenum usage)
+    : _layout(layout), _index_count(indices.size()), mode(mode)
+{
+    std::string error_str;
+    if (layout.attributes().empty() || streams.size() != layout.streams())
+        error_str = "Can't make a mesh of " + std::to_string(streams.size()) + " streams with a layout of "
+                  + std::to_string(layout.streams());
+    for (size_t i = 0; i < streams.size() && error_str.empty(); i++)
+    {
+        // a stream the layout has no attributes in has a stride of 0
+        const size_t stride = layout.stride(i), bytes = streams.begin()[i].size();
+        if (i == 0 && stride != 0)
+            this->_vertex_count = bytes / stride;
+        if (stride == 0 || bytes % stride != 0 || bytes / stride != this->_vertex_count)
+            error_str = "Stream " + std::to_string(i) + " of the mesh has " + std::to_string(bytes) + " bytes, not "
+                      + std::to_string(this->_vertex_count) + " vertices of " + std::to_string(stride);
+    }
+    if (error_str.empty() && indices.empty())
+        error_str = "Cannot make a mesh with 0 indices";
+    if (error_str.empty())
+        if (const auto last = std::ranges::max_element(indices); *last >= this->_vertex_count)
+            error_str = "Mesh index " + std::to_string(*last) + " is past its last vertex (" + std::to_string(this->_vertex_count) + " vertices)";
+    if (!error_str.empty())
+    {
+        std::cerr << error_str << std::endl;
+        throw std::invalid_argument{error_str};
+    }
+
+    glGenVertexArrays(1, &this->vertex_array);
+    this->vertex_buffers.resize(streams.size());
+    glGenBuffers((GLsizei) this->vertex_buffers.size(), this->vertex_buffers.data());
+    glGenBuffers(1, &this->element_buffer);
+
+    gl_state::bind_vertex_array(this->vertex_array);
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        gl_state::bind_buffer(GL_ARRAY_BUFFER, this->vertex_buffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) streams.begin()[i].size(), streams.begin()[i].data(), usage);
+    }
+    for (const vertex_attribute& a : layout.attributes())
+    {
+        // each attribute reads from the buffer bound when it is pointed
+        gl_state::bind_buffer(GL_ARRAY_BUFFER, this->vertex_buffers[a.stream]);
+        glVertexAttribPointer(a.location, a.components, a.type, a.normalized ? GL_TRUE : GL_FALSE,
+                              (GLsizei) layout.stride(a.stream), (void*) a.offset);
+        glEnableVertexAttribArray(a.location);
+    }
+
+    gl_state::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, this->element_buffer);
+    if (this->_vertex_count < 0x10000)
+    {
+        // every index fits in 16 bits
+        this->_index_type = GL_UNSIGNED_SHORT;
+        const std::vector<std::uint16_t> short_indices(indices.begin(), indices.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr) this->index_bytes(), short_indices.data(), GL_STATIC_DRAW);
+    }
+    else
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr) this->index_bytes(), indices.data(), GL_STATIC_DRAW);
+}
+
+Mesh::Mesh(const VertexLayout& layout, std::span<const float> vertices, std::span<const unsigned int> indices,
+           GLenum mode, GLenum usage)
+    : Mesh(layout, { std::as_bytes(vertices) }, indices, mode, usage) {  }
+
+//! @brief GL type of the values of @param type, and whether they are normalized
+static std::pair<GLenum, bool> gl_type_of(vertex_quantize::format type)
+{
+    using vertex_quantize::format;
+    switch (type)
+    {
+        case format::half:             return { GL_HALF_FLOAT, false };
+        case format::snorm16:          return { GL_SHORT, true };
+        case format::unorm16:          return { GL_UNSIGNED_SHORT, true };
+        case format::unorm8:           return { GL_UNSIGNED_BYTE, true };
+        case format::snorm_10_10_10_2: return { GL_INT_2_10_10_10_REV, true };
+        default:                       return { GL_FLOAT, false };
+    }
+}
+
+//! @brief The layout of @param vertices: position, color and tex_coord at 0, 1 and 2, like VertexLayout::shape2d()
+static VertexLayout layout_of(const vertex_quantize::vertices& vertices)
+{
+    VertexLayout layout;
+    const std::pair<const vertex_quantize::attribute&, GLuint> attributes[] = {
+        { vertices.position, 0 }, { vertices.color, 1 }, { vertices.tex_coord, 2 }, { vertices.normal, vertices.normal_location }
+    };
+    for (const auto& [a, location] : attributes)
+        if (a.components > 0)
+        {
+            const auto [type, normalized] = gl_type_of(a.type);
+            // 10_10_10_2 is always read as 4 components: w is 0
+            layout.add(location, a.type == vertex_quantize::format::snorm_10_10_10_2 ? 4 : (GLint) a.components, type, normalized);
+        }
+    return layout;
+}
+
+Mesh::Mesh(const vertex_quantize::vertices& vertices, std::span<const unsigned int> indices, GLenum mode, GLenum usage)
+    : Mesh(layout_of(vertices), { std::span<const std::byte>(vertices.data) }, indices, mode, usage) {  }
+
+Mesh::~Mesh() { this->release(); }
+
+Mesh::Mesh(Mesh&& other) noexcept
+    : _layout(std::move(other._layout)), _vertex_count(other._vertex_count), _index_count(other._index_count),
+      _index_type(other._index_type), mode(other.mode), vertex_array(other.vertex_array),
+      vertex_buffers(std::move(other.vertex_buffers)), element_buffer(other.element_buffer)
+{
+    other.vertex_array = 0;
+    other.vertex_buffers.clear();
+    other.element_buffer = 0;
+    other._vertex_count = 0;
+    other._index_count = 0;
+}
+
+Mesh& Mesh::operator=(Mesh&& other) noexcept
+{
+    if (this != &other)
+    {
+        this->release();
+        this->_layout = std::move(other._layout);
+        this->_vertex_count = other._vertex_count;
+        this->_index_count = other._index_count;
+        this->_index_type = other._index_type;
+        this->mode = other.mode;
+        this->vertex_array = other.vertex_array;
+        this->vertex_buffers = std::move(other.vertex_buffers);
+        this->element_buffer = other.element_buffer;
+        other.vertex_array = 0;
+        other.vertex_buffers.clear();
+        other.element_buffer = 0;
+        other._vertex_count = 0;
+        other._index_count = 0;
+    }
+    return *this;
+}
+
+void Mesh::release()
+{
+    if (this->vertex_array != 0)
+        gl_state::delete_vertex_arrays(1, &this->vertex_array);
+    if (!this->vertex_buffers.empty())
+        gl_state::delete_buffers((GLsizei) this->vertex_buffers.size(), this->vertex_buffers.data());
+    if (this->element_buffer != 0)
+        gl_state::delete_buffers(1, &this->element_buffer);
+    this->vertex_array = 0;
+    this->vertex_buffers.clear();
+    this->element_buffer = 0;
+}
+
+void Mesh::update_stream(size_t stream, std::span<const std::byte> data, size_t first_vertex)
+{
+    if (stream >= this->vertex_buffers.size())
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: Mesh has no such stream"};
+    const size_t stride = this->_layout.stride(stream);
+    if (data.size() % stride != 0 || first_vertex + data.size() / stride > this->_vertex_count)
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: Mesh stream update goes past the last vertex"};
+
+    gl_state::bind_buffer(GL_ARRAY_BUFFER, this->vertex_buffers[stream]);
+    glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) (first_vertex * stride), (GLsizeiptr) data.size(), data.data());
+}
+
+void Mesh::draw() const
+{
+    gl_state::bind_vertex_array(this->vertex_array);
+    ShaderProgram::flush_in_use();
+    glDrawElements(this->mode, (GLsizei) this->_index_count, this->_index_type, nullptr);
+}
+
+size_t Mesh::index_bytes() const
+{
+    return this->_index_count * (this->_index_type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(std::uint32_t));
+}
+
+size_t Mesh::gpu_bytes() const { return this->_vertex_count * this->_layout.vertex_bytes() + this->index_bytes(); }
@@ -0,0 +1,496 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <utility>
+#include "pixel-ops.h"
+#include "simd.h"
+
+namespace pixel_ops
+{
+    /// --- LEVELS ---
+    std::vector<mip_level> mip_levels(int width, int height)
+    {
+        std::vector<mip_level> levels;
+        if (width <= 0 || height <= 0)
+            return levels;
+        size_t offset = 0;
+        while (true)
+        {
+            const size_t size = (size_t) width * height * 4;
+            levels.push_back({ width, height, offset, size });
+            offset += size;
+            if (width == 1 && height == 1)
+                return levels;
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+    }
+
+    size_t mip_chain_size(int width, int height)
+    {
+        const std::vector<mip_level> levels = mip_levels(width, height);
+        return levels.empty() ? 0 : levels.back().offset + levels.back().size;
+    }
+
+
+    /// --- COLOR SPACE ---
+    //! @brief Steps of the linear to sRGB table. Fine enough that every sRGB byte has its own step, even near black
+    static constexpr int linear_steps = 65535;
+
+    //! @brief sRGB byte -> linear light in [0, 1]
+    static const std::array<float, 256>& srgb_to_linear()
+    {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> t{};
+            for (int i = 0; i < 256; i++)
+            {
+                const double c = i / 255.0;
+                t[i] = (float) (c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    //! @brief Linear light in [0, 1] (in linear_steps steps) -> sRGB byte
+    static const std::array<unsigned char, linear_steps + 1>& linear_to_srgb()
+    {
+        static const std::array<unsigned char, linear_steps + 1> table = [] {
+            std::array<unsigned char, linear_steps + 1> t{};
+            for (int i = 0; i <= linear_steps; i++)
+            {
+                const double l = (double) i / linear_steps;
+                const double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1 / 2.4) - 0.055;
+                t[i] = (unsigned char) std::lround(std::clamp(c, 0.0, 1.0) * 255);
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    //! @brief Channel @param c of a pixel in [0, 1]. Linear light if @param srgb (alpha always is linear)
+    static float to_float(unsigned char v, int c, bool srgb)
+    {
+        return srgb && c < 3 ? srgb_to_linear()[v] : (float) v * (1 / 255.0f);
+    }
+
+    static unsigned char to_byte(float v, int c, bool srgb)
+    {
+        v = std::clamp(v, 0.0f, 1.0f);
+        if (srgb && c < 3)
+            return linear_to_srgb()[(size_t) (v * linear_steps + 0.5f)];
+        return (unsigned char) (v * 255 + 0.5f);
+    }
+
+
+    /// --- KAISER FILTER ---
+    //! @brief Taps of the 2:1 Kaiser filter, at -3.5 to 3.5 source pixels from the center of the destination pixel
+    static constexpr int kaiser_taps = 8;
+
+    static const std::array<float, kaiser_taps>& kaiser_weights()
+    {
+        static const std::array<float, kaiser_taps> weights = [] {
+            constexpr double beta = 4.0;
+            constexpr double radius = kaiser_taps / 2.0;
+            // modified Bessel function of the first kind, order 0
+            const auto i0 = [](double x) {
+                double sum = 1, term = 1;
+                for (int k = 1; k < 25; k++)
+                {
+                    term *= (x / (2 * k)) * (x / (2 * k));
+                    sum += term;
+                }
+                return sum;
+            };
+
+            std::array<float, kaiser_taps> w{};
+            double total = 0;
+            for (int t = 0; t < kaiser_taps; t++)
+            {
+                const double d = t - (kaiser_taps - 1) / 2.0;
+                // low pass at half the source frequency: sinc of the distance in destination pixels
+                const double x = std::numbers::pi * d / 2;
+                const double r = d / radius;
+                w[t] = (float) (std::sin(x) / x * i0(beta * std::sqrt(1 - r * r)) / i0(beta));
+                total += w[t];
+            }
+            for (float& v : w)
+                v = (float) (v / total);
+            return w;
+        }();
+        return weights;
+    }
+
+    //! @brief Index of tap @param t for destination pixel @param i, clamped to the @param size source pixels
+    static int kaiser_source(int i, int t, int size) { return std::clamp(2 * i - (kaiser_taps / 2 - 1) + t, 0, size - 1); }
+
+
+    /// --- SCALAR ---
+    namespace scalar
+    {
+        void expand_to_rgba(const unsigned char* src, unsigned char* dst, size_t count, int channels)
+        {
+            if (channels == 4)
+            {
+                if (src != dst)
+                    std::memmove(dst, src, count * 4);
+                return;
+            }
+            // backwards, so it works in place: a pixel is only written after the pixels that come after it were read
+            for (size_t i = count; i-- > 0;)
+            {
+                const unsigned char* s = src + i * channels;
+                unsigned char* d = dst + i * 4;
+                const unsigned char r = s[0];
+                const unsigned char g = channels >= 3 ? s[1] : r;
+                const unsigned char b = channels >= 3 ? s[2] : r;
+                const unsigned char a = channels == 2 ? s[1] : 255;
+                d[0] = r;
+                d[1] = g;
+                d[2] = b;
+                d[3] = a;
+            }
+        }
+
+        void premultiply_alpha(unsigned char* rgba, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                unsigned char* p = rgba + i * 4;
+                for (int c = 0; c < 3; c++)
+                {
+                    // c * a / 255, rounded
+                    const unsigned int x = p[c] * p[3] + 128;
+                    p[c] = (unsigned char) ((x + (x >> 8)) >> 8);
+                }
+            }
+        }
+
+        void flip_vertically(unsigned char* pixels, int width, int height, int bytes_per_pixel)
+        {
+            const size_t row = (size_t) width * bytes_per_pixel;
+            for (int y = 0; y < height / 2; y++)
+            {
+                unsigned char* a = pixels + y * row;
+                unsigned char* b = pixels + (height - 1 - y) * row;
+                for (size_t i = 0; i < row; i++)
+                    std::swap(a[i], b[i]);
+            }
+        }
+
+        static void box(const unsigned char* src, int width, int height, unsigned char* dst, bool srgb)
+        {
+            const int w2 = std::max(width / 2, 1);
+            const int h2 = std::max(height / 2, 1);
+            for (int y = 0; y < h2; y++)
+            {
+                // an odd row or column at the end is left out, like most glGenerateMipmap implementations
+                const unsigned char* r0 = src + (size_t) std::min(y * 2, height - 1) * width * 4;
+                const unsigned char* r1 = src + (size_t) std::min(y * 2 + 1, height - 1) * width * 4;
+                for (int x = 0; x < w2; x++)
+                {
+                    const size_t c0 = (size_t) std::min(x * 2, width - 1) * 4;
+                    const size_t c1 = (size_t) std::min(x * 2 + 1, width - 1) * 4;
+                    unsigned char* d = dst + ((size_t) y * w2 + x) * 4;
+                    for (int c = 0; c < 4; c++)
+                        if (srgb && c < 3)
+                            d[c] = to_byte((to_float(r0[c0 + c], c, true) + to_float(r0[c1 + c], c, true)
+                                          + to_float(r1[c0 + c], c, true) + to_float(r1[c1 + c], c, true)) * 0.25f, c, true);
+                        else
+                            d[c] = (unsigned char) ((r0[c0 + c] + r0[c1 + c] + r1[c0 + c] + r1[c1 + c] + 2) / 4);
+                }
+            }
+        }
+
+        static void kaiser(const unsigned char* src, int width, int height, unsigned char* dst, bool srgb)
+        {
+            const int w2 = std::max(width / 2, 1);
+            const int h2 = std::max(height / 2, 1);
+            const auto& k = kaiser_weights();
+
+            // horizontal pass: every source row filtered down to w2 pixels
+            std::vector<std::array<float, 4>> rows((size_t) w2 * height);
+            for (int y = 0; y < height; y++)
+                for (int x = 0; x < w2; x++)
+                {
+                    std::array<float, 4> acc{};
+                    for (int t = 0; t < kaiser_taps; t++)
+                    {
+                        const unsigned char* p = src + ((size_t) y * width + kaiser_source(x, t, width)) * 4;
+                        for (int c = 0; c < 4; c++)
+                            acc[c] += to_float(p[c], c, srgb) * k[t];
+                    }
+                    rows[(size_t) y * w2 + x] = acc;
+                }
+            // vertical pass
+            for (int y = 0; y < h2; y++)
+                for (int x = 0; x < w2; x++)
+                {
+                    std::array<float, 4> acc{};
+                    for (int t = 0; t < kaiser_taps; t++)
+                        for (int c = 0; c < 4; c++)
+                            acc[c] += rows[(size_t) kaiser_source(y, t, height) * w2 + x][c] * k[t];
+                    for (int c = 0; c < 4; c++)
+                        dst[((size_t) y * w2 + x) * 4 + c] = to_byte(acc[c], c, srgb);
+                }
+        }
+
+        void downsample(const unsigned char* src, int width, int height, unsigned char* dst, mip_filter filter, bool srgb)
+        {
+            if (filter == mip_filter::kaiser)
+                kaiser(src, width, height, dst, srgb);
+            else
+                box(src, width, height, dst, srgb);
+        }
+    }
+
+
+    /// --- SIMD ---
+    //! @brief One pixel in [0, 1], linear light if @param srgb
+    static simd::f32x4 load_pixel(const unsigned char* p, bool srgb)
+    {
+        return simd::set(to_float(p[0], 0, srgb), to_float(p[1], 1, srgb), to_float(p[2], 2, srgb), (float) p[3] * (1 / 255.0f));
+    }
+
+    static void store_pixel(unsigned char* d, simd::f32x4 v, bool srgb)
+    {
+        v = simd::min(simd::max(v, simd::splat(0)), simd::splat(1));
+#ifdef OPENGL_SIMD_SSE
+        // scale to table index (or byte) and round in one go
+        const float color_scale = srgb ? (float) linear_steps : 255.0f;
+        alignas(16) int i[4];
+        _mm_store_si128((__m128i*) i, _mm_cvtps_epi32(_mm_mul_ps(v.v, _mm_setr_ps(color_scale, color_scale, color_scale, 255))));
+        for (int c = 0; c < 3; c++)
+            d[c] = srgb ? linear_to_srgb()[i[c]] : (unsigned char) i[c];
+        d[3] = (unsigned char) i[3];
+#else
+        for (int c = 0; c < 4; c++)
+            d[c] = to_byte(simd::lane(v, c), c, srgb);
+#endif
+    }
+
+    //! @brief Same as scalar::kaiser(), with one pixel per f32x4
+    static void kaiser(const unsigned char* src, int width, int height, unsigned char* dst, bool srgb)
+    {
+        const int w2 = std::max(width / 2, 1);
+        const int h2 = std::max(height / 2, 1);
+        std::array<simd::f32x4, kaiser_taps> k;
+        for (int t = 0; t < kaiser_taps; t++)
+            k[t] = simd::splat(kaiser_weights()[t]);
+
+        std::vector<simd::f32x4> line(width);
+        std::vector<simd::f32x4> rows((size_t) w2 * height);
+        for (int y = 0; y < height; y++)
+        {
+            // convert each source pixel once, not once per tap
+            const unsigned char* row = src + (size_t) y * width * 4;
+            for (int x = 0; x < width; x++)
+                line[x] = load_pixel(row + x * 4, srgb);
+            for (int x = 0; x < w2; x++)
+            {
+                simd::f32x4 acc = simd::splat(0);
+                for (int t = 0; t < kaiser_taps; t++)
+                    acc = simd::add(acc, simd::mul(line[kaiser_source(x, t, width)], k[t]));
+                rows[(size_t) y * w2 + x] = acc;
+            }
+        }
+        for (int y = 0; y < h2; y++)
+        {
+            const simd::f32x4* taps[kaiser_taps];
+            for (int t = 0; t < kaiser_taps; t++)
+                taps[t] = rows.data() + (size_t) kaiser_source(y, t, height) * w2;
+            for (int x = 0; x < w2; x++)
+            {
+                simd::f32x4 acc = simd::splat(0);
+                for (int t = 0; t < kaiser_taps; t++)
+                    acc = simd::add(acc, simd::mul(taps[t][x], k[t]));
+                store_pixel(dst + ((size_t) y * w2 + x) * 4, acc, srgb);
+            }
+        }
+    }
+
+#ifdef OPENGL_SIMD_SSE
+    void expand_to_rgba(const unsigned char* src, unsigned char* dst, size_t count, int channels)
+    {
+        // pixels per 16 byte load
+        size_t block = 0;
+        if (channels == 1)
+            block = 16;
+        else if (channels == 2)
+            block = 8;
+        else if (channels == 3)
+            block = 4; // 12 of the 16 bytes
+        if (block == 0)
+            return scalar::expand_to_rgba(src, dst, count, channels);
+
+        // blocks are written from the last one, so this works in place like the scalar version.
+        // The pixels after the last whole 16 byte load are done first
+        const size_t bytes = count * channels;
+        const size_t blocks = bytes >= 16 ? (bytes - 16) / (block * channels) + 1 : 0;
+        const size_t simd_count = blocks * block;
+        scalar::expand_to_rgba(src + simd_count * channels, dst + simd_count * 4, count - simd_count, channels);
+
+        for (size_t b = blocks; b-- > 0;)
+        {
+            const size_t i = b * block;
+            const __m128i v = _mm_loadu_si128((const __m128i*) (src + i * channels));
+            auto* out = (__m128i*) (dst + i * 4);
+            if (channels == 1)
+            {
+                // (g, g) and (g, 255) pairs, interleaved into (g, g, g, 255)
+                const __m128i ff = _mm_set1_epi8((char) 0xFF);
+                const __m128i gg_lo = _mm_unpacklo_epi8(v, v), gg_hi = _mm_unpackhi_epi8(v, v);
+                const __m128i ga_lo = _mm_unpacklo_epi8(v, ff), ga_hi = _mm_unpackhi_epi8(v, ff);
+                _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(gg_lo, ga_lo));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(gg_lo, ga_lo));
+                _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(gg_hi, ga_hi));
+                _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(gg_hi, ga_hi));
+            }
+            else if (channels == 2)
+            {
+                // (g, g) pairs, interleaved with the (g, a) pairs that were loaded
+                const __m128i g = _mm_and_si128(v, _mm_set1_epi16(0x00FF));
+                const __m128i gg = _mm_or_si128(g, _mm_slli_epi16(g, 8));
+                _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(gg, v));
+                _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(gg, v));
+            }
+            else
+            {
+                // SSE2 has no byte shuffle (pshufb is SSSE3): shift each pixel to the bottom dword and gather the 4 bottom dwords.
+                // Each dword also has the first byte of the next pixel, which the alpha then replaces
+                const __m128i p01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+                const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+                const __m128i opaque = _mm_set1_epi32((int) 0xFF000000);
+                _mm_storeu_si128(out, _mm_or_si128(_mm_unpacklo_epi64(p01, p23), opaque));
+            }
+        }
+    }
+
+    //! @brief Premultiply 2 pixels widened to 16 bits per channel
+    static __m128i premultiply_2(__m128i p)
+    {
+        const __m128i alpha_lanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+        __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        // alpha is multiplied by 255, so it stays the same
+        a = _mm_or_si128(_mm_andnot_si128(alpha_lanes, a), _mm_and_si128(alpha_lanes, _mm_set1_epi16(255)));
+        // c * a / 255, rounded: (x + (x >> 8)) >> 8 with x = c * a + 128. Fits in 16 bits
+        const __m128i x = _mm_add_epi16(_mm_mullo_epi16(p, a), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    void premultiply_alpha(unsigned char* rgba, size_t count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            auto* p = (__m128i*) (rgba + i * 4);
+            const __m128i v = _mm_loadu_si128(p);
+            const __m128i lo = premultiply_2(_mm_unpacklo_epi8(v, zero));
+            const __m128i hi = premultiply_2(_mm_unpackhi_epi8(v, zero));
+            _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+        }
+        scalar::premultiply_alpha(rgba + i * 4, count - i);
+    }
+
+    void flip_vertically(unsigned char* pixels, int width, int height, int bytes_per_pixel)
+    {
+        // only moves memory: the compiler already vectorizes the swap loop as well as intrinsics would
+        scalar::flip_vertically(pixels, width, height, bytes_per_pixel);
+    }
+
+    static void box(const unsigned char* src, int width, int height, unsigned char* dst, bool srgb)
+    {
+        const int w2 = std::max(width / 2, 1);
+        const int h2 = std::max(height / 2, 1);
+        const __m128i zero = _mm_setzero_si128();
+        for (int y = 0; y < h2; y++)
+        {
+            const unsigned char* r0 = src + (size_t) std::min(y * 2, height - 1) * width * 4;
+            const unsigned char* r1 = src + (size_t) std::min(y * 2 + 1, height - 1) * width * 4;
+            unsigned char* d = dst + (size_t) y * w2 * 4;
+            int x = 0;
+            if (srgb)
+                // 4 pixels in linear light, one pixel per f32x4
+                for (; x < w2 && x * 2 + 1 < width; x++)
+                {
+                    const simd::f32x4 sum = simd::add(simd::add(load_pixel(r0 + x * 8, true), load_pixel(r0 + x * 8 + 4, true)),
+                                                      simd::add(load_pixel(r1 + x * 8, true), load_pixel(r1 + x * 8 + 4, true)));
+                    store_pixel(d + x * 4, simd::mul(sum, simd::splat(0.25f)), true);
+                }
+            else
+                // 2 destination pixels from 2x4 source pixels, in 16 bit lanes
+                for (; x + 2 <= w2 && x * 2 + 4 <= width; x += 2)
+                {
+                    const __m128i a = _mm_loadu_si128((const __m128i*) (r0 + x * 8));
+                    const __m128i b = _mm_loadu_si128((const __m128i*) (r1 + x * 8));
+                    // rows added: pixels 0 and 1 in lo, 2 and 3 in hi
+                    const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                    const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                    // columns added: (0 + 1, 2 + 3)
+                    __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+                    sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+                    _mm_storel_epi64((__m128i*) (d + x * 4), _mm_packus_epi16(sum, sum));
+                }
+
+            // the rest (and the clamped column of 1 pixel wide images)
+            if (x < w2)
+            {
+                unsigned char rest[2 * 4 * 4];
+                for (; x < w2; x++)
+                {
+                    // 2x2 source block with the edges clamped, as its own 2x2 image
+                    const size_t c0 = (size_t) std::min(x * 2, width - 1) * 4;
+                    const size_t c1 = (size_t) std::min(x * 2 + 1, width - 1) * 4;
+                    std::memcpy(rest, r0 + c0, 4);
+                    std::memcpy(rest + 4, r0 + c1, 4);
+                    std::memcpy(rest + 8, r1 + c0, 4);
+                    std::memcpy(rest + 12, r1 + c1, 4);
+                    scalar::downsample(rest, 2, 2, d + x * 4, mip_filter::box, srgb);
+                }
+            }
+        }
+    }
+
+    void downsample(const unsigned char* src, int width, int height, unsigned char* dst, mip_filter filter, bool srgb)
+    {
+        if (filter == mip_filter::kaiser)
+            kaiser(src, width, height, dst, srgb);
+        else
+            box(src, width, height, dst, srgb);
+    }
+#else
+    void expand_to_rgba(const unsigned char* src, unsigned char* dst, size_t count, int channels)
+    {
+        scalar::expand_to_rgba(src, dst, count, channels);
+    }
+
+    void premultiply_alpha(unsigned char* rgba, size_t count) { scalar::premultiply_alpha(rgba, count); }
+
+    void flip_vertically(unsigned char* pixels, int width, int height, int bytes_per_pixel)
+    {
+        scalar::flip_vertically(pixels, width, height, bytes_per_pixel);
+    }
+
+    void downsample(const unsigned char* src, int width, int height, unsigned char* dst, mip_filter filter, bool srgb)
+    {
+        // f32x4 has a scalar fallback, so the Kaiser filter is the same code
+        if (filter == mip_filter::kaiser)
+            kaiser(src, width, height, dst, srgb);
+        else
+            scalar::downsample(src, width, height, dst, filter, srgb);
+    }
+#endif
+
+
+    void generate_mipmaps(unsigned char* chain, int width, int height, mip_filter filter, bool srgb)
+    {
+        // each level from the one before it
+        const std::vector<mip_level> levels = mip_levels(width, height);
+        for (size_t i = 1; i < levels.size(); i++)
+            downsample(chain + levels[i - 1].offset, levels[i - 1].width, levels[i - 1].height,
+                       chain + levels[i].offset, filter, srgb);
+    }
+}
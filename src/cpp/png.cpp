@@ -0,0 +1,710 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include "png.h"
+#include "simd.h"
+
+namespace png
+{
+    /// --- INFLATE ---
+    //! @brief Huffman codes up to this long are decoded with one lookup
+    static constexpr int fast_bits = 10;
+
+    //! @brief Bits of a deflate stream, least significant first
+    struct bit_reader
+    {
+        const unsigned char* p;
+        const unsigned char* end;
+        std::uint64_t bits = 0;
+        int count = 0;
+        //! @brief Zero bytes added after the end of the stream. Consuming them means the stream is corrupt
+        int padding = 0;
+
+        //! @brief Have at least 56 bits in the buffer
+        void refill()
+        {
+            if (this->end - this->p >= 8)
+            {
+                std::uint64_t next;
+                std::memcpy(&next, this->p, sizeof(next));
+                if constexpr (std::endian::native == std::endian::big)
+                    next = std::byteswap(next);
+                this->bits |= next << this->count;
+                this->p += (63 - this->count) >> 3;
+                this->count |= 56;
+            }
+            else
+                while (this->count <= 56)
+                {
+                    if (this->p < this->end)
+                        this->bits |= (std::uint64_t) *this->p++ << this->count;
+                    else
+                        this->padding++;
+                    this->count += 8;
+                }
+        }
+        [[nodiscard]] std::uint32_t peek(int n) const { return (std::uint32_t) (this->bits & ((std::uint64_t{1} << n) - 1)); }
+        void consume(int n) { this->bits >>= n; this->count -= n; }
+        std::uint32_t take(int n) { const std::uint32_t val = this->peek(n); this->consume(n); return val; }
+        [[nodiscard]] bool overrun() const { return this->padding * 8 > this->count; }
+    };
+
+    //! @brief Canonical Huffman code (RFC 1951 3.2.2)
+    struct huffman
+    {
+        //! @brief symbol << 4 | code length, indexed by the next fast_bits bits. 0 if the code is longer than fast_bits
+        std::uint16_t fast[1 << fast_bits];
+        //! @brief Number of codes of each length
+        std::uint16_t count[16];
+        //! @brief Sorted by code
+        std::uint16_t symbols[288];
+
+        //! @brief From the code @param lengths of @param n symbols. false if there are more codes than lengths allow
+        bool build(const unsigned char* lengths, int n)
+        {
+            std::memset(this->fast, 0, sizeof(this->fast));
+            std::memset(this->count, 0, sizeof(this->count));
+            for (int i = 0; i < n; i++)
+                this->count[lengths[i]]++;
+            this->count[0] = 0;
+
+            int left = 1;
+            for (int len = 1; len < 16; len++)
+            {
+                left = (left << 1) - this->count[len];
+                if (left < 0)
+                    return false;
+            }
+
+            std::uint16_t offsets[16] = {};
+            for (int len = 1; len < 15; len++)
+                offsets[len + 1] = offsets[len] + this->count[len];
+            for (int i = 0; i < n; i++)
+                if (lengths[i] != 0)
+                    this->symbols[offsets[lengths[i]]++] = (std::uint16_t) i;
+
+            // deflate packs codes starting from their first bit, so the table is indexed by the reversed codes
+            int code = 0, index = 0;
+            for (int len = 1; len <= fast_bits; len++, code <<= 1)
+                for (int k = 0; k < this->count[len]; k++, code++, index++)
+                {
+                    int reversed = 0;
+                    for (int bit = 0; bit < len; bit++)
+                        reversed |= ((code >> bit) & 1) << (len - 1 - bit);
+                    const auto entry = (std::uint16_t) (this->symbols[index] << 4 | len);
+                    for (int i = reversed; i < (1 << fast_bits); i += 1 << len)
+                        this->fast[i] = entry;
+                }
+            return true;
+        }
+
+        //! @brief Next symbol of @param in, -1 if the bits aren't a code. @param in must have 15 bits
+        int decode(bit_reader& in) const
+        {
+            const std::uint16_t entry = this->fast[in.peek(fast_bits)];
+            if (entry != 0)
+            {
+                in.consume(entry & 15);
+                return entry >> 4;
+            }
+            // a code longer than fast_bits: one bit at a time
+            int code = 0, first = 0, index = 0;
+            for (int len = 1; len < 16; len++)
+            {
+                code |= (int) ((in.bits >> (len - 1)) & 1);
+                if (code - first < this->count[len])
+                {
+                    in.consume(len);
+                    return this->symbols[index + code - first];
+                }
+                index += this->count[len];
+                first = (first + this->count[len]) << 1;
+                code <<= 1;
+            }
+            return -1;
+        }
+    };
+
+    static constexpr std::uint16_t length_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                                       35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static constexpr unsigned char length_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static constexpr std::uint16_t distance_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+                                                         513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static constexpr unsigned char distance_extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7,
+                                                          8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    //! @brief Codes of the blocks with fixed Huffman codes (type 1)
+    static const std::pair<huffman, huffman>& fixed_codes()
+    {
+        static const std::pair<huffman, huffman> codes = [] {
+            std::pair<huffman, huffman> c;
+            unsigned char lengths[288];
+            std::memset(lengths, 8, 144);
+            std::memset(lengths + 144, 9, 112);
+            std::memset(lengths + 256, 7, 24);
+            std::memset(lengths + 280, 8, 8);
+            c.first.build(lengths, 288);
+            std::memset(lengths, 5, 32);
+            c.second.build(lengths, 32);
+            return c;
+        }();
+        return codes;
+    }
+
+    //! @brief Read the code lengths of a block with dynamic Huffman codes (type 2), and build its codes
+    static bool read_codes(bit_reader& in, huffman& literals, huffman& distances)
+    {
+        static constexpr unsigned char order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        in.refill();
+        const int literal_count = (int) in.take(5) + 257;
+        const int distance_count = (int) in.take(5) + 1;
+        const int length_count = (int) in.take(4) + 4;
+        unsigned char lengths[288 + 32] = {};
+        for (int i = 0; i < length_count; i++)
+        {
+            in.refill();
+            lengths[order[i]] = (unsigned char) in.take(3);
+        }
+        huffman length_code;
+        if (!length_code.build(lengths, 19))
+            return false;
+
+        std::memset(lengths, 0, 19);
+        const int total = literal_count + distance_count;
+        for (int n = 0; n < total;)
+        {
+            in.refill();
+            const int symbol = length_code.decode(in);
+            if (symbol < 0)
+                return false;
+            if (symbol < 16)
+            {
+                lengths[n++] = (unsigned char) symbol;
+                continue;
+            }
+            unsigned char val = 0;
+            int repeat;
+            if (symbol == 16)
+            {
+                if (n == 0)
+                    return false;
+                val = lengths[n - 1];
+                repeat = 3 + (int) in.take(2);
+            }
+            else if (symbol == 17)
+                repeat = 3 + (int) in.take(3);
+            else
+                repeat = 11 + (int) in.take(7);
+            if (n + repeat > total)
+                return false;
+            std::memset(lengths + n, val, repeat);
+            n += repeat;
+        }
+        // a block always ends with symbol 256
+        if (lengths[256] == 0)
+            return false;
+        return literals.build(lengths, literal_count) && distances.build(lengths + literal_count, distance_count);
+    }
+
+    //! @brief Decode the symbols of a compressed block until its end
+    static bool inflate_block(bit_reader& in, const huffman& literals, const huffman& distances,
+                              unsigned char*& out, unsigned char* start, unsigned char* end)
+    {
+        while (true)
+        {
+            // 56 bits are enough for a length and a distance with their extra bits (15 + 5 + 15 + 13)
+            in.refill();
+            int symbol = literals.decode(in);
+            if (symbol < 0)
+                return false;
+            if (symbol < 256)
+            {
+                if (out == end)
+                    return false;
+                *out++ = (unsigned char) symbol;
+                continue;
+            }
+            if (symbol == 256)
+                return true;
+
+            symbol -= 257;
+            if (symbol >= 29)
+                return false;
+            const size_t length = length_base[symbol] + in.take(length_extra[symbol]);
+            const int d = distances.decode(in);
+            if (d < 0 || d >= 30)
+                return false;
+            const size_t distance = distance_base[d] + in.take(distance_extra[d]);
+            if (distance > (size_t) (out - start) || length > (size_t) (end - out))
+                return false;
+
+            const unsigned char* src = out - distance;
+            if (distance >= 8 && (size_t) (end - out) >= length + 8)
+                // 8 bytes at a time. Each copy only reads bytes written before it, and writes at most 7 past the match
+                for (size_t i = 0; i < length; i += 8)
+                    std::memcpy(out + i, src + i, 8);
+            else if (distance == 1)
+                std::memset(out, src[0], length);
+            else
+                for (size_t i = 0; i < length; i++)
+                    out[i] = src[i];
+            out += length;
+        }
+    }
+
+    bool inflate(const unsigned char* data, size_t size, unsigned char* out, size_t out_size)
+    {
+        // zlib header: deflate, no preset dictionary
+        if (size < 2 || (data[0] & 15) != 8 || (data[0] << 8 | data[1]) % 31 != 0 || (data[1] & 32))
+            return false;
+
+        bit_reader in{ data + 2, data + size };
+        unsigned char* const start = out;
+        unsigned char* const end = out + out_size;
+        std::unique_ptr<std::pair<huffman, huffman>> dynamic;
+        bool last = false;
+        while (!last)
+        {
+            in.refill();
+            last = in.take(1);
+            const std::uint32_t type = in.take(2);
+            if (type == 0)
+            {
+                // stored: whole bytes, after the end of the current byte
+                in.consume(in.count & 7);
+                if (in.overrun())
+                    return false;
+                const unsigned char* pos = in.p - (in.count / 8 - in.padding);
+                in.bits = 0;
+                in.count = 0;
+                in.padding = 0;
+                if (in.end - pos < 4)
+                    return false;
+                const size_t length = pos[0] | pos[1] << 8;
+                if (length != (~(pos[2] | pos[3] << 8) & 0xffffu))
+                    return false;
+                pos += 4;
+                if ((size_t) (in.end - pos) < length || (size_t) (end - out) < length)
+                    return false;
+                std::memcpy(out, pos, length);
+                out += length;
+                in.p = pos + length;
+                continue;
+            }
+
+            bool ok;
+            if (type == 1)
+                ok = inflate_block(in, fixed_codes().first, fixed_codes().second, out, start, end);
+            else if (type == 2)
+            {
+                if (!dynamic)
+                    dynamic = std::make_unique<std::pair<huffman, huffman>>();
+                ok = read_codes(in, dynamic->first, dynamic->second)
+                  && inflate_block(in, dynamic->first, dynamic->second, out, start, end);
+            }
+            else
+                ok = false;
+            if (!ok || in.overrun())
+                return false;
+        }
+        return out == end;
+    }
+
+
+    /// --- SCALAR ---
+    namespace scalar
+    {
+        static unsigned char paeth(int a, int b, int c)
+        {
+            const int pa = std::abs(b - c);
+            const int pb = std::abs(a - c);
+            const int pc = std::abs(a + b - 2 * c);
+            if (pa <= pb && pa <= pc)
+                return (unsigned char) a;
+            return (unsigned char) (pb <= pc ? b : c);
+        }
+
+        void unfilter_row(row_filter filter, const unsigned char* src, const unsigned char* prior, unsigned char* dst,
+                          size_t length, int bytes_per_pixel)
+        {
+            const auto bpp = (size_t) bytes_per_pixel;
+            const size_t first = std::min(bpp, length);
+            switch (filter)
+            {
+            case row_filter::none:
+                std::memcpy(dst, src, length);
+                break;
+            case row_filter::sub:
+                std::memcpy(dst, src, first);
+                for (size_t i = bpp; i < length; i++)
+                    dst[i] = (unsigned char) (src[i] + dst[i - bpp]);
+                break;
+            case row_filter::up:
+                for (size_t i = 0; i < length; i++)
+                    dst[i] = (unsigned char) (src[i] + prior[i]);
+                break;
+            case row_filter::average:
+                for (size_t i = 0; i < first; i++)
+                    dst[i] = (unsigned char) (src[i] + (prior[i] >> 1));
+                for (size_t i = bpp; i < length; i++)
+                    dst[i] = (unsigned char) (src[i] + ((dst[i - bpp] + prior[i]) >> 1));
+                break;
+            case row_filter::paeth:
+                for (size_t i = 0; i < first; i++)
+                    dst[i] = (unsigned char) (src[i] + prior[i]);
+                for (size_t i = bpp; i < length; i++)
+                    dst[i] = (unsigned char) (src[i] + paeth(dst[i - bpp], prior[i], prior[i - bpp]));
+                break;
+            }
+        }
+    }
+
+
+    /// --- SIMD ---
+#ifdef OPENGL_SIMD_SSE
+    // Sub, Average and Paeth depend on the pixel to the left, so they go one pixel per step, all its bytes at once
+    // 3 byte pixels are put together with shifts: a memcpy of 3 bytes goes through the stack, and stalls on store forwarding
+    template<int bpp>
+    static __m128i load_pixel(const unsigned char* p)
+    {
+        int val;
+        if constexpr (bpp == 4)
+            std::memcpy(&val, p, 4);
+        else
+            val = p[0] | p[1] << 8 | p[2] << 16;
+        return _mm_cvtsi32_si128(val);
+    }
+    template<int bpp>
+    static void store_pixel(unsigned char* p, __m128i pixel)
+    {
+        const int val = _mm_cvtsi128_si32(pixel);
+        if constexpr (bpp == 4)
+            std::memcpy(p, &val, 4);
+        else
+        {
+            p[0] = (unsigned char) val;
+            p[1] = (unsigned char) (val >> 8);
+            p[2] = (unsigned char) (val >> 16);
+        }
+    }
+
+    template<int bpp>
+    static void unfilter_sub(const unsigned char* src, unsigned char* dst, size_t length)
+    {
+        __m128i left = _mm_setzero_si128();
+        for (size_t i = 0; i < length; i += bpp)
+        {
+            left = _mm_add_epi8(load_pixel<bpp>(src + i), left);
+            store_pixel<bpp>(dst + i, left);
+        }
+    }
+
+    template<int bpp>
+    static void unfilter_average(const unsigned char* src, const unsigned char* prior, unsigned char* dst, size_t length)
+    {
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i left = _mm_setzero_si128();
+        for (size_t i = 0; i < length; i += bpp)
+        {
+            const __m128i up = load_pixel<bpp>(prior + i);
+            // _mm_avg_epu8 rounds up, the filter rounds down
+            const __m128i average = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), one));
+            left = _mm_add_epi8(load_pixel<bpp>(src + i), average);
+            store_pixel<bpp>(dst + i, left);
+        }
+    }
+
+    template<int bpp>
+    static void unfilter_paeth(const unsigned char* src, const unsigned char* prior, unsigned char* dst, size_t length)
+    {
+        // in 16 bit lanes, so the differences don't overflow
+        const __m128i zero = _mm_setzero_si128();
+        const auto abs16 = [zero](__m128i x) { return _mm_max_epi16(x, _mm_sub_epi16(zero, x)); };
+        const auto select = [](__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); };
+        __m128i a = zero, c = zero; // left, upper left
+        for (size_t i = 0; i < length; i += bpp)
+        {
+            const __m128i b = _mm_unpacklo_epi8(load_pixel<bpp>(prior + i), zero);
+            const __m128i b_c = _mm_sub_epi16(b, c);
+            const __m128i a_c = _mm_sub_epi16(a, c);
+            const __m128i pa = abs16(b_c);
+            const __m128i pb = abs16(a_c);
+            const __m128i pc = abs16(_mm_add_epi16(b_c, a_c));
+            const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+            // ties go to a, then b, then c
+            const __m128i nearest = select(_mm_cmpeq_epi16(smallest, pa), a, select(_mm_cmpeq_epi16(smallest, pb), b, c));
+            const __m128i pixel = _mm_add_epi8(_mm_packus_epi16(nearest, nearest), load_pixel<bpp>(src + i));
+            store_pixel<bpp>(dst + i, pixel);
+            a = _mm_unpacklo_epi8(pixel, zero);
+            c = b;
+        }
+    }
+
+    template<int bpp>
+    static void unfilter_pixels(row_filter filter, const unsigned char* src, const unsigned char* prior, unsigned char* dst, size_t length)
+    {
+        if (filter == row_filter::sub)
+            unfilter_sub<bpp>(src, dst, length);
+        else if (filter == row_filter::average)
+            unfilter_average<bpp>(src, prior, dst, length);
+        else
+            unfilter_paeth<bpp>(src, prior, dst, length);
+    }
+
+    void unfilter_row(row_filter filter, const unsigned char* src, const unsigned char* prior, unsigned char* dst,
+                      size_t length, int bytes_per_pixel)
+    {
+        // None and Up don't depend on the left pixel: the compiler vectorizes their scalar loops.
+        // Sub on 3 byte pixels is as fast without SIMD, since putting the pixels together costs as much as adding them
+        if (bytes_per_pixel == 4 && length % 4 == 0 && filter != row_filter::none && filter != row_filter::up)
+            unfilter_pixels<4>(filter, src, prior, dst, length);
+        else if (bytes_per_pixel == 3 && length % 3 == 0 && (filter == row_filter::average || filter == row_filter::paeth))
+            unfilter_pixels<3>(filter, src, prior, dst, length);
+        else
+            scalar::unfilter_row(filter, src, prior, dst, length, bytes_per_pixel);
+    }
+#else
+    void unfilter_row(row_filter filter, const unsigned char* src, const unsigned char* prior, unsigned char* dst,
+                      size_t length, int bytes_per_pixel)
+    {
+        scalar::unfilter_row(filter, src, prior, dst, length, bytes_per_pixel);
+    }
+#endif
+
+
+    /// --- DECODE ---
+    static constexpr unsigned char signature[8] = { 137, 'P', 'N', 'G', 13, 10, 26, 10 };
+
+    static std::uint32_t read32(const unsigned char* p) { return (std::uint32_t) p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]; }
+    static std::uint16_t read16(const unsigned char* p) { return (std::uint16_t) (p[0] << 8 | p[1]); }
+
+    static constexpr std::uint32_t chunk_type(const char (&name)[5])
+    {
+        return (std::uint32_t) name[0] << 24 | (std::uint32_t) name[1] << 16 | (std::uint32_t) name[2] << 8 | (std::uint32_t) name[3];
+    }
+
+    bool is_png(const unsigned char* data, size_t size)
+    {
+        return size >= sizeof(signature) && std::memcmp(data, signature, sizeof(signature)) == 0;
+    }
+
+    bool decode(const unsigned char* data, size_t size, image& out)
+    {
+        if (!is_png(data, size))
+            return false;
+
+        // -- chunks. Rejects what stbi_load rejects, and what it accepts but this decoder leaves to it
+        std::uint32_t width = 0, height = 0;
+        int depth = 0, color = 0;
+        bool has_header = false;
+        unsigned char palette[256 * 4];
+        size_t palette_size = 0;
+        bool palette_alpha = false;
+        bool has_key = false;
+        std::uint16_t key[3] = {};
+        std::vector<std::pair<const unsigned char*, size_t>> idat;
+        size_t idat_size = 0;
+
+        for (size_t pos = sizeof(signature);;)
+        {
+            if (size - pos < 12)
+                return false;
+            const std::uint32_t length = read32(data + pos);
+            const std::uint32_t type = read32(data + pos + 4);
+            const unsigned char* chunk = data + pos + 8;
+            if (length > size - pos - 12)
+                return false;
+            pos += 12 + length;
+            if (!has_header && type != chunk_type("IHDR"))
+                return false;
+
+            if (type == chunk_type("IHDR"))
+            {
+                if (has_header || length != 13)
+                    return false;
+                has_header = true;
+                width = read32(chunk);
+                height = read32(chunk + 4);
+                depth = chunk[8];
+                color = chunk[9];
+                // compression and filter methods, interlacing
+                if (chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0)
+                    return false;
+                if (width == 0 || height == 0 || width > (1 << 24) || height > (1 << 24))
+                    return false;
+                const bool valid = color == 0 ? depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16
+                                 : color == 3 ? depth == 1 || depth == 2 || depth == 4 || depth == 8
+                                 : (color == 2 || color == 4 || color == 6) && (depth == 8 || depth == 16);
+                if (!valid)
+                    return false;
+                const std::uint32_t max_channels = color == 3 ? 4 : (color & 2 ? 3 : 1) + (color & 4 ? 1 : 0);
+                if ((1u << 30) / width / max_channels < height)
+                    return false;
+            }
+            else if (type == chunk_type("PLTE"))
+            {
+                if (length > 256 * 3 || length % 3 != 0)
+                    return false;
+                palette_size = length / 3;
+                for (size_t i = 0; i < palette_size; i++)
+                {
+                    std::memcpy(palette + i * 4, chunk + i * 3, 3);
+                    palette[i * 4 + 3] = 255;
+                }
+            }
+            else if (type == chunk_type("tRNS"))
+            {
+                if (!idat.empty())
+                    return false;
+                if (color == 3)
+                {
+                    if (palette_size == 0 || length > palette_size)
+                        return false;
+                    palette_alpha = true;
+                    for (size_t i = 0; i < length; i++)
+                        palette[i * 4 + 3] = chunk[i];
+                }
+                else
+                {
+                    const int samples = color == 2 ? 3 : 1;
+                    if ((color & 4) || length != (std::uint32_t) samples * 2)
+                        return false;
+                    has_key = true;
+                    for (int k = 0; k < samples; k++)
+                        key[k] = read16(chunk + k * 2);
+                }
+            }
+            else if (type == chunk_type("IDAT"))
+            {
+                if (color == 3 && palette_size == 0)
+                    return false;
+                idat.emplace_back(chunk, length);
+                idat_size += length;
+            }
+            else if (type == chunk_type("IEND"))
+                break;
+            // CgBI (iPhone PNGs) and unknown critical chunks (uppercase first letter)
+            else if (type == chunk_type("CgBI") || !(type & (1u << 29)))
+                return false;
+        }
+        if (idat.empty())
+            return false;
+
+        // -- inflate. The IDAT chunks are one zlib stream
+        const int samples = color == 3 ? 1 : (color & 2 ? 3 : 1) + (color & 4 ? 1 : 0);
+        const int bytes_per_pixel = std::max(samples * depth / 8, 1);
+        const size_t row_size = ((size_t) width * samples * depth + 7) / 8;
+        const size_t filtered_size = (row_size + 1) * height;
+        std::unique_ptr<unsigned char[]> stream;
+        const unsigned char* zlib = idat[0].first;
+        if (idat.size() > 1)
+        {
+            stream = std::make_unique_for_overwrite<unsigned char[]>(idat_size);
+            size_t offset = 0;
+            for (const auto& [chunk, length] : idat)
+            {
+                std::memcpy(stream.get() + offset, chunk, length);
+                offset += length;
+            }
+            zlib = stream.get();
+        }
+        const auto filtered = std::make_unique_for_overwrite<unsigned char[]>(filtered_size);
+        if (!inflate(zlib, idat_size, filtered.get(), filtered_size))
+            return false;
+        stream.reset();
+
+        out.width = (int) width;
+        out.height = (int) height;
+        out.channels = color == 3 ? (palette_alpha ? 4 : 3) : samples + (has_key ? 1 : 0);
+        out.pixels.resize((size_t) width * height * out.channels);
+
+        // -- unfilter. 8 bit images without tRNS go straight to the output, the others through raw
+        const bool direct = depth == 8 && color != 3 && !has_key;
+        std::unique_ptr<unsigned char[]> raw;
+        if (!direct)
+            raw = std::make_unique_for_overwrite<unsigned char[]>(row_size * height);
+        unsigned char* const rows = direct ? out.pixels.data() : raw.get();
+        const std::vector<unsigned char> zeros(row_size, 0);
+        for (std::uint32_t y = 0; y < height; y++)
+        {
+            const unsigned char* src = filtered.get() + y * (row_size + 1);
+            if (src[0] > 4)
+                return false;
+            unsigned char* dst = rows + y * row_size;
+            unfilter_row((row_filter) src[0], src + 1, y == 0 ? zeros.data() : dst - row_size, dst, row_size, bytes_per_pixel);
+        }
+        if (direct)
+            return true;
+
+        // -- convert to 8 bit samples, expand palettes, tRNS to alpha
+        static constexpr unsigned char depth_scale[9] = { 0, 0xff, 0x55, 0, 0x11, 0, 0, 0, 0x01 };
+        std::vector<unsigned char> unpacked(depth < 8 ? (size_t) width : 0);
+        for (std::uint32_t y = 0; y < height; y++)
+        {
+            const unsigned char* row = raw.get() + y * row_size;
+            unsigned char* dst = out.pixels.data() + (size_t) y * width * out.channels;
+            if (depth == 16)
+            {
+                for (std::uint32_t x = 0; x < width; x++, row += samples * 2)
+                {
+                    bool transparent = has_key;
+                    for (int k = 0; k < samples; k++)
+                    {
+                        *dst++ = row[k * 2];
+                        transparent = transparent && read16(row + k * 2) == key[k];
+                    }
+                    if (has_key)
+                        *dst++ = transparent ? 0 : 255;
+                }
+                continue;
+            }
+
+            if (depth < 8)
+            {
+                // grey is scaled to 0-255, palette indices aren't
+                const int scale = color == 0 ? depth_scale[depth] : 1;
+                const int mask = (1 << depth) - 1;
+                for (std::uint32_t x = 0; x < width; x++)
+                {
+                    const size_t bit = (size_t) x * depth;
+                    unpacked[x] = (unsigned char) (scale * ((row[bit / 8] >> (8 - depth - bit % 8)) & mask));
+                }
+                row = unpacked.data();
+            }
+
+            if (color == 3)
+                for (std::uint32_t x = 0; x < width; x++, dst += out.channels)
+                {
+                    if (row[x] >= palette_size)
+                        return false;
+                    std::memcpy(dst, palette + row[x] * 4, out.channels);
+                }
+            else if (has_key)
+            {
+                // stbi compares the low byte of the key, scaled like the samples
+                unsigned char key8[3];
+                for (int k = 0; k < samples; k++)
+                    key8[k] = (unsigned char) ((key[k] & 255) * depth_scale[depth]);
+                for (std::uint32_t x = 0; x < width; x++, row += samples)
+                {
+                    bool transparent = true;
+                    for (int k = 0; k < samples; k++)
+                    {
+                        *dst++ = row[k];
+                        transparent = transparent && row[k] == key8[k];
+                    }
+                    *dst++ = transparent ? 0 : 255;
+                }
+            }
+            else
+                std::memcpy(dst, row, width);
+        }
+        return true;
+    }
+}
@@ -1,5 +1,52 @@
+#include <cmath>
+#include <cstddef>
 #include "primitive.h"
 
 namespace primitive
 {
-}
\ No newline at end of file
+    shape_instance shape_instance::at(float x, float y, float scale, float angle)
+    {
+        const float c = std::cos(angle) * scale, s = std::sin(angle) * scale;
+        shape_instance result;
+        result.transform[0] = c; result.transform[1] = -s; result.transform[2] = x;
+        result.transform[3] = s; result.transform[4] =  c; result.transform[5] = y;
+        return result;
+    }
+
+    shape_instance& shape_instance::with_region(const atlas_region& region)
+    {
+        this->uv_rect[0] = region.u_min;
+        this->uv_rect[1] = region.v_min;
+        this->uv_rect[2] = region.u_max;
+        this->uv_rect[3] = region.v_max;
+        return *this;
+    }
+
+    shape_instance& shape_instance::with_color(vec4<float> rgba)
+    {
+        this->color[0] = rgba.x;
+        this->color[1] = rgba.y;
+        this->color[2] = rgba.z;
+        this->color[3] = rgba.w;
+        return *this;
+    }
+
+    void shape_instance::enable_attributes()
+    {
+        constexpr auto stride = (GLsizei) sizeof(shape_instance);
+        // location, floats, offset: the two rows of the transform, then color and uv_rect
+        constexpr struct { GLuint location; GLint size; size_t offset; } attributes[] = {
+            { 4, 3, offsetof(shape_instance, transform) },
+            { 5, 3, offsetof(shape_instance, transform) + 3 * sizeof(float) },
+            { 6, 4, offsetof(shape_instance, color) },
+            { 7, 4, offsetof(shape_instance, uv_rect) },
+        };
+        for (const auto& a : attributes)
+        {
+            glVertexAttribPointer(a.location, a.size, GL_FLOAT, GL_FALSE, stride, (void*) a.offset);
+            glEnableVertexAttribArray(a.location);
+            // advance once per instance instead of once per vertex
+            glVertexAttribDivisor(a.location, 1);
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "program-cache.h"
+#include "gl-trace.h"
+
+// from GL 4.1 / ARB_get_program_binary (glad is generated for 3.3)
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH           0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS      0x87FE
+#endif
+
+namespace program_cache
+{
+    typedef void (APIENTRYP get_program_binary_proc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+    typedef void (APIENTRYP program_binary_proc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+    typedef void (APIENTRYP program_parameteri_proc)(GLuint program, GLenum pname, GLint value);
+
+    static get_program_binary_proc get_program_binary = nullptr;
+    static program_binary_proc     program_binary     = nullptr;
+    static program_parameteri_proc program_parameteri = nullptr;
+
+    static bool is_enabled = false;
+    static std::filesystem::path cache_dir;
+    //! @brief Vendor, renderer and version, part of every key
+    static std::string driver;
+    static stats cache_stats;
+
+    static constexpr char magic[4] = { 'G', 'L', 'P', 'B' };
+
+
+    bool init(GLADloadproc load, const char* directory)
+    {
+        get_program_binary = (get_program_binary_proc) load("glGetProgramBinary");
+        program_binary     = (program_binary_proc)     load("glProgramBinary");
+        program_parameteri = (program_parameteri_proc) load("glProgramParameteri");
+
+        GLint formats = 0;
+        if (get_program_binary && program_binary && program_parameteri)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (formats <= 0)
+        {
+            std::cerr << "Shader program cache disabled: the driver can't save program binaries\n";
+            is_enabled = false;
+            return false;
+        }
+
+        std::error_code error;
+        cache_dir = directory;
+        std::filesystem::create_directories(cache_dir, error);
+        if (error)
+        {
+            std::cerr << "Shader program cache disabled: could not create \"" << directory << "\": " << error.message() << '\n';
+            is_enabled = false;
+            return false;
+        }
+
+        driver.clear();
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+            if (const auto str = (const char*) glGetString(name))
+                driver.append(str).push_back('\n');
+        is_enabled = true;
+        return true;
+    }
+
+    bool enabled()
+    {
+        // calls made by glProgramBinary can't be replayed, so compile from source while capturing
+        return is_enabled && !gl_trace::capturing();
+    }
+
+
+    //! @brief FNV-1a
+    static std::uint64_t hash(std::uint64_t h, std::string_view data)
+    {
+        for (const char c : data)
+        {
+            h ^= (unsigned char) c;
+            h *= 0x100000001B3;
+        }
+        return h;
+    }
+
+    std::uint64_t key(std::initializer_list<std::string_view> sources, std::string_view defines)
+    {
+        std::uint64_t h = 0xCBF29CE484222325;
+        for (const std::string_view source : sources)
+            // separator, so moving text from the end of one stage to the start of the next changes the key
+            h = hash(hash(h, source), std::string_view{ "\0", 1 });
+        h = hash(hash(h, defines), std::string_view{ "\0", 1 });
+        return hash(h, driver);
+    }
+
+    static std::filesystem::path path_of(std::uint64_t key)
+    {
+        char name[16 + 5];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long) key);
+        return cache_dir / name;
+    }
+
+
+    /// File: "GLPB", u32 binary format, then the binary
+    bool load(GLuint program, std::uint64_t key)
+    {
+        if (!enabled())
+            return false;
+        const std::filesystem::path path = path_of(key);
+        std::ifstream file{ path, std::ios::binary | std::ios::ate };
+        if (!file)
+            return false;
+
+        const auto size = (size_t) file.tellg();
+        if (size <= sizeof(magic) + sizeof(GLenum))
+            return false;
+        std::vector<char> data(size);
+        file.seekg(0);
+        file.read(data.data(), (std::streamsize) size);
+        file.close();
+
+        GLenum format;
+        std::memcpy(&format, data.data() + sizeof(magic), sizeof(GLenum));
+        const size_t header = sizeof(magic) + sizeof(GLenum);
+        GLint linked = GL_FALSE;
+        if (std::memcmp(data.data(), magic, sizeof(magic)) == 0)
+        {
+            program_binary(program, format, data.data() + header, (GLsizei) (size - header));
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        }
+        if (!linked)
+        {
+            // e.g. the driver changed in a way the key doesn't see. It will be compiled and stored again
+            cache_stats.stale++;
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            return false;
+        }
+        return true;
+    }
+
+    void prepare(GLuint program)
+    {
+        if (enabled())
+            program_parameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    void store(GLuint program, std::uint64_t key)
+    {
+        if (!enabled())
+            return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        get_program_binary(program, length, &length, &format, binary.data());
+
+        // write to another file first, so a crash can't leave a half-written binary behind
+        const std::filesystem::path path = path_of(key);
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+        {
+            std::ofstream file{ temp, std::ios::binary | std::ios::trunc };
+            if (!file)
+                return;
+            file.write(magic, sizeof(magic));
+            file.write((const char*) &format, sizeof(format));
+            file.write(binary.data(), length);
+        }
+        std::error_code error;
+        std::filesystem::rename(temp, path, error);
+    }
+
+
+    void count(bool hit, double ms)
+    {
+        if (hit)
+        {
+            cache_stats.hits++;
+            cache_stats.hit_ms += ms;
+        }
+        else
+        {
+            cache_stats.misses++;
+            cache_stats.miss_ms += ms;
+        }
+    }
+
+    const stats& counters() { return cache_stats; }
+}
+
+
+std::ostream& operator<<(std::ostream& os, const program_cache::stats& stats)
+{
+    os << "shader programs: " << stats.hits << " from cache (" << stats.hit_ms << " ms), "
+       << stats.misses << " compiled (" << stats.miss_ms << " ms)";
+    if (stats.stale)
+        os << ", " << stats.stale << " stale";
+    return os << '\n';
+}
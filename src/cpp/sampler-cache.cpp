@@ -0,0 +1,68 @@
+#include "sampler-cache.h"
+#include "gl-state.h"
+
+SamplerCache::~SamplerCache() { this->clear(); }
+
+SamplerCache::SamplerCache(SamplerCache&& other) noexcept
+    : samplers(std::move(other.samplers)), _counters(other._counters)
+{
+    other.samplers.clear();
+}
+
+SamplerCache& SamplerCache::operator=(SamplerCache&& other) noexcept
+{
+    if (this != &other)
+    {
+        this->clear();
+        this->samplers = std::move(other.samplers);
+        this->_counters = other._counters;
+        other.samplers.clear();
+    }
+    return *this;
+}
+
+void SamplerCache::clear()
+{
+    for (const auto& [state, sampler] : this->samplers)
+        gl_state::delete_samplers(1, &sampler);
+    this->samplers.clear();
+}
+
+GLuint SamplerCache::get(const sampler_state& requested)
+{
+    // the border color makes no difference without GL_CLAMP_TO_BORDER, so states that only differ by it share a sampler
+    sampler_state state = requested;
+    if (!state.uses_border())
+        state.border_color = sampler_state{}.border_color;
+
+    for (const auto& [existing, sampler] : this->samplers)
+        if (existing == state)
+        {
+            this->_counters.hits++;
+            return sampler;
+        }
+
+    GLuint sampler;
+    glGenSamplers(1, &sampler);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, state.wrap_s);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, state.wrap_t);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, state.wrap_r);
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, state.min_filter);
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, state.mag_filter);
+    if (state.uses_border())
+        glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, state.border_color.data());
+
+    this->samplers.emplace_back(state, sampler);
+    this->_counters.created++;
+    return sampler;
+}
+
+void SamplerCache::bind(GLuint unit, const sampler_state& state) { gl_state::bind_sampler(unit, this->get(state)); }
+
+void SamplerCache::unbind(GLuint unit) { gl_state::bind_sampler(unit, 0); }
+
+
+std::ostream& operator<<(std::ostream& os, const SamplerCache::stats& stats)
+{
+    return os << "samplers: " << stats.created << " created, " << stats.hits << " reused\n";
+}
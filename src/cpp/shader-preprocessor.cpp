@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "shader-preprocessor.h"
+
+namespace glsl
+{
+    static std::string read_source(const std::filesystem::path& path, const std::string& included_from)
+    {
+        std::ifstream file{ path };
+        if (!file)
+        {
+            std::string error_str = "Could not read shader \"" + path.string() + "\"";
+            if (!included_from.empty())
+                error_str += " (included from \"" + included_from + "\")";
+            std::cerr << error_str << '\n';
+            throw std::invalid_argument{error_str};
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+
+    //! @brief The file name of an #include line, or an empty view if @param line is not an #include
+    static std::string_view include_of(std::string_view line)
+    {
+        const auto skip_space = [&line]() {
+            while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+                line.remove_prefix(1);
+        };
+        skip_space();
+        if (!line.starts_with('#'))
+            return {  };
+        line.remove_prefix(1);
+        skip_space();
+        if (!line.starts_with("include"))
+            return {  };
+        line.remove_prefix(7);
+        skip_space();
+        if (line.empty() || (line.front() != '"' && line.front() != '<'))
+            return {  };
+        const char close = line.front() == '"' ? '"' : '>';
+        line.remove_prefix(1);
+        const size_t end = line.find(close);
+        return end == std::string_view::npos ? std::string_view{  } : line.substr(0, end);
+    }
+
+    /*! @brief #line directive for a file that continues at @param line.
+     *         GLSL 3.30 numbers the line after "#line n" as n + 1 (later versions changed it to n, like C) */
+    static std::string line_directive(size_t line, size_t file)
+    {
+        return "#line " + std::to_string(line - 1) + ' ' + std::to_string(file) + '\n';
+    }
+
+    static void append_file(source& result, const std::filesystem::path& path, const std::string& included_from)
+    {
+        const std::string name = path.lexically_normal().string();
+        // every file is included once
+        if (std::find(result.files.begin(), result.files.end(), name) != result.files.end())
+            return;
+        const size_t index = result.files.size();
+        result.files.push_back(name);
+        const std::string text = read_source(path, included_from);
+
+        size_t line_number = 1;
+        for (size_t pos = 0; pos < text.size(); line_number++)
+        {
+            size_t end = text.find('\n', pos);
+            if (end == std::string::npos)
+                end = text.size();
+            const std::string_view line{ text.data() + pos, end - pos };
+            pos = end + 1;
+
+            const std::string_view include = include_of(line);
+            if (include.empty())
+            {
+                result.code.append(line).push_back('\n');
+                const size_t first = line.find_first_not_of(" \t");
+                if (index == 0 && result.defines_at == 0 && first != std::string_view::npos && line.substr(first).starts_with("#version"))
+                {
+                    result.defines_at = result.code.size();
+                    result.line_after_version = line_number + 1;
+                }
+                continue;
+            }
+
+            const size_t files_before = result.files.size();
+            const size_t code_before  = result.code.size();
+            result.code += line_directive(1, files_before);
+            append_file(result, path.parent_path() / include, name);
+            if (result.files.size() == files_before)
+                // already included: undo the #line
+                result.code.resize(code_before);
+            else
+                result.code += line_directive(line_number + 1, index);
+        }
+    }
+
+    source preprocess(const char* path)
+    {
+        source result;
+        append_file(result, path, "");
+        return result;
+    }
+
+    std::string source::with_defines(std::string_view defines) const
+    {
+        if (defines.empty())
+            return this->code;
+        std::string result;
+        result.reserve(this->code.size() + defines.size() + 16);
+        result.append(this->code, 0, this->defines_at);
+        result.append(defines);
+        if (!defines.ends_with('\n'))
+            result.push_back('\n');
+        result += line_directive(this->line_after_version, 0);
+        result.append(this->code, this->defines_at);
+        return result;
+    }
+}
@@ -1,8 +1,21 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include "shader-program.h"
+#include "program-cache.h"
 using std::string;
 
 
+// from KHR_parallel_shader_compile (glad is generated for 3.3 without extensions)
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+
 ShaderProgram::ShaderProgram(const char* vert_shader_path, const char* frag_shader_path)
+    : ShaderProgram(vert_shader_path, frag_shader_path, compile::now) {  }
+
+ShaderProgram::ShaderProgram(const char* vert_shader_path, const char* frag_shader_path, compile when)
 {
     /// --- VERTEX SHADER ---
     string vert_shader_src;
@@ -17,15 +30,6 @@ ShaderProgram::ShaderProgram(const char* vert_shader_path, const char* frag_shad
     else // copy file content to string stream
        vert_shader_src = read_file(vert_shader_path);
 
-    // compile vertex shader
-    const char* vs_code = vert_shader_src.c_str(); // needs to be l-value
-    unsigned int vert_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vert_shader, 1, &vs_code, nullptr);
-    glCompileShader(vert_shader);
-    checkShaderCompileErrors(vert_shader, "VERTEX"); // check for errors when compiling shader
-
-
-
     /// --- FRAGMENT SHADER ---
     string frag_shader_src;
     // if no fragment shader was provided, use default
@@ -38,29 +42,148 @@ ShaderProgram::ShaderProgram(const char* vert_shader_path, const char* frag_shad
     else // copy file content to string stream
         frag_shader_src = read_file(frag_shader_path);
 
-    // compile fragment shader
-    const char* fs = frag_shader_src.c_str();
-    unsigned int frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(frag_shader, 1, &fs, nullptr);
-    glCompileShader(frag_shader);
-    checkShaderCompileErrors(frag_shader, "FRAGMENT"); // check for errors when compiling shader
+    this->create(vert_shader_src, frag_shader_src, "", when);
+}
 
+ShaderProgram::ShaderProgram(const glsl::source& vert_shader, const glsl::source& frag_shader, std::string_view defines, compile when)
+{
+    this->create(vert_shader.with_defines(defines), frag_shader.with_defines(defines), defines, when);
+}
 
+void ShaderProgram::create(const string& vert_shader_src, const string& frag_shader_src, std::string_view defines, compile when)
+{
+    const auto start = std::chrono::steady_clock::now();
 
     // --- SHADER PROGRAM ---
     this->gl_program = glCreateProgram();
-    glAttachShader(this->gl_program, vert_shader);
-    glAttachShader(this->gl_program, frag_shader);
-    glLinkProgram(this->gl_program);
-    checkProgramCompileErrors(); // check for errors when attaching shaders
+    Submitted submit{ 0, 0, program_cache::key({ vert_shader_src, frag_shader_src }, defines), 0 };
+    // the cache is only used if program_cache::init() was called (see program-cache.h)
+    if (!program_cache::load(this->gl_program, submit.cache_key))
+    {
+        // compile vertex shader. Errors are checked in finish(), so the compile doesn't have to be waited for here
+        const char* vs_code = vert_shader_src.c_str(); // needs to be l-value
+        submit.vert_shader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(submit.vert_shader, 1, &vs_code, nullptr);
+        glCompileShader(submit.vert_shader);
+
+        // compile fragment shader
+        const char* fs = frag_shader_src.c_str();
+        submit.frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(submit.frag_shader, 1, &fs, nullptr);
+        glCompileShader(submit.frag_shader);
+
+        glAttachShader(this->gl_program, submit.vert_shader);
+        glAttachShader(this->gl_program, submit.frag_shader);
+        program_cache::prepare(this->gl_program);
+        glLinkProgram(this->gl_program);
+    }
+
+    submit.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    this->submitted = submit;
+    // a cached program is already linked, so there is nothing to wait for
+    if (when == compile::now || submit.vert_shader == 0)
+        this->finish();
+}
+
+ShaderProgram::~ShaderProgram()
+{
+    if (in_use == this)
+        in_use = nullptr;
+    // finish() deletes the shaders of a program that stopped being pending
+    if (this->submitted && this->submitted->vert_shader != 0)
+    {
+        glDeleteShader(this->submitted->vert_shader);
+        glDeleteShader(this->submitted->frag_shader);
+    }
+    if (this->gl_program != 0)
+        gl_state::delete_program(this->gl_program);
+}
+
+
+/// --- DEFERRED COMPILATION ---
+bool ShaderProgram::enable_parallel_compile(GLADloadproc load)
+{
+    typedef void (APIENTRYP max_threads_proc)(GLuint count);
+    const char* function = nullptr;
+
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count && !function; i++)
+    {
+        const auto name = (const char*) glGetStringi(GL_EXTENSIONS, i);
+        if (!name)
+            continue;
+        if (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+            function = "glMaxShaderCompilerThreadsKHR";
+        else if (std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0)
+            function = "glMaxShaderCompilerThreadsARB";
+    }
+    has_parallel_compile = function != nullptr;
+
+    // let the driver use as many threads as it wants
+    if (const auto max_threads = function ? (max_threads_proc) load(function) : nullptr)
+        max_threads(0xFFFFFFFF);
+    return has_parallel_compile;
+}
+
+bool ShaderProgram::parallel_compile() { return has_parallel_compile; }
+
+bool ShaderProgram::ready() const
+{
+    if (!this->submitted)
+        return true;
+    if (!has_parallel_compile)
+        return false;
+    int done = GL_FALSE;
+    glGetProgramiv(this->gl_program, GL_COMPLETION_STATUS_KHR, &done);
+    return done;
+}
+
+void ShaderProgram::finish()
+{
+    if (!this->submitted)
+        return;
+    const auto start = std::chrono::steady_clock::now();
+    const Submitted submit = *this->submitted;
+    this->submitted.reset();
+
+    const bool cached = submit.vert_shader == 0;
+    if (!cached)
+    {
+        checkShaderCompileErrors(submit.vert_shader, "VERTEX"); // check for errors when compiling shader
+        checkShaderCompileErrors(submit.frag_shader, "FRAGMENT");
+        checkProgramCompileErrors(); // check for errors when attaching shaders
+
+        // these are already compiled and used by this->program, so they have no use now
+        glDeleteShader(submit.vert_shader);
+        glDeleteShader(submit.frag_shader);
+
+        int linked;
+        glGetProgramiv(this->gl_program, GL_LINK_STATUS, &linked);
+        if (linked)
+            program_cache::store(this->gl_program, submit.cache_key);
+    }
+    this->reflect_uniforms();
 
-    // these are already compiled and used by this->program, so they have no use now
-    glDeleteShader(vert_shader);
-    glDeleteShader(frag_shader);
+    program_cache::count(cached, submit.ms + std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 }
 
-void ShaderProgram::use()  const { glUseProgram(this->gl_program); }
-void ShaderProgram::bind() const { glUseProgram(this->gl_program); }
+
+void ShaderProgram::use()
+{
+    this->finish();
+    gl_state::use_program(this->gl_program);
+    in_use = this;
+    if (!this->dirty.empty())
+        this->flush_uniforms();
+}
+void ShaderProgram::bind() { this->use(); }
+
+void ShaderProgram::flush_in_use()
+{
+    if (in_use && !in_use->dirty.empty())
+        in_use->flush_uniforms();
+}
 
 
 // void ShaderProgram::get_uniform(const char *uniform)
@@ -69,27 +192,234 @@ void ShaderProgram::bind() const { glUseProgram(this->gl_program); }
 // }
 
 
-void ShaderProgram::set_uniform(const char* uniform, vec4<float> val) const
+/// --- UNIFORMS ---
+//! @brief The base type ('f', 'i' or 'u') and number of values of a uniform of GL type @param type
+static std::pair<char, unsigned int> uniform_type_info(unsigned int type)
+{
+    switch (type)
+    {
+        case GL_FLOAT:             return { 'f', 1 };
+        case GL_FLOAT_VEC2:        return { 'f', 2 };
+        case GL_FLOAT_VEC3:        return { 'f', 3 };
+        case GL_FLOAT_VEC4:        return { 'f', 4 };
+        case GL_FLOAT_MAT2:        return { 'f', 4 };
+        case GL_FLOAT_MAT3:        return { 'f', 9 };
+        case GL_FLOAT_MAT4:        return { 'f', 16 };
+        case GL_INT:
+        case GL_BOOL:              return { 'i', 1 };
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2:         return { 'i', 2 };
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3:         return { 'i', 3 };
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4:         return { 'i', 4 };
+        case GL_UNSIGNED_INT:      return { 'u', 1 };
+        case GL_UNSIGNED_INT_VEC2: return { 'u', 2 };
+        case GL_UNSIGNED_INT_VEC3: return { 'u', 3 };
+        case GL_UNSIGNED_INT_VEC4: return { 'u', 4 };
+        // non-square matrices can't be set
+        case GL_FLOAT_MAT2x3:
+        case GL_FLOAT_MAT2x4:
+        case GL_FLOAT_MAT3x2:
+        case GL_FLOAT_MAT3x4:
+        case GL_FLOAT_MAT4x2:
+        case GL_FLOAT_MAT4x3:      return { 'f', 0 };
+        // the rest are samplers, which are set with the texture unit
+        default:                   return { 'i', 1 };
+    }
+}
+
+void ShaderProgram::reflect_uniforms()
+{
+    int count = 0;
+    int max_length = 0;
+    glGetProgramiv(this->gl_program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->gl_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+    string name_buffer(std::max(max_length, 1), '\0');
+
+    for (int i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint array_size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(this->gl_program, i, (GLsizei) name_buffer.size(), &length, &array_size, &type, name_buffer.data());
+        string name{ name_buffer.data(), (size_t) length };
+
+        // uniforms in uniform blocks don't have a location
+        const int location = glGetUniformLocation(this->gl_program, name.c_str());
+        if (location < 0)
+            continue;
+        // arrays are reported as "name[0]"
+        if (name.ends_with("[0]"))
+            name.resize(name.size() - 3);
+
+        const auto [base, components] = uniform_type_info(type);
+        const auto offset = (unsigned int) this->shadow.size();
+        this->shadow.resize(offset + components * array_size, 0);
+        // uniforms declared with an initializer (uniform float scale = 1.0;) don't start at 0, so the shadow starts
+        // with what the linked program has. Otherwise setting one to 0 would match the shadow and never reach GL
+        if (components > 0)
+            for (int e = 0; e < array_size; e++)
+            {
+                const int element_location = e == 0 ? location
+                                           : glGetUniformLocation(this->gl_program, (name + "[" + std::to_string(e) + "]").c_str());
+                if (element_location >= 0)
+                    this->read_uniform(element_location, base, components, this->shadow.data() + offset + e * components);
+            }
+
+        this->uniform_index.emplace(name, (unsigned int) this->uniforms.size());
+        this->uniforms.push_back({ std::move(name), location, type, base, components, array_size, offset });
+    }
+    this->is_dirty.assign(this->uniforms.size(), false);
+}
+
+void ShaderProgram::read_uniform(int location, char base, unsigned int components, std::uint32_t* out) const
+{
+    // GL writes the whole element, which is at most a mat4
+    switch (base)
+    {
+        case 'f':
+        {
+            GLfloat values[16]{};
+            glGetUniformfv(this->gl_program, location, values);
+            std::memcpy(out, values, components * sizeof(std::uint32_t));
+            break;
+        }
+        case 'u':
+        {
+            GLuint values[16]{};
+            glGetUniformuiv(this->gl_program, location, values);
+            std::memcpy(out, values, components * sizeof(std::uint32_t));
+            break;
+        }
+        default:
+        {
+            GLint values[16]{};
+            glGetUniformiv(this->gl_program, location, values);
+            std::memcpy(out, values, components * sizeof(std::uint32_t));
+        }
+    }
+}
+
+UniformHandle ShaderProgram::uniform(std::string_view name)
+{
+    this->finish();
+    const auto it = this->uniform_index.find(name);
+    return it == this->uniform_index.end() ? UniformHandle{  } : UniformHandle{ it->second };
+}
+
+void ShaderProgram::write_uniform(UniformHandle uniform, char base, const void* values, unsigned int count)
+{
+    if (!uniform.valid())
+        return;
+    if (uniform.index >= this->uniforms.size())
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: UniformHandle is from another ShaderProgram"};
+
+    const Uniform& u = this->uniforms[uniform.index];
+    if (u.base != base || u.components == 0 || count % u.components != 0 || count > u.components * (unsigned int) u.array_size)
+    {
+        const string error_str = "Cannot set uniform \"" + u.name + "\": the value is not the type the shader declares";
+        std::cerr << error_str << '\n';
+        throw std::invalid_argument{error_str};
+    }
+
+    std::uint32_t* shadow = this->shadow.data() + u.offset;
+    if (std::memcmp(shadow, values, count * sizeof(std::uint32_t)) == 0)
+        return;
+    std::memcpy(shadow, values, count * sizeof(std::uint32_t));
+    if (!this->is_dirty[uniform.index])
+    {
+        this->is_dirty[uniform.index] = true;
+        this->dirty.push_back(uniform.index);
+    }
+}
+
+void ShaderProgram::flush_uniforms() const
+{
+    for (const unsigned int i : this->dirty)
+    {
+        const Uniform& u = this->uniforms[i];
+        const std::uint32_t* values = this->shadow.data() + u.offset;
+        const auto f  = (const GLfloat*) values;
+        const auto in = (const GLint*) values;
+        const auto ui = (const GLuint*) values;
+
+        if (u.type == GL_FLOAT_MAT2)
+            glUniformMatrix2fv(u.location, u.array_size, False, f);
+        else if (u.type == GL_FLOAT_MAT3)
+            glUniformMatrix3fv(u.location, u.array_size, False, f);
+        else if (u.type == GL_FLOAT_MAT4)
+            // mat4 is already column-major, so no need to transpose
+            glUniformMatrix4fv(u.location, u.array_size, False, f);
+        else if (u.base == 'f')
+            switch (u.components)
+            {
+                case 1: glUniform1fv(u.location, u.array_size, f); break;
+                case 2: glUniform2fv(u.location, u.array_size, f); break;
+                case 3: glUniform3fv(u.location, u.array_size, f); break;
+                case 4: glUniform4fv(u.location, u.array_size, f); break;
+            }
+        else if (u.base == 'i')
+            switch (u.components)
+            {
+                case 1: glUniform1iv(u.location, u.array_size, in); break;
+                case 2: glUniform2iv(u.location, u.array_size, in); break;
+                case 3: glUniform3iv(u.location, u.array_size, in); break;
+                case 4: glUniform4iv(u.location, u.array_size, in); break;
+            }
+        else
+            switch (u.components)
+            {
+                case 1: glUniform1uiv(u.location, u.array_size, ui); break;
+                case 2: glUniform2uiv(u.location, u.array_size, ui); break;
+                case 3: glUniform3uiv(u.location, u.array_size, ui); break;
+                case 4: glUniform4uiv(u.location, u.array_size, ui); break;
+            }
+        this->is_dirty[i] = false;
+    }
+    this->dirty.clear();
+}
+
+
+void ShaderProgram::set_uniform(UniformHandle uniform, float val)        { this->write_uniform(uniform, 'f', &val, 1); }
+void ShaderProgram::set_uniform(UniformHandle uniform, int val)          { this->write_uniform(uniform, 'i', &val, 1); }
+void ShaderProgram::set_uniform(UniformHandle uniform, unsigned int val) { this->write_uniform(uniform, 'u', &val, 1); }
+
+void ShaderProgram::set_uniform(UniformHandle uniform, vec2<float> val)
+{
+    const float values[] = { val.x, val.y };
+    this->write_uniform(uniform, 'f', values, 2);
+}
+
+void ShaderProgram::set_uniform(UniformHandle uniform, vec3<float> val)
+{
+    const float values[] = { val.x, val.y, val.z };
+    this->write_uniform(uniform, 'f', values, 3);
+}
+
+void ShaderProgram::set_uniform(UniformHandle uniform, vec4<float> val)
 {
-    // have to use Shader Program before setting the uniform value
-    this->use();
-    glUniform4f(glGetUniformLocation(this->gl_program, uniform), val.x, val.y, val.z, val.w);
+    const float values[] = { val.x, val.y, val.z, val.w };
+    this->write_uniform(uniform, 'f', values, 4);
 }
 
-void ShaderProgram::set_uniform(const char* uniform, float val) const
+void ShaderProgram::set_uniform(UniformHandle uniform, const mat4<float>& val)
 {
-    // have to use Shader Program before setting the uniform value
-    this->use();
-    glUniform1f(glGetUniformLocation(this->gl_program, uniform), val);
+    this->write_uniform(uniform, 'f', val.data(), 16);
 }
 
-void ShaderProgram::set_uniform(const char* uniform, int val) const
+void ShaderProgram::set_uniform(UniformHandle uniform, std::span<const int> values)
 {
-    // have to use Shader Program before setting the uniform value
-    this->use();
-    glUniform1i(glGetUniformLocation(this->gl_program, uniform), val);
+    this->write_uniform(uniform, 'i', values.data(), (unsigned int) values.size());
 }
 
+// -- by name. Prefer getting a handle once with this->uniform() in code that runs every frame
+void ShaderProgram::set_uniform(const char* uniform, vec4<float> val)        { this->set_uniform(this->uniform(uniform), val); }
+void ShaderProgram::set_uniform(const char* uniform, float val)              { this->set_uniform(this->uniform(uniform), val); }
+void ShaderProgram::set_uniform(const char* uniform, int val)                { this->set_uniform(this->uniform(uniform), val); }
+void ShaderProgram::set_uniform(const char* uniform, unsigned int val)       { this->set_uniform(this->uniform(uniform), val); }
+void ShaderProgram::set_uniform(const char* uniform, const mat4<float>& val) { this->set_uniform(this->uniform(uniform), val); }
+
 
 void ShaderProgram::checkProgramCompileErrors() const
 {
@@ -98,7 +428,7 @@ void ShaderProgram::checkProgramCompileErrors() const
     if (!no_errors)
     {
         char error_info[1024];
-        glGetShaderInfoLog(this->gl_program, 1024, nullptr, error_info);
+        glGetProgramInfoLog(this->gl_program, 1024, nullptr, error_info);
         std::cerr << "Link Error: Failed to link Shader Program:\n"
                   << error_info << std::endl;
     }
@@ -117,3 +447,28 @@ void ShaderProgram::checkShaderCompileErrors(unsigned int shader, const char* sh
                   << error_info << std::endl;
     }
 }
+
+
+/// --- BATCH ---
+ShaderProgram& ShaderBatch::add(const char* vert_shader_path, const char* frag_shader_path)
+{
+    return this->programs.emplace_back(vert_shader_path, frag_shader_path, ShaderProgram::compile::deferred);
+}
+
+size_t ShaderBatch::poll()
+{
+    size_t pending = 0;
+    for (ShaderProgram& program : this->programs)
+    {
+        if (program.pending() && program.ready())
+            program.finish();
+        pending += program.pending();
+    }
+    return pending;
+}
+
+void ShaderBatch::finish()
+{
+    for (ShaderProgram& program : this->programs)
+        program.finish();
+}
@@ -0,0 +1,48 @@
+#include <algorithm>
+#include "shader-variants.h"
+
+ShaderVariants::ShaderVariants(const char* vert_shader_path, const char* frag_shader_path)
+    : vert_shader(glsl::preprocess(vert_shader_path)), frag_shader(glsl::preprocess(frag_shader_path)) {  }
+
+std::string ShaderVariants::defines_of(unsigned int features)
+{
+    std::string defines;
+    for (unsigned int bit = 0; bit < shader_feature::count; bit++)
+        if (features & (1u << bit))
+            defines.append("#define ").append(shader_feature::defines[bit]).push_back('\n');
+    return defines;
+}
+
+ShaderProgram& ShaderVariants::build(unsigned int features, ShaderProgram::compile when)
+{
+    if (features >= this->variants.size())
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: unknown shader_feature bits"};
+    auto& variant = this->variants[features];
+    if (!variant)
+        variant = std::make_unique<ShaderProgram>(this->vert_shader, this->frag_shader, defines_of(features), when);
+    return *variant;
+}
+
+ShaderProgram& ShaderVariants::get(unsigned int features)
+{
+    ShaderProgram& program = this->build(features, ShaderProgram::compile::now);
+    program.finish();
+    return program;
+}
+
+void ShaderVariants::prebuild(std::initializer_list<unsigned int> features)
+{
+    for (const unsigned int f : features)
+        this->build(f, ShaderProgram::compile::deferred);
+}
+
+size_t ShaderVariants::built() const
+{
+    return std::count_if(this->variants.begin(), this->variants.end(), [](const auto& v) { return v != nullptr; });
+}
+
+void ShaderVariants::clear()
+{
+    for (auto& variant : this->variants)
+        variant.reset();
+}
@@ -0,0 +1,194 @@
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include "streaming-texture.h"
+#include "pixel-ops.h"
+
+using clock_type = std::chrono::steady_clock;
+
+static double ms_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+StreamingTexture::StreamingTexture(int width, int height, size_t ring_size)
+    : _width(width), _height(height), buffers(ring_size)
+{
+    if (width <= 0 || height <= 0 || ring_size == 0)
+    {
+        const std::string error_str = "Can't make a " + std::to_string(width) + "x" + std::to_string(height)
+                                    + " streaming texture with " + std::to_string(ring_size) + " buffers";
+        std::cerr << error_str << std::endl;
+        throw std::invalid_argument{error_str};
+    }
+
+    glGenTextures(1, &this->gl_texture);
+    this->bind();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // only level 0, so mipmap filters (e.g. from a sampler) still see a complete texture
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    glGenBuffers((GLsizei) ring_size, this->buffers.data());
+    for (GLuint buffer : this->buffers)
+    {
+        gl_state::bind_buffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr) this->image_bytes(), nullptr, GL_STREAM_DRAW);
+    }
+    // texture uploads from client memory must not see a bound unpack buffer
+    gl_state::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+StreamingTexture::~StreamingTexture() { this->release(); }
+
+StreamingTexture::StreamingTexture(StreamingTexture&& other) noexcept
+    : gl_texture(other.gl_texture), _width(other._width), _height(other._height), buffers(std::move(other.buffers)),
+      next(other.next), mapped(other.mapped), fallback(std::move(other.fallback)), updating(other.updating),
+      current(other.current), finished(other.finished)
+{
+    other.gl_texture = 0;
+    other.buffers.clear();
+    other.mapped = 0;
+    other.updating = false;
+}
+
+StreamingTexture& StreamingTexture::operator=(StreamingTexture&& other) noexcept
+{
+    if (this != &other)
+    {
+        this->release();
+        this->gl_texture = other.gl_texture;
+        this->_width = other._width;
+        this->_height = other._height;
+        this->buffers = std::move(other.buffers);
+        this->next = other.next;
+        this->mapped = other.mapped;
+        this->fallback = std::move(other.fallback);
+        this->updating = other.updating;
+        this->current = other.current;
+        this->finished = other.finished;
+        other.gl_texture = 0;
+        other.buffers.clear();
+        other.mapped = 0;
+        other.updating = false;
+    }
+    return *this;
+}
+
+void StreamingTexture::release()
+{
+    // deleting a mapped buffer unmaps it
+    if (!this->buffers.empty())
+        gl_state::delete_buffers((GLsizei) this->buffers.size(), this->buffers.data());
+    if (this->gl_texture != 0)
+        gl_state::delete_textures(1, &this->gl_texture);
+    this->buffers.clear();
+    this->gl_texture = 0;
+    this->mapped = 0;
+    this->updating = false;
+}
+
+unsigned char* StreamingTexture::begin_update()
+{
+    if (this->updating)
+        this->end_update();
+    const auto start = clock_type::now();
+    this->updating = true;
+
+    const GLuint buffer = this->buffers[this->next];
+    this->next = (this->next + 1) % this->buffers.size();
+    gl_state::bind_buffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    // invalidating the whole buffer lets the driver orphan it instead of waiting for the GPU to finish reading it
+    auto* data = (unsigned char*) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr) this->image_bytes(),
+                                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    gl_state::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (data)
+        this->mapped = buffer;
+    else
+    {
+        this->fallback.resize(this->image_bytes());
+        data = this->fallback.data();
+    }
+
+    this->current.cpu_ms += ms_since(start);
+    return data;
+}
+
+void StreamingTexture::end_update()
+{
+    if (!this->updating)
+        return;
+    const auto start = clock_type::now();
+    this->updating = false;
+
+    bool uploaded = true;
+    this->bind();
+    if (this->mapped != 0)
+    {
+        gl_state::bind_buffer(GL_PIXEL_UNPACK_BUFFER, this->mapped);
+        // the memory can be lost while mapped (e.g. the screen mode changed): then the image is gone
+        if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE)
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, this->_width, this->_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        else
+            uploaded = false;
+        gl_state::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        this->mapped = 0;
+    }
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, this->_width, this->_height, GL_RGBA, GL_UNSIGNED_BYTE, this->fallback.data());
+
+    if (uploaded)
+    {
+        this->current.updates++;
+        this->current.bytes += this->image_bytes();
+    }
+    else
+        this->current.dropped++;
+    this->current.cpu_ms += ms_since(start);
+}
+
+void StreamingTexture::update(const unsigned char* pixels, int num_col_channels)
+{
+    unsigned char* data = this->begin_update();
+    const auto start = clock_type::now();
+    pixel_ops::expand_to_rgba(pixels, data, (size_t) this->_width * this->_height, num_col_channels);
+    this->current.cpu_ms += ms_since(start);
+    this->end_update();
+}
+
+StreamingTexture::stats StreamingTexture::end_frame()
+{
+    const stats result = this->current;
+    this->finished += this->current;
+    this->current = {  };
+    return result;
+}
+
+StreamingTexture::stats StreamingTexture::totals() const
+{
+    stats result = this->finished;
+    result += this->current;
+    return result;
+}
+
+void StreamingTexture::use() const { gl_state::bind_texture(GL_TEXTURE_2D, this->gl_texture); }
+void StreamingTexture::bind() const { gl_state::bind_texture(GL_TEXTURE_2D, this->gl_texture); }
+
+StreamingTexture::stats& StreamingTexture::stats::operator+=(const stats& other)
+{
+    this->updates += other.updates;
+    this->dropped += other.dropped;
+    this->bytes   += other.bytes;
+    this->cpu_ms  += other.cpu_ms;
+    return *this;
+}
+
+
+std::ostream& operator<<(std::ostream& os, const StreamingTexture::stats& stats)
+{
+    return os << "streaming texture: " << stats.updates << " updates (" << stats.bytes / 1024 << " KiB, " << stats.cpu_ms
+              << " ms, " << stats.bytes_per_second() / (1024 * 1024) << " MiB/s), " << stats.dropped << " dropped\n";
+}
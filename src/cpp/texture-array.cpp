@@ -0,0 +1,111 @@
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "texture-array.h"
+#include "pixel-ops.h"
+#include "stb_image.h"
+
+TextureArray::TextureArray(int width, int height, int layers)
+    : _width(width), _height(height), _layers(layers)
+{
+    if (width <= 0 || height <= 0 || layers <= 0)
+    {
+        const std::string error_str = "Can't make a texture array of " + std::to_string(layers) + " images of "
+                                    + std::to_string(width) + "x" + std::to_string(height) + " pixels";
+        std::cerr << error_str << std::endl;
+        throw std::invalid_argument{error_str};
+    }
+
+    glGenTextures(1, &this->gl_texture);
+    this->bind();
+    // the same defaults as Texture::create()
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // every layer at once, so set_layer() only copies into it
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+}
+
+TextureArray::~TextureArray()
+{
+    if (this->gl_texture != 0)
+        gl_state::delete_textures(1, &this->gl_texture);
+}
+
+TextureArray::TextureArray(TextureArray&& other) noexcept
+    : gl_texture(other.gl_texture), _width(other._width), _height(other._height), _layers(other._layers)
+{
+    other.gl_texture = 0;
+}
+
+TextureArray& TextureArray::operator=(TextureArray&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (this->gl_texture != 0)
+            gl_state::delete_textures(1, &this->gl_texture);
+        this->gl_texture = other.gl_texture;
+        this->_width = other._width;
+        this->_height = other._height;
+        this->_layers = other._layers;
+        other.gl_texture = 0;
+    }
+    return *this;
+}
+
+void TextureArray::set_layer(int layer, int num_col_channels, const unsigned char* data)
+{
+    if (layer < 0 || layer >= this->_layers)
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: Texture array layer out of range"};
+
+    // every layer is RGBA, and GL would read grey as red
+    std::vector<unsigned char> rgba;
+    if (num_col_channels != 4)
+    {
+        rgba.resize((size_t) this->_width * this->_height * 4);
+        pixel_ops::expand_to_rgba(data, rgba.data(), (size_t) this->_width * this->_height, num_col_channels);
+        data = rgba.data();
+    }
+
+    this->bind();
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, this->_width, this->_height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+}
+
+void TextureArray::set_layer(int layer, const char* filename)
+{
+    int width, height, num_col_channels;
+    const std::unique_ptr<unsigned char, void(*)(void*)> data{ stbi_load(filename, &width, &height, &num_col_channels, 0), stbi_image_free };
+    if (!data)
+    {
+        std::cerr << "Error loading texture at path \"" << filename << "\"" << std::endl;
+        return;
+    }
+    if (width != this->_width || height != this->_height)
+    {
+        const std::string error_str = "Can't put the " + std::to_string(width) + "x" + std::to_string(height) + " image \""
+                                    + filename + "\" in a texture array of " + std::to_string(this->_width) + "x"
+                                    + std::to_string(this->_height) + " images";
+        std::cerr << error_str << std::endl;
+        throw std::invalid_argument{error_str};
+    }
+    this->set_layer(layer, num_col_channels, data.get());
+}
+
+void TextureArray::generate_mipmaps()
+{
+    this->bind();
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint) pixel_ops::mip_levels(this->_width, this->_height).size() - 1);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+size_t TextureArray::gpu_bytes() const
+{
+    return pixel_ops::mip_chain_size(this->_width, this->_height) * (size_t) this->_layers;
+}
+
+void TextureArray::use() const { gl_state::bind_texture(GL_TEXTURE_2D_ARRAY, this->gl_texture); }
+void TextureArray::bind() const { gl_state::bind_texture(GL_TEXTURE_2D_ARRAY, this->gl_texture); }
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "texture-atlas.h"
+#include "texture-loader.h"
+
+/// --- SKYLINE PACKER ---
+SkylinePacker::SkylinePacker(int width, int height)
+    : skyline{ { 0, 0, width } }, _width(width), _height(height) {  }
+
+int SkylinePacker::fit(size_t i, int width, int height) const
+{
+    if (this->skyline[i].x + width > this->_width)
+        return -1;
+    // the rectangle rests on the highest segment under it
+    int y = 0;
+    for (int left = width; left > 0; i++)
+    {
+        y = std::max(y, this->skyline[i].y);
+        if (y + height > this->_height)
+            return -1;
+        left -= this->skyline[i].width;
+    }
+    return y;
+}
+
+std::optional<std::pair<int, int>> SkylinePacker::insert(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return std::nullopt;
+
+    size_t best = this->skyline.size();
+    int best_y = INT_MAX;
+    for (size_t i = 0; i < this->skyline.size(); i++)
+    {
+        const int y = this->fit(i, width, height);
+        if (y >= 0 && y < best_y)
+        {
+            best = i;
+            best_y = y;
+        }
+    }
+    if (best == this->skyline.size())
+        return std::nullopt;
+
+    // the new top edge, and the segments under it get shorter or go away
+    const int x = this->skyline[best].x;
+    const int right = x + width;
+    this->skyline.insert(this->skyline.begin() + (std::ptrdiff_t) best, { x, best_y + height, width });
+    for (size_t i = best + 1; i < this->skyline.size() && this->skyline[i].x < right;)
+    {
+        const int end = this->skyline[i].x + this->skyline[i].width;
+        if (end <= right)
+            this->skyline.erase(this->skyline.begin() + (std::ptrdiff_t) i);
+        else
+        {
+            this->skyline[i].x = right;
+            this->skyline[i].width = end - right;
+            break;
+        }
+    }
+    for (size_t i = 0; i + 1 < this->skyline.size();)
+        if (this->skyline[i].y == this->skyline[i + 1].y)
+        {
+            this->skyline[i].width += this->skyline[i + 1].width;
+            this->skyline.erase(this->skyline.begin() + (std::ptrdiff_t) i + 1);
+        }
+        else
+            i++;
+
+    this->used_area += (size_t) width * height;
+    return std::pair{ x, best_y };
+}
+
+float SkylinePacker::occupancy() const
+{
+    return (float) ((double) this->used_area / ((double) this->_width * this->_height));
+}
+
+
+/// --- ATLAS ---
+static int round_up(int val, int multiple) { return (val + multiple - 1) / multiple * multiple; }
+
+TextureAtlas::TextureAtlas(atlas_options options)
+    : options(options), block(1 << std::clamp(options.mip_levels - 1, 0, 16)), gutter(options.padding * this->block)
+{
+    if (options.mip_levels < 1 || options.padding < 0 || options.page_size <= 0 || options.page_size % this->block != 0)
+    {
+        const std::string error_str = "Invalid atlas options: pages of " + std::to_string(options.page_size) + " pixels with "
+                                    + std::to_string(options.mip_levels) + " mip levels and " + std::to_string(options.padding)
+                                    + " pixels of padding (the page size must be a multiple of 2^(mip_levels - 1))";
+        std::cerr << error_str << std::endl;
+        throw std::invalid_argument{error_str};
+    }
+}
+
+atlas_region TextureAtlas::add(int width, int height, int channels, const unsigned char* pixels)
+{
+    const int size = this->options.page_size;
+    const int slot_width = round_up(width + 2 * this->gutter, this->block);
+    const int slot_height = round_up(height + 2 * this->gutter, this->block);
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4 || slot_width > size || slot_height > size)
+    {
+        const std::string error_str = "Can't add a " + std::to_string(width) + "x" + std::to_string(height) + " image with "
+                                    + std::to_string(channels) + " channels to an atlas with pages of "
+                                    + std::to_string(size) + "x" + std::to_string(size) + " pixels";
+        std::cerr << error_str << std::endl;
+        throw std::invalid_argument{error_str};
+    }
+
+    std::vector<unsigned char> rgba((size_t) width * height * 4);
+    pixel_ops::expand_to_rgba(pixels, rgba.data(), (size_t) width * height, channels);
+    if (this->options.premultiply_alpha)
+        pixel_ops::premultiply_alpha(rgba.data(), (size_t) width * height);
+
+    // first page with room for the slot, or a new one
+    std::optional<std::pair<int, int>> slot;
+    size_t page = 0;
+    for (; page < this->pages.size(); page++)
+        if ((slot = this->pages[page].packer.insert(slot_width / this->block, slot_height / this->block)))
+            break;
+    if (!slot)
+    {
+        this->pages.push_back({ SkylinePacker{ size / this->block, size / this->block }, std::vector<unsigned char>((size_t) size * size * 4) });
+        slot = this->pages.back().packer.insert(slot_width / this->block, slot_height / this->block);
+    }
+
+    const int slot_x = slot->first * this->block;
+    const int slot_y = slot->second * this->block;
+    this->blit(this->pages[page], rgba.data(), width, height, slot_x, slot_y, slot_width, slot_height);
+    this->pages[page].dirty = true;
+
+    atlas_region region;
+    region.page = page;
+    region.x = slot_x + this->gutter;
+    region.y = slot_y + this->gutter;
+    region.width = width;
+    region.height = height;
+    region.u_min = (float) region.x / (float) size;
+    region.v_min = (float) region.y / (float) size;
+    region.u_max = (float) (region.x + width) / (float) size;
+    region.v_max = (float) (region.y + height) / (float) size;
+    return region;
+}
+
+atlas_region TextureAtlas::add(const char* filename)
+{
+    int width, height, channels;
+    const std::unique_ptr<unsigned char, void(*)(void*)> data{ stbi_load(filename, &width, &height, &channels, 0), stbi_image_free };
+    if (!data)
+    {
+        std::cerr << "Error loading texture at path \"" << filename << "\"" << std::endl;
+        return this->add(1, 1, 4, TextureLoader::placeholder_color);
+    }
+    return this->add(width, height, channels, data.get());
+}
+
+void TextureAtlas::blit(atlas_page& page, const unsigned char* rgba, int width, int height,
+                        int slot_x, int slot_y, int slot_width, int slot_height) const
+{
+    const size_t page_row = (size_t) this->options.page_size * 4;
+    for (int row = 0; row < slot_height; row++)
+    {
+        // rows and columns past the image repeat its edges
+        const unsigned char* src = rgba + (size_t) std::clamp(row - this->gutter, 0, height - 1) * width * 4;
+        unsigned char* dst = page.pixels.data() + (size_t) (slot_y + row) * page_row + (size_t) slot_x * 4;
+        for (int col = 0; col < this->gutter; col++)
+            std::memcpy(dst + col * 4, src, 4);
+        std::memcpy(dst + this->gutter * 4, src, (size_t) width * 4);
+        for (int col = this->gutter + width; col < slot_width; col++)
+            std::memcpy(dst + col * 4, src + (size_t) (width - 1) * 4, 4);
+    }
+}
+
+void TextureAtlas::upload()
+{
+    const int size = this->options.page_size;
+    const std::vector<pixel_ops::mip_level> levels = pixel_ops::mip_levels(size, size);
+    const size_t level_count = std::min((size_t) this->options.mip_levels, levels.size());
+    std::vector<unsigned char> chain;
+    for (atlas_page& page : this->pages)
+    {
+        if (!page.dirty)
+            continue;
+        // only the levels the page samples from
+        chain.resize(levels[level_count - 1].offset + levels[level_count - 1].size);
+        std::memcpy(chain.data(), page.pixels.data(), page.pixels.size());
+        for (size_t i = 1; i < level_count; i++)
+            pixel_ops::downsample(chain.data() + levels[i - 1].offset, levels[i - 1].width, levels[i - 1].height,
+                                  chain.data() + levels[i].offset, pixel_ops::mip_filter::box, this->options.srgb);
+
+        if (!page.texture)
+        {
+            static constexpr unsigned char transparent[4] = {};
+            page.texture = std::make_unique<Texture>(1, 1, 4, transparent);
+            // the gutters are inside the page: at its edges, clamp instead of mirroring
+            page.texture->set_wrap_mode({ GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, 0 });
+        }
+        page.texture->set_mipmaps(size, size, chain.data(), (int) level_count);
+        page.dirty = false;
+    }
+}
+
+const Texture& TextureAtlas::page(size_t i) const
+{
+    if (i >= this->pages.size() || !this->pages[i].texture)
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: Atlas page out of range, or not uploaded yet"};
+    return *this->pages[i].texture;
+}
+
+void TextureAtlas::use(size_t i) const { this->page(i).use(); }
+
+float TextureAtlas::occupancy(size_t i) const
+{
+    if (i >= this->pages.size())
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: Atlas page out of range"};
+    return this->pages[i].packer.occupancy();
+}
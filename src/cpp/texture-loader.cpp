@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include "texture-loader.h"
+#include "png.h"
+
+using clock_type = std::chrono::steady_clock;
+
+static double ms_since(clock_type::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+
+TextureLoader::TextureLoader(unsigned int threads)
+{
+    // leave a hardware thread for the render thread
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    this->workers.reserve(threads);
+    for (unsigned int i = 0; i < threads; i++)
+        this->workers.emplace_back(&TextureLoader::work, this);
+}
+
+TextureLoader::~TextureLoader()
+{
+    {
+        std::lock_guard lock{ this->mutex };
+        this->stopping = true;
+    }
+    this->request_added.notify_all();
+    for (std::thread& worker : this->workers)
+        worker.join();
+
+}
+
+
+std::shared_ptr<Texture> TextureLoader::placeholder()
+{
+    return std::make_shared<Texture>(1, 1, 4, placeholder_color);
+}
+
+Texture& TextureLoader::load(const char* filename, callback on_loaded)
+{
+    std::shared_ptr<Texture>& texture = this->textures.emplace_back(placeholder());
+    this->load(texture, filename, {}, std::move(on_loaded));
+    return *texture;
+}
+
+void TextureLoader::load(std::shared_ptr<Texture> texture, const char* filename, texture_params params, callback on_loaded)
+{
+    {
+        std::lock_guard lock{ this->mutex };
+        this->requests.push_back({ std::move(texture), filename, params, std::move(on_loaded) });
+        this->loader_stats.queued++;
+    }
+    this->request_added.notify_one();
+}
+
+void TextureLoader::work()
+{
+    while (true)
+    {
+        std::unique_lock lock{ this->mutex };
+        this->request_added.wait(lock, [this] { return this->stopping || !this->requests.empty(); });
+        if (this->stopping)
+            return;
+        decoded_image image{ std::move(this->requests.front()) };
+        this->requests.pop_front();
+        this->loader_stats.queued--;
+        this->loader_stats.decoding++;
+        lock.unlock();
+
+        const auto start = clock_type::now();
+        decode(image);
+        const double ms = ms_since(start);
+
+        lock.lock();
+        this->loader_stats.decoding--;
+        this->loader_stats.decoded++;
+        this->loader_stats.decode_ms += ms;
+        this->decoded.push_back(std::move(image));
+        lock.unlock();
+        this->image_decoded.notify_all();
+    }
+}
+
+
+//! @brief Content of the file at @param filename. Empty if it can't be read
+static std::vector<unsigned char> read_bytes(const std::string& filename)
+{
+    std::ifstream file{ filename, std::ios::binary | std::ios::ate };
+    if (!file)
+        return {};
+    std::vector<unsigned char> bytes((size_t) file.tellg());
+    file.seekg(0);
+    file.read((char*) bytes.data(), (std::streamsize) bytes.size());
+    return file ? bytes : std::vector<unsigned char>{};
+}
+
+void TextureLoader::decode(decoded_image& image)
+{
+    const texture_params& params = image.req.params;
+    const std::vector<unsigned char> file = read_bytes(image.req.filename);
+    if (file.empty())
+        return;
+
+    unsigned char* data = nullptr;
+    int channels = 0;
+#ifndef OPENGL_NO_PNG_DECODER
+    // same pixels as stbi_load, faster. Conversions to fewer channels are left to stbi (RGBA is expanded below anyway)
+    png::image png_image;
+    if ((params.channels == 0 || params.channels == 4) && png::decode(file.data(), file.size(), png_image))
+    {
+        data = png_image.pixels.data();
+        image.width = png_image.width;
+        image.height = png_image.height;
+        channels = png_image.channels;
+    }
+#endif
+    unsigned char* stbi_data = nullptr;
+    if (!data)
+    {
+        // stbi_load is thread-safe. The flip is done by pixel_ops, so it doesn't depend on stbi's global flag
+        stbi_set_flip_vertically_on_load_thread(false);
+        stbi_data = stbi_load_from_memory(file.data(), (int) file.size(), &image.width, &image.height, &channels, params.channels);
+        if (!stbi_data)
+            return;
+        data = stbi_data;
+        // stbi_load reports the channels in the file, not the ones it decoded to
+        if (params.channels != 0)
+            channels = params.channels;
+    }
+
+    if (params.flip_vertically)
+        pixel_ops::flip_vertically(data, image.width, image.height, channels);
+    // level 0 is expanded straight into the mip chain, which is the only copy of the pixels
+    image.mipmaps.resize(pixel_ops::mip_chain_size(image.width, image.height));
+    pixel_ops::expand_to_rgba(data, image.mipmaps.data(), (size_t) image.width * image.height, channels);
+    stbi_image_free(stbi_data);
+    if (params.premultiply_alpha)
+        pixel_ops::premultiply_alpha(image.mipmaps.data(), (size_t) image.width * image.height);
+    pixel_ops::generate_mipmaps(image.mipmaps.data(), image.width, image.height, params.mipmaps, params.srgb);
+}
+
+size_t TextureLoader::upload_image(decoded_image& image)
+{
+    // nobody else uses the texture anymore: it's deleted with the image
+    if (image.req.texture.use_count() == 1)
+        return 0;
+
+    const bool loaded = !image.mipmaps.empty();
+    if (loaded)
+        image.req.texture->set_mipmaps(image.width, image.height, image.mipmaps.data());
+    else
+        std::cerr << "Error loading texture at path \"" << image.req.filename << "\"" << std::endl;
+
+    if (image.req.on_loaded)
+        image.req.on_loaded(*image.req.texture, loaded);
+    return image.mipmaps.size();
+}
+
+size_t TextureLoader::upload(budget limit)
+{
+    const auto start = clock_type::now();
+    size_t bytes = 0;
+    size_t uploaded = 0;
+    while (true)
+    {
+        decoded_image image;
+        {
+            std::lock_guard lock{ this->mutex };
+            if (this->decoded.empty())
+                break;
+            const decoded_image& next = this->decoded.front();
+            if (uploaded > 0 && (bytes + next.mipmaps.size() > limit.bytes || ms_since(start) >= limit.ms))
+                break;
+            image = std::move(this->decoded.front());
+            this->decoded.pop_front();
+        }
+
+        // GL calls and the callback run without the lock, so the workers keep going (and callbacks can call load())
+        const bool loaded = !image.mipmaps.empty();
+        const bool dropped = image.req.texture.use_count() == 1;
+        const auto image_start = clock_type::now();
+        const size_t image_bytes = this->upload_image(image);
+        // deletes the texture if it was dropped
+        image.req.texture.reset();
+        const double image_ms = ms_since(image_start);
+        if (!dropped)
+        {
+            bytes += image_bytes;
+            uploaded++;
+        }
+
+        std::lock_guard lock{ this->mutex };
+        this->loader_stats.decoded--;
+        if (dropped)
+            this->loader_stats.dropped++;
+        else if (loaded)
+            this->loader_stats.uploaded++;
+        else
+            this->loader_stats.failed++;
+        this->loader_stats.bytes_uploaded += image_bytes;
+        // only the time of images, so calling upload() every frame with nothing decoded adds nothing
+        this->loader_stats.upload_ms += image_ms;
+    }
+
+    return uploaded;
+}
+
+size_t TextureLoader::upload() { return this->upload(budget{}); }
+
+void TextureLoader::finish()
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock{ this->mutex };
+            this->image_decoded.wait(lock, [this] {
+                return !this->decoded.empty() || (this->requests.empty() && this->loader_stats.decoding == 0);
+            });
+            if (this->decoded.empty())
+                return;
+        }
+        this->upload({ std::numeric_limits<size_t>::max(), std::numeric_limits<double>::infinity() });
+    }
+}
+
+
+size_t TextureLoader::pending() const
+{
+    std::lock_guard lock{ this->mutex };
+    return this->loader_stats.pending();
+}
+
+TextureLoader::stats TextureLoader::counters() const
+{
+    std::lock_guard lock{ this->mutex };
+    return this->loader_stats;
+}
+
+
+std::ostream& operator<<(std::ostream& os, const TextureLoader::stats& stats)
+{
+    return os << "textures: " << stats.uploaded << " uploaded (" << stats.bytes_uploaded / 1024 << " KiB, "
+              << stats.upload_ms << " ms), " << stats.failed << " failed, " << stats.dropped << " dropped, " << stats.pending() << " pending ("
+              << stats.queued << " queued, " << stats.decoding << " decoding, " << stats.decoded << " decoded), "
+              << stats.decode_ms << " ms decoding\n";
+}
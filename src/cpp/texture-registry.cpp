@@ -0,0 +1,139 @@
+#include <filesystem>
+#include <utility>
+#include "texture-registry.h"
+
+TextureRegistry::TextureRegistry(TextureLoader& loader)
+    : loader(loader) {  }
+
+std::string TextureRegistry::canonical_path(const char* path)
+{
+    std::error_code error;
+    const std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    if (!error)
+        return canonical.generic_string();
+    return std::filesystem::absolute(path, error).lexically_normal().generic_string();
+}
+
+size_t TextureRegistry::key_hash::operator()(const key& k) const
+{
+    const size_t params = (size_t) k.params.channels << 5 | (size_t) k.params.mipmaps << 3 | (size_t) k.params.srgb << 2
+                        | (size_t) k.params.premultiply_alpha << 1 | (size_t) k.params.flip_vertically;
+    return std::hash<std::string>{}(k.path) ^ (params * 0x9E3779B97F4A7C15ull);
+}
+
+
+TextureHandle TextureRegistry::get(const char* path, texture_params params, const TextureLoader::callback& on_loaded)
+{
+    this->registry_stats.requests++;
+    key k{ canonical_path(path), params };
+
+    if (const auto found = this->entries.find(k); found != this->entries.end())
+        if (TextureHandle texture = found->second->texture.lock())
+        {
+            entry& e = *found->second;
+            if (e.loading)
+            {
+                // the image is being decoded already: get it when that one is done
+                this->registry_stats.in_flight_hits++;
+                if (on_loaded)
+                    e.waiting.push_back(on_loaded);
+            }
+            else
+            {
+                this->registry_stats.hits++;
+                if (on_loaded)
+                    on_loaded(*texture, e.loaded);
+            }
+            return texture;
+        }
+
+    this->prune();
+    this->registry_stats.loads++;
+    const auto e = std::make_shared<entry>();
+    if (baked_texture::is_baked(k.path))
+    {
+        // nothing to decode: map the file and upload it now
+        TextureHandle texture;
+        try
+        {
+            texture = std::make_shared<Texture>(baked_texture::file{ k.path.c_str() });
+            e->loaded = true;
+        }
+        catch (const std::invalid_argument&)
+        {
+            texture = TextureLoader::placeholder();
+        }
+        e->texture = texture;
+        e->loading = false;
+        if (on_loaded)
+            on_loaded(*texture, e->loaded);
+        this->entries.insert_or_assign(std::move(k), e);
+        return texture;
+    }
+
+    TextureHandle texture = TextureLoader::placeholder();
+    e->texture = texture;
+    if (on_loaded)
+        e->waiting.push_back(on_loaded);
+
+    this->loader.load(texture, k.path.c_str(), params, [weak_entry = std::weak_ptr<entry>(e)](Texture& t, bool loaded) {
+        const std::shared_ptr<entry> e = weak_entry.lock();
+        if (!e)
+            return;
+        e->loading = false;
+        e->loaded = loaded;
+        for (const TextureLoader::callback& callback : std::exchange(e->waiting, {}))
+            callback(t, loaded);
+    });
+    this->entries.insert_or_assign(std::move(k), e);
+    return texture;
+}
+
+TextureHandle TextureRegistry::find(const char* path, texture_params params) const
+{
+    const auto found = this->entries.find({ canonical_path(path), params });
+    return found == this->entries.end() ? nullptr : found->second->texture.lock();
+}
+
+
+size_t TextureRegistry::prune()
+{
+    return std::erase_if(this->entries, [](const auto& e) { return e.second->texture.expired(); });
+}
+
+std::vector<TextureRegistry::asset> TextureRegistry::assets() const
+{
+    std::vector<asset> assets;
+    for (const auto& [k, e] : this->entries)
+        if (const TextureHandle texture = e->texture.lock())
+            assets.push_back({
+                k.path, k.params,
+                // not counting the reference here, or the loader's while it's loading
+                texture.use_count() - 1 - (e->loading ? 1 : 0),
+                e->loading, !e->loading && !e->loaded,
+                texture->width(), texture->height(), texture->gpu_bytes()
+            });
+    return assets;
+}
+
+size_t TextureRegistry::memory() const
+{
+    size_t bytes = 0;
+    for (const auto& [k, e] : this->entries)
+        if (const TextureHandle texture = e->texture.lock())
+            bytes += texture->gpu_bytes();
+    return bytes;
+}
+
+
+std::ostream& operator<<(std::ostream& os, const TextureRegistry::stats& stats)
+{
+    return os << "texture registry: " << stats.requests << " requests, " << stats.loads << " loads, "
+              << stats.hits << " hits, " << stats.in_flight_hits << " hits while loading\n";
+}
+
+std::ostream& operator<<(std::ostream& os, const TextureRegistry::asset& asset)
+{
+    return os << asset.path << ": " << asset.width << "x" << asset.height << ", " << asset.bytes / 1024 << " KiB, "
+              << asset.handles << " handles" << (asset.loading ? " (loading)" : asset.failed ? " (failed)" : "") << '\n';
+}
@@ -1,11 +1,73 @@
+#include <algorithm>
+#include <vector>
 #include "texture.h"
 
 Texture::Texture(const char *filename)
     : border_col(0, 0, 0, 1)
+{
+    this->create();
+
+    // load image data
+    int width, height, num_col_channels;
+    unsigned char* data = stbi_load(filename, &width, &height, &num_col_channels, 0);
+
+    if (data)
+        this->set_image(width, height, num_col_channels, data);
+    else
+        std::cerr << "Error loading texture at path \"" << filename << "\"" << std::endl;
+
+    // delete image data from the cpu
+    stbi_image_free(data);
+}
+
+Texture::Texture(int width, int height, int num_col_channels, const unsigned char* data)
+    : border_col(0, 0, 0, 1)
+{
+    this->create();
+    this->set_image(width, height, num_col_channels, data);
+}
+
+Texture::Texture(const baked_texture::file& baked)
+    : border_col(0, 0, 0, 1)
+{
+    this->create();
+    this->set_image(baked);
+}
+
+Texture::~Texture()
+{
+    if (this->gl_texture != 0)
+        gl_state::delete_textures(1, &this->gl_texture);
+}
+
+Texture::Texture(Texture&& other) noexcept
+    : gl_texture(other.gl_texture), border_col(other.border_col),
+      _width(other._width), _height(other._height), _num_col_channels(other._num_col_channels)
+{
+    other.gl_texture = 0;
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (this->gl_texture != 0)
+            gl_state::delete_textures(1, &this->gl_texture);
+        this->gl_texture = other.gl_texture;
+        this->border_col = other.border_col;
+        this->_width = other._width;
+        this->_height = other._height;
+        this->_num_col_channels = other._num_col_channels;
+        other.gl_texture = 0;
+    }
+    return *this;
+}
+
+void Texture::create()
 {
     // generate texture id (ptr)
     glGenTextures(1, &this->gl_texture);
-    glBindTexture(GL_TEXTURE_2D, this->gl_texture);
+    gl_state::bind_texture(GL_TEXTURE_2D, this->gl_texture);
 
     /// --- insert any filtering and wrapping settings. (see this->set_wrap_mode() and this->set_filter_mode())
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
@@ -16,60 +78,111 @@ Texture::Texture(const char *filename)
     // use nearest neighbor filtering (without mipmap) when making image larger
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST); // Using mipmap with magnification has no effect
     // Using mipmap here will give GL_INVALID_ENUM error code          // because mipmap only creates images 2x smaller
+}
 
-    // load image data
-    unsigned char* data = stbi_load(filename, &_width, &_height, &_num_col_channels, 0);
+void Texture::set_image(int width, int height, int num_col_channels, const unsigned char* data)
+{
+    // GL would read grey as red: give it RGBA
+    std::vector<unsigned char> rgba;
+    if (num_col_channels == 1 || num_col_channels == 2)
+    {
+        rgba.resize((size_t) width * height * 4);
+        pixel_ops::expand_to_rgba(data, rgba.data(), (size_t) width * height, num_col_channels);
+        data = rgba.data();
+    }
 
-    if (data)
+    this->_width = width;
+    this->_height = height;
+    this->_num_col_channels = num_col_channels;
+    this->bind();
+
+    // check if image uses RGB or RGBA
+    unsigned int img_read_mode = GL_RGB;
+    if (_num_col_channels == 3)
+        ; // already set to GL_RGB
+    else if (_num_col_channels == 4 || !rgba.empty())
+        img_read_mode = GL_RGBA;
+
+    /*! @brief Allocate and create image
+     *  @param _2nd mipmap_level:    how many mipmaps to generate. no need for mipmap when everything is only 2D
+     *  @param _3rd channels:        what channels to load the image onto the GPU with
+     *  @param _6th legacy:          should always stay 0
+     *  @param _7th source_channels: which channels was the original image loaded with (stb_image)
+     *  @param _8th type:            the type of data the image is using (stb_image) */
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->_width, this->_height, 0, img_read_mode, GL_UNSIGNED_BYTE, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+void Texture::set_mipmaps(int width, int height, const unsigned char* chain, int level_count)
+{
+    this->_width = width;
+    this->_height = height;
+    this->_num_col_channels = 4;
+    this->bind();
+
+    // every level was made on the CPU, so there is no glGenerateMipmap
+    const std::vector<pixel_ops::mip_level> levels = pixel_ops::mip_levels(width, height);
+    const size_t count = level_count > 0 ? std::min((size_t) level_count, levels.size()) : levels.size();
+    for (size_t i = 0; i < count; i++)
+        glTexImage2D(GL_TEXTURE_2D, (GLint) i, GL_RGBA, levels[i].width, levels[i].height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, chain + levels[i].offset);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint) count - 1);
+}
+
+void Texture::set_image(const baked_texture::file& baked)
+{
+    this->_width = baked.width();
+    this->_height = baked.height();
+    this->_num_col_channels = 4;
+    this->bind();
+
+    // the levels are already in the upload format, so GL reads straight from the mapped file
+    for (size_t i = 0; i < baked.level_count(); i++)
     {
-        // check if image uses RGB or RGBA
-        unsigned int img_read_mode = GL_RGB;
-        if (_num_col_channels == 3)
-            ; // already set to GL_RGB
-        else if (_num_col_channels == 4)
-            img_read_mode = GL_RGBA;
-
-        /*! @brief Allocate and create image
-         *  @param _2nd mipmap_level:    how many mipmaps to generate. no need for mipmap when everything is only 2D
-         *  @param _3rd channels:        what channels to load the image onto the GPU with
-         *  @param _6th legacy:          should always stay 0
-         *  @param _7th source_channels: which channels was the original image loaded with (stb_image)
-         *  @param _8th type:            the type of data the image is using (stb_image) */
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->_width, this->_height, 0, img_read_mode, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        const baked_texture::level& level = baked.level_info(i);
+        glTexImage2D(GL_TEXTURE_2D, (GLint) i, GL_RGBA, (GLsizei) level.width, (GLsizei) level.height, 0,
+                     baked.format(), baked.type(), baked.pixels(i));
     }
-    else
-        std::cerr << "Error loading texture at path \"" << filename << "\"" << std::endl;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint) baked.level_count() - 1);
+}
 
-    // delete image data from the cpu
-    stbi_image_free(data);
+size_t Texture::gpu_bytes() const
+{
+    if (this->_width <= 0 || this->_height <= 0)
+        return 0;
+    // every mipmap level is half the size of the previous one, down to 1x1
+    size_t bytes = 0;
+    int w = this->_width, h = this->_height;
+    while (true)
+    {
+        bytes += (size_t) w * h * 4;
+        if (w == 1 && h == 1)
+            return bytes;
+        w = std::max(w / 2, 1);
+        h = std::max(h / 2, 1);
+    }
 }
 
 
 void Texture::set_wrap_mode(vec3<int> modes) const
 {
     this->bind();
-    float b[] = {
+    // GL reads 4 floats
+    const float b[] = {
         this->border_col.x,
         this->border_col.y,
         this->border_col.z,
+        this->border_col.w,
     };
 
+    if (modes.x == GL_CLAMP_TO_BORDER || modes.y == GL_CLAMP_TO_BORDER || modes.z == GL_CLAMP_TO_BORDER) // border
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, b);
     if (modes.x != 0)
-        if (modes.x == GL_CLAMP_TO_BORDER) // border
-            glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, b);
-        else
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, modes.x);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, modes.x);
     if (modes.y != 0)
-        if (modes.z == GL_CLAMP_TO_BORDER) // border
-            glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, b);
-        else
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, modes.y);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, modes.y);
     if (modes.z != 0)
-        if (modes.z == GL_CLAMP_TO_BORDER) // border
-            glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, b);
-        else
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, modes.z);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, modes.z);
 }
 
 void Texture::set_filter_mode(vec2<int> modes) const
@@ -82,5 +195,5 @@ void Texture::set_filter_mode(vec2<int> modes) const
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, modes.y);
 }
 
-void Texture::use() const { glBindTexture(GL_TEXTURE_2D, this->gl_texture); }
-void Texture::bind() const { glBindTexture(GL_TEXTURE_2D, this->gl_texture); }
+void Texture::use() const { gl_state::bind_texture(GL_TEXTURE_2D, this->gl_texture); }
+void Texture::bind() const { gl_state::bind_texture(GL_TEXTURE_2D, this->gl_texture); }
@@ -0,0 +1,348 @@
+/// --- KERNELS ---
+/// Loops over plain arrays. float arrays are processed simd::width values at a time,
+/// other types are left to the compiler's auto-vectorizer. Pointers may be unaligned.
+/// The arrays may be the same one (`s.add(s)` passes a component as both a and b): each element is read before it is
+/// written, so the pointers aren't __restrict, which would make that undefined. Arrays that partially overlap are not supported.
+namespace stream_kernels
+{
+    //! @brief a[i] += b[i]
+    template<typename Type>
+    void add(Type* a, const Type* b, size_t n)
+    {
+        size_t i = 0;
+        if constexpr (std::is_same_v<Type, float>)
+            for (; i + simd::width <= n; i += simd::width)
+                simd::storeu(a + i, simd::add(simd::loadu(a + i, simd::f32xN{}), simd::loadu(b + i, simd::f32xN{})));
+        for (; i < n; i++)
+            a[i] += b[i];
+    }
+
+    //! @brief a[i] -= b[i]
+    template<typename Type>
+    void sub(Type* a, const Type* b, size_t n)
+    {
+        size_t i = 0;
+        if constexpr (std::is_same_v<Type, float>)
+            for (; i + simd::width <= n; i += simd::width)
+                simd::storeu(a + i, simd::sub(simd::loadu(a + i, simd::f32xN{}), simd::loadu(b + i, simd::f32xN{})));
+        for (; i < n; i++)
+            a[i] -= b[i];
+    }
+
+    //! @brief a[i] += val
+    template<typename Type>
+    void add(Type* a, Type val, size_t n)
+    {
+        size_t i = 0;
+        if constexpr (std::is_same_v<Type, float>)
+        {
+            const auto v = simd::splat(val, simd::f32xN{});
+            for (; i + simd::width <= n; i += simd::width)
+                simd::storeu(a + i, simd::add(simd::loadu(a + i, simd::f32xN{}), v));
+        }
+        for (; i < n; i++)
+            a[i] += val;
+    }
+
+    //! @brief a[i] *= val
+    template<typename Type>
+    void mul(Type* a, Type val, size_t n)
+    {
+        size_t i = 0;
+        if constexpr (std::is_same_v<Type, float>)
+        {
+            const auto v = simd::splat(val, simd::f32xN{});
+            for (; i + simd::width <= n; i += simd::width)
+                simd::storeu(a + i, simd::mul(simd::loadu(a + i, simd::f32xN{}), v));
+        }
+        for (; i < n; i++)
+            a[i] *= val;
+    }
+
+    //! @brief a[i] /= b[i]
+    template<typename Type>
+    void div(Type* a, const Type* b, size_t n)
+    {
+        size_t i = 0;
+        if constexpr (std::is_same_v<Type, float>)
+            for (; i + simd::width <= n; i += simd::width)
+                simd::storeu(a + i, simd::div(simd::loadu(a + i, simd::f32xN{}), simd::loadu(b + i, simd::f32xN{})));
+        for (; i < n; i++)
+            a[i] /= b[i];
+    }
+
+    //! @brief acc[i] += a[i] * b[i]
+    template<typename Type>
+    void mul_add(Type* acc, const Type* a, const Type* b, size_t n)
+    {
+        size_t i = 0;
+        if constexpr (std::is_same_v<Type, float>)
+            for (; i + simd::width <= n; i += simd::width)
+                simd::storeu(acc + i, simd::add(simd::loadu(acc + i, simd::f32xN{}),
+                                                simd::mul(simd::loadu(a + i, simd::f32xN{}), simd::loadu(b + i, simd::f32xN{}))));
+        for (; i < n; i++)
+            acc[i] += a[i] * b[i];
+    }
+
+    //! @brief a[i] = sqrt(a[i])
+    template<typename Type>
+    void sqrt(Type* a, size_t n)
+    {
+        size_t i = 0;
+        if constexpr (std::is_same_v<Type, float>)
+            for (; i + simd::width <= n; i += simd::width)
+                simd::storeu(a + i, simd::sqrt(simd::loadu(a + i, simd::f32xN{})));
+        for (; i < n; i++)
+            a[i] = (Type) std::sqrt(a[i]);
+    }
+
+    //! @brief Smallest (@param Max = false) or largest (@param Max = true) value in a. @param n must be > 0
+    template<bool Max, typename Type>
+    Type reduce(const Type* a, size_t n)
+    {
+        Type result = a[0];
+        size_t i = 0;
+        if constexpr (std::is_same_v<Type, float>)
+            if (n >= simd::width)
+            {
+                auto acc = simd::loadu(a, simd::f32xN{});
+                for (i = simd::width; i + simd::width <= n; i += simd::width)
+                    acc = Max ? simd::max(acc, simd::loadu(a + i, simd::f32xN{}))
+                              : simd::min(acc, simd::loadu(a + i, simd::f32xN{}));
+
+                alignas(simd::alignment) float lanes[simd::width];
+                simd::store(lanes, acc);
+                for (float lane : lanes)
+                    result = Max ? (lane > result ? lane : result) : (lane < result ? lane : result);
+            }
+        for (; i < n; i++)
+            result = Max ? (a[i] > result ? a[i] : result) : (a[i] < result ? a[i] : result);
+        return result;
+    }
+}
+
+
+
+/// --- VEC_STREAM ---
+template<typename Type, size_t N>
+void vec_stream<Type, N>::resize(size_t count)
+{
+    for (auto& c : this->components)
+        c.resize(count, Type{ 0 });
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::reserve(size_t count)
+{
+    for (auto& c : this->components)
+        c.reserve(count);
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::clear()
+{
+    for (auto& c : this->components)
+        c.clear();
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::push_back(const value_type& v)
+{
+    for (unsigned char c = 0; c < N; c++)
+        this->components[c].push_back(v[c]);
+}
+
+template<typename Type, size_t N>
+typename vec_stream<Type, N>::value_type vec_stream<Type, N>::operator[](size_t i) const
+{
+    if (i >= this->size())
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: index is past the end of the vec_stream"};
+
+    std::array<Type, N> c;
+    for (unsigned char j = 0; j < N; j++)
+        c[j] = this->components[j][i];
+    return make(c);
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::set(size_t i, const value_type& v)
+{
+    if (i >= this->size())
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: index is past the end of the vec_stream"};
+
+    for (unsigned char c = 0; c < N; c++)
+        this->components[c][i] = v[c];
+}
+
+template<typename Type, size_t N>
+Type* vec_stream<Type, N>::component(unsigned char c)
+{
+    if (c < N)
+        return this->components[c].data();
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec_stream has less components"};
+}
+
+template<typename Type, size_t N>
+const Type* vec_stream<Type, N>::component(unsigned char c) const
+{
+    if (c < N)
+        return this->components[c].data();
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec_stream has less components"};
+}
+
+// -- conversion
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::from_interleaved(const float* src, size_t count, unsigned int vertex_length, unsigned int offset)
+{
+    if (offset + N > vertex_length)
+    {
+        const char* error_str = "Attribute does not fit in the vertex. "
+                                "@param<offset> + number of components has to be at most @param<vertex_length>.";
+        std::cerr << error_str;
+        throw std::invalid_argument{error_str};
+    }
+
+    this->resize(count);
+    for (unsigned char c = 0; c < N; c++)
+    {
+        Type* __restrict dst = this->components[c].data();
+        const float* s = src + offset + c;
+        for (size_t i = 0; i < count; i++)
+            dst[i] = (Type) s[i * vertex_length];
+    }
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::to_interleaved(float* dst, unsigned int vertex_length, unsigned int offset) const
+{
+    if (offset + N > vertex_length)
+    {
+        const char* error_str = "Attribute does not fit in the vertex. "
+                                "@param<offset> + number of components has to be at most @param<vertex_length>.";
+        std::cerr << error_str;
+        throw std::invalid_argument{error_str};
+    }
+
+    const size_t count = this->size();
+    for (unsigned char c = 0; c < N; c++)
+    {
+        const Type* __restrict src = this->components[c].data();
+        float* d = dst + offset + c;
+        for (size_t i = 0; i < count; i++)
+            d[i * vertex_length] = (float) src[i];
+    }
+}
+
+template<typename Type, size_t N> template<size_t v_size>
+void vec_stream<Type, N>::to_interleaved(std::array<float, v_size>& dst, unsigned int vertex_length, unsigned int offset) const
+{
+    if (this->size() * vertex_length > v_size)
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vertex array is too small for the vec_stream"};
+    this->to_interleaved(dst.data(), vertex_length, offset);
+}
+
+// -- batch kernels
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::add(const vec_stream& other)
+{
+    this->check_same_size(other);
+    for (unsigned char c = 0; c < N; c++)
+        stream_kernels::add(this->components[c].data(), other.components[c].data(), this->size());
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::sub(const vec_stream& other)
+{
+    this->check_same_size(other);
+    for (unsigned char c = 0; c < N; c++)
+        stream_kernels::sub(this->components[c].data(), other.components[c].data(), this->size());
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::add(const value_type& offset)
+{
+    for (unsigned char c = 0; c < N; c++)
+        stream_kernels::add(this->components[c].data(), offset[c], this->size());
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::scale(Type val)
+{
+    for (unsigned char c = 0; c < N; c++)
+        stream_kernels::mul(this->components[c].data(), val, this->size());
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::normalize()
+{
+    component_array len(this->size());
+    this->length(len.data());
+    for (unsigned char c = 0; c < N; c++)
+        stream_kernels::div(this->components[c].data(), len.data(), this->size());
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::dot(const vec_stream& other, Type* out) const
+{
+    this->check_same_size(other);
+    std::fill(out, out + this->size(), Type{ 0 });
+    for (unsigned char c = 0; c < N; c++)
+        stream_kernels::mul_add(out, this->components[c].data(), other.components[c].data(), this->size());
+}
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::length(Type* out) const
+{
+    this->dot(*this, out);
+    stream_kernels::sqrt(out, this->size());
+}
+
+// -- reductions
+
+template<typename Type, size_t N>
+typename vec_stream<Type, N>::value_type vec_stream<Type, N>::min() const
+{
+    if (this->size() == 0)
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: cannot reduce an empty vec_stream"};
+
+    std::array<Type, N> c;
+    for (unsigned char j = 0; j < N; j++)
+        c[j] = stream_kernels::reduce<false>(this->components[j].data(), this->size());
+    return make(c);
+}
+
+template<typename Type, size_t N>
+typename vec_stream<Type, N>::value_type vec_stream<Type, N>::max() const
+{
+    if (this->size() == 0)
+        throw std::out_of_range{"STD::OUT_OF_RANGE Exception: cannot reduce an empty vec_stream"};
+
+    std::array<Type, N> c;
+    for (unsigned char j = 0; j < N; j++)
+        c[j] = stream_kernels::reduce<true>(this->components[j].data(), this->size());
+    return make(c);
+}
+
+// -- helpers
+
+template<typename Type, size_t N>
+void vec_stream<Type, N>::check_same_size(const vec_stream& other) const
+{
+    if (other.size() != this->size())
+    {
+        const char* error_str = "Both vec_streams must have the same number of vecs.";
+        std::cerr << error_str;
+        throw std::invalid_argument{error_str};
+    }
+}
+
+template<typename Type, size_t N>
+typename vec_stream<Type, N>::value_type vec_stream<Type, N>::make(const std::array<Type, N>& c)
+{
+    value_type v;
+    for (unsigned char j = 0; j < N; j++)
+        v[j] = c[j];
+    return v;
+}
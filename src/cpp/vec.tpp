@@ -1,822 +1,267 @@
-/// --- VEC1 ---
-template<typename Type>
-double vec1<Type>::length() const
-requires std::is_arithmetic_v<Type>
-{
-    return this->x;
-}
-
-template<typename Type>
-vec1<double> vec1<Type>::normalized() const
-requires std::is_arithmetic_v<Type>
-{
-    return vec1<double>{ 1.0 };
-}
-
-template<typename Type>
-Type& vec1<Type>::operator[](unsigned char i)
-{
-    if (i < 1)
-        return *(&this->x + i);
-    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec1 only has 1 component"};
-}
-template<typename Type>
-Type vec1<Type>::operator[](unsigned char i) const
-{
-    if (i < 1)
-        return *(&this->x + i);
-    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec1 only has 1 component"};
-}
-
-// -- vector addition
-
-template<typename Type> template<typename Type2>
-vec4<Type> vec1<Type>::operator+(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-                  other.y,
-                  other.z,
-                  other.w
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec1<Type>::operator+(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-                  other.y,
-                  other.z
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec2<Type> vec1<Type>::operator+(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-                  other.y
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec1<Type> vec1<Type>::operator+(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec1<Type> vec1<Type>::operator+(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+/// --- VEC ---
+template<typename Type, size_t N> template<vec_expression E> requires (E::size <= N)
+constexpr vec<Type, N>& vec<Type, N>::operator+=(const E& e)
 {
-    return {
-        this->x + val
-    };
+    this->assign(*this + e);
+    return *this;
 }
 
-// -- vector subtraction
-
-template<typename Type> template<typename Type2>
-vec4<Type> vec1<Type>::operator-(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<vec_expression E> requires (E::size <= N)
+constexpr vec<Type, N>& vec<Type, N>::operator-=(const E& e)
 {
-    return {
-        this->x - other.x,
-                - other.y,
-                - other.z,
-                - other.w
-    };
+    this->assign(*this - e);
+    return *this;
 }
 
-template<typename Type> template<typename Type2>
-vec3<Type> vec1<Type>::operator-(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<typename Type2> requires std::is_arithmetic_v<Type2>
+constexpr vec<Type, N>& vec<Type, N>::operator+=(const Type2& val)
 {
-    return {
-        this->x - other.x,
-                - other.y,
-                - other.z
-    };
+    this->assign(*this + val);
+    return *this;
 }
 
-template<typename Type> template<typename Type2>
-vec2<Type> vec1<Type>::operator-(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<typename Type2> requires std::is_arithmetic_v<Type2>
+constexpr vec<Type, N>& vec<Type, N>::operator-=(const Type2& val)
 {
-    return {
-        this->x - other.x,
-                - other.y
-    };
+    this->assign(*this - val);
+    return *this;
 }
 
-template<typename Type> template<typename Type2>
-vec1<Type> vec1<Type>::operator-(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<typename Type2> requires std::is_arithmetic_v<Type2>
+constexpr vec<Type, N>& vec<Type, N>::operator*=(const Type2& val)
 {
-    return {
-        this->x - other.x
-    };
+    this->assign(*this * val);
+    return *this;
 }
 
-template<typename Type> template<typename Type2>
-vec1<Type> vec1<Type>::operator-(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<typename Type2> requires std::is_arithmetic_v<Type2>
+constexpr vec<Type, N>& vec<Type, N>::operator/=(const Type2& val)
 {
-    return {
-        this->x - val
-    };
+    this->assign(*this / val);
+    return *this;
 }
 
-// -- vector division
-
-template<typename Type> template<typename Type2>
-vec1<Type> vec1<Type>::operator/(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x / val
-    };
-}
-
-// -- vector multiplication
-
-template<typename Type> template<typename Type2>
-double vec1<Type>::dot_mult(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return (double) this->x * other.x;
-}
-
-template<typename Type> template<typename Type2>
-vec1<Type> vec1<Type>::operator*(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x * val
-    };
-}
-
-
-
-/// --- VEC2 ---
-template<typename Type>
-double vec2<Type>::length() const
+template<typename Type, size_t N>
+constexpr double vec<Type, N>::length() const
 requires std::is_arithmetic_v<Type>
 {
-    return sqrt(SQR(this->x) + SQR(this->y));
-}
-
-template<typename Type>
-vec2<double> vec2<Type>::normalized() const
-requires std::is_arithmetic_v<Type>
-{
-    double len = this->length();
-    return {
-        this->x / len,
-        this->y / len
-    };
-}
-
-template<typename Type>
-Type& vec2<Type>::operator[](unsigned char i)
-{
-    if (i < 2)
-        return *(&this->x + i);
-    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec2 only has 2 components"};
-}
-
-template<typename Type>
-Type vec2<Type>::operator[](unsigned char i) const
-{
-    if (i < 2)
-        return *(&this->x + i);
-    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec2 only has 2 components"};
-}
-
-// -- vector addition
-
-template<typename Type> template<typename Type2>
-vec4<Type> vec2<Type>::operator+(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y + other.y,
-                  other.z,
-                  other.w
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec2<Type>::operator+(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y + other.y,
-                  other.z
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec2<Type> vec2<Type>::operator+(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y + other.y
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec2<Type> vec2<Type>::operator+(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec2<Type> vec2<Type>::operator+(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + val,
-        this->y + val
-    };
-}
-
-// -- vector subtraction
-
-template<typename Type> template<typename Type2>
-vec4<Type> vec2<Type>::operator-(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - other.x,
-        this->y - other.y,
-                - other.z,
-                - other.w
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec2<Type>::operator-(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - other.x,
-        this->y - other.y,
-                - other.z
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec2<Type> vec2<Type>::operator-(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - other.x,
-        this->y - other.y
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec2<Type> vec2<Type>::operator-(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - other.x,
-        this->y
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec2<Type> vec2<Type>::operator-(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - val,
-        this->y - val
-    };
-}
-
-// -- vector division
-
-template<typename Type> template<typename Type2>
-vec2<Type> vec2<Type>::operator/(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x / val,
-        this->y / val
-    };
-}
-
-// -- vector multiplication
-
-template<typename Type> template<typename Type2>
-double vec2<Type>::dot_mult(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return (double) this->x * other.x +
-           (double) this->y * other.y ;
-}
+    if constexpr (std::is_same_v<Type, float> && N >= 3)
+        if (!std::is_constant_evaluated())
+        {
+            // single precision, in SIMD registers
+            const simd::f32x4 v = this->packed();
+            return std::sqrt(simd::dot4(v, v));
+        }
 
-template<typename Type> template<typename Type2>
-vec2<Type> vec2<Type>::operator*(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x * val,
-        this->y * val
-    };
+    double sum = 0;
+    for (size_t i = 0; i < N; i++)
+        sum += (double) this->get(i) * this->get(i);
+    return constexpr_math::sqrt(sum);
 }
 
-
-
-/// --- VEC3 ---
-template<typename Type>
-double vec3<Type>::length() const
+template<typename Type, size_t N>
+constexpr vec<double, N> vec<Type, N>::normalized() const
 requires std::is_arithmetic_v<Type>
 {
-    return sqrt(SQR(this->x) + SQR(this->y) + SQR(this->z));
-}
-
-template<typename Type>
-vec3<double> vec3<Type>::normalized() const
-requires std::is_arithmetic_v<Type>
-{
-    double len = this->length();
-    return {
-        this->x / len,
-        this->y / len,
-        this->z / len
-    };
-}
-
-template<typename Type>
-Type& vec3<Type>::operator[](unsigned char i)
-{
-    if (i < 3)
-        return *(&this->x + i);
-    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec3 only has 3 components"};
-}
-template<typename Type>
-Type vec3<Type>::operator[](unsigned char i) const
-{
-    if (i < 3)
-        return *(&this->x + i);
-    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec3 only has 3 components"};
-}
-
-// -- vector addition
-
-template<typename Type> template<typename Type2>
-vec4<Type> vec3<Type>::operator+(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y + other.y,
-        this->z + other.z,
-                  other.w
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator+(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y + other.y,
-        this->z + other.z
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator+(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y + other.y,
-        this->z
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator+(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y,
-        this->z
-    };
-}
+    vec<double, N> result;
+    if constexpr (std::is_same_v<Type, float> && N >= 3)
+        if (!std::is_constant_evaluated())
+        {
+            const simd::f32x4 v = this->packed();
+            const vec<float, N> n{ simd::div(v, simd::splat(std::sqrt(simd::dot4(v, v)))) };
+            for (size_t i = 0; i < N; i++)
+                result[i] = n.get(i);
+            return result;
+        }
 
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator+(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + val,
-        this->y + val,
-        this->z + val
-    };
+    const double len = this->length();
+    for (size_t i = 0; i < N; i++)
+        result[i] = this->get(i) / len;
+    return result;
 }
 
-// -- vector subtraction
-
-template<typename Type> template<typename Type2>
-vec4<Type> vec3<Type>::operator-(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N>
+constexpr Type& vec<Type, N>::operator[](unsigned char i)
 {
-    return {
-        this->x - other.x,
-        this->y - other.y,
-        this->z - other.z,
-                - other.w
-    };
+    if (i < N)
+        return this->component(i);
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec" + std::to_string(N) + " only has " + std::to_string(N) + " components"};
 }
 
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator-(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N>
+constexpr Type vec<Type, N>::operator[](unsigned char i) const
 {
-    return {
-        this->x - other.x,
-        this->y - other.y,
-        this->z - other.z
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator-(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - other.x,
-        this->y - other.y,
-        this->z
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator-(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - other.x,
-        this->y,
-        this->z
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator-(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - val,
-        this->y - val,
-        this->z - val
-    };
-}
-
-// -- vector division
-
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator/(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x / val,
-        this->y / val,
-        this->z / val
-    };
+    if (i < N)
+        return this->get(i);
+    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec" + std::to_string(N) + " only has " + std::to_string(N) + " components"};
 }
 
 // -- vector multiplication
 
-template<typename Type> template<typename Type2>
-double vec3<Type>::dot_mult(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<vec_expression E> requires (E::size == N)
+constexpr double vec<Type, N>::dot_mult(const E& other) const
 {
-    return (double) this->x * other.x +
-           (double) this->y * other.y +
-           (double) this->z * other.z ;
-}
+    if constexpr (std::is_same_v<Type, float> && N >= 3 && E::packetizable)
+        if (!std::is_constant_evaluated())
+            // lanes past N are 0 in both, so a 4 lane dot product works for vec3 too
+            return simd::dot4(this->packed(), other.packed());
 
-template<typename Type> template<typename Type2>
-vec3<double> vec3<Type>::cross_mult(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        (double) this->y * other.z - this->z * other.y,
-        (double) this->z * other.x - this->x * other.z,
-        (double) this->x * other.y - this->y * other.x
-    };
+    double sum = 0;
+    for (size_t i = 0; i < N; i++)
+        sum += (double) this->get(i) * other.get(i);
+    return sum;
 }
 
-template<typename Type> template<typename Type2>
-vec3<Type> vec3<Type>::operator*(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<vec_expression E> requires (N == 3 && E::size == 3)
+constexpr vec<double, 3> vec<Type, N>::cross_mult(const E& other) const
 {
-    return {
-        this->x * val,
-        this->y * val,
-        this->z * val
-    };
-}
-
-
+    if constexpr (std::is_same_v<Type, float> && E::packetizable)
+        if (!std::is_constant_evaluated())
+        {
+            const vec<float, 3> c{ simd::cross3(this->packed(), other.packed()) };
+            return { (double) c.x, (double) c.y, (double) c.z };
+        }
 
-/// --- VEC4 ---
-template<typename Type>
-double vec4<Type>::length() const
-requires std::is_arithmetic_v<Type>
-{
-    return sqrt(SQR(this->x) + SQR(this->y) + SQR(this->z) + SQR(this->w));
-}
-
-template<typename Type>
-vec4<double> vec4<Type>::normalized() const
-requires std::is_arithmetic_v<Type>
-{
-    double len = this->length();
+    const double ox = other.get(0), oy = other.get(1), oz = other.get(2);
     return {
-        this->x / len,
-        this->y / len,
-        this->z / len,
-        this->w / len
+        (double) this->y * oz - (double) this->z * oy,
+        (double) this->z * ox - (double) this->x * oz,
+        (double) this->x * oy - (double) this->y * ox
     };
 }
 
-template<typename Type>
-Type& vec4<Type>::operator[](unsigned char i)
-{
-    if (i < 3)
-        return *(&this->x + i);
-    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec4 only has 4 components"};
-}
-template<typename Type>
-Type vec4<Type>::operator[](unsigned char i) const
-{
-    if (i < 3)
-        return *(&this->x + i);
-    throw std::out_of_range{"STD::OUT_OF_RANGE Exception: vec4 only has 4 components"};
-}
+// -- expression protocol
 
-// -- vector addition
-
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator+(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N>
+constexpr Type vec<Type, N>::get(size_t i) const
 {
-    return {
-        this->x + other.x,
-        this->y + other.y,
-        this->z + other.z,
-        this->w + other.w
-    };
+    if constexpr (N == 1)
+        return i == 0 ? this->x : Type(0);
+    else if constexpr (N == 2)
+        return i == 0 ? this->x : i == 1 ? this->y : Type(0);
+    else if constexpr (N == 3)
+        return i == 0 ? this->x : i == 1 ? this->y : i == 2 ? this->z : Type(0);
+    else
+        return i == 0 ? this->x : i == 1 ? this->y : i == 2 ? this->z : i == 3 ? this->w : Type(0);
 }
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator+(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N>
+simd::f32x4 vec<Type, N>::packed() const
+requires std::is_same_v<Type, float>
 {
-    return {
-        this->x + other.x,
-        this->y + other.y,
-        this->z + other.z,
-        this->w
-    };
+    if constexpr (N >= 3)
+        return simd::load(reinterpret_cast<const float*>(this)); // aligned, and the padding lane of vec3 is 0
+    else if constexpr (N == 2)
+        return simd::set(this->x, this->y, 0, 0);
+    else
+        return simd::set(this->x, 0, 0, 0);
 }
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator+(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x + other.x,
-        this->y + other.y,
-        this->z,
-        this->w
-    };
-}
+// -- helpers
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator+(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<typename Arg>
+constexpr void vec<Type, N>::assign_flat(size_t& i, const Arg& arg)
 {
-    return {
-        this->x + other.x,
-        this->y,
-        this->z,
-        this->w
-    };
+    if constexpr (std::is_arithmetic_v<Arg>)
+        this->component(i++) = static_cast<Type>(arg);
+    else
+        for (size_t j = 0; j < Arg::size; j++)
+            this->component(i++) = arg.get(j);
 }
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator+(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N> template<typename E>
+constexpr void vec<Type, N>::assign(const E& e)
 {
-    return {
-        this->x + val,
-        this->y + val,
-        this->z + val,
-        this->w + val
-    };
-}
-
-// -- vector subtraction
+    if constexpr (std::is_same_v<Type, float> && N >= 3 && E::packetizable)
+        if (!std::is_constant_evaluated())
+        {
+            this->assign_packed(e.packed());
+            return;
+        }
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator-(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - other.x,
-        this->y - other.y,
-        this->z - other.z,
-        this->w - other.w
-    };
+    // every component only depends on the same component of the operands, so this is safe when e refers to *this
+    for (size_t i = 0; i < N; i++)
+        this->component(i) = static_cast<Type>(e.get(i));
 }
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator-(const vec3<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N>
+void vec<Type, N>::assign_packed(simd::f32x4 v)
+requires std::is_same_v<Type, float>
 {
-    return {
-        this->x - other.x,
-        this->y - other.y,
-        this->z - other.z,
-        this->w
-    };
-}
-
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator-(const vec2<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - other.x,
-        this->y - other.y,
-        this->z,
-        this->w
-    };
+    if constexpr (N >= 3)
+    {
+        // the 4th lane of a vec3 may hold anything (e.g. w of a vec4 expression). Clear it in the register:
+        // a separate store to _pad would make the next load of this vec wait for both stores to finish
+        if constexpr (N == 3)
+            v = simd::zero_w(v);
+        simd::store(reinterpret_cast<float*>(this), v);
+    }
+    else
+    {
+        alignas(16) float lanes[4];
+        simd::store(lanes, v);
+        for (size_t i = 0; i < N; i++)
+            this->component(i) = lanes[i];
+    }
 }
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator-(const vec1<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Type, size_t N>
+constexpr Type& vec<Type, N>::component(size_t i)
 {
-    return {
-        this->x - other.x,
-        this->y,
-        this->z,
-        this->w
-    };
+    if constexpr (N == 1)
+        return this->x;
+    else if constexpr (N == 2)
+        return i == 0 ? this->x : this->y;
+    else if constexpr (N == 3)
+        return i == 0 ? this->x : i == 1 ? this->y : this->z;
+    else
+        return i == 0 ? this->x : i == 1 ? this->y : i == 2 ? this->z : this->w;
 }
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator-(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
-{
-    return {
-        this->x - val,
-        this->y - val,
-        this->z - val,
-        this->w - val
-    };
-}
 
-// -- vector division
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator/(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+/// --- EXPRESSIONS ---
+template<typename Type>
+simd::f32x4 vec_scalar<Type>::packed(size_t n, float pad) const
 {
-    return {
-        this->x / val,
-        this->y / val,
-        this->z / val,
-        this->w / val
-    };
+    const auto v = (float) this->val;
+    return simd::set(v, n > 1 ? v : pad, n > 2 ? v : pad, n > 3 ? v : pad);
 }
 
-// -- vector multiplication
-
-template<typename Type> template<typename Type2>
-double vec4<Type>::dot_mult(const vec4<Type2>& other) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Op, typename L, typename R>
+constexpr typename vec_binary<Op, L, R>::value_type vec_binary<Op, L, R>::get(size_t i) const
 {
-    return (double) this->x * other.x +
-           (double) this->y * other.y +
-           (double) this->z * other.z +
-           (double) this->w * other.w ;
+    // keeps the "missing components are 0" rule when this is an operand of a bigger expression
+    if (i >= size)
+        return value_type(0);
+    return static_cast<value_type>(Op::apply(this->l.get(i), this->r.get(i)));
 }
 
-template<typename Type> template<typename Type2>
-vec4<Type> vec4<Type>::operator*(const Type2& val) const
-requires std::is_arithmetic_v<Type> && std::is_arithmetic_v<Type2>
+template<typename Op, typename L, typename R>
+simd::f32x4 vec_binary<Op, L, R>::packed() const
 {
-    return {
-        this->x * val,
-        this->y * val,
-        this->z * val,
-        this->w * val
-    };
+    // lanes past size must stay 0, so a scalar is only broadcast to the lanes this expression uses
+    if constexpr (R::size == 0)
+        return Op::apply(this->l.packed(), this->r.packed(size, Op::pad));
+    else
+        return Op::apply(this->l.packed(), this->r.packed());
 }
 
 
 
-
 // --- PRINTING VECS ---
-// -- vec1
-template<typename Type>
-std::ostream& operator<<(std::ostream &os, const vec1<Type>& v)
-{
-    os << "{ " << v.x << " }";
-    return os;
-}
-// TODO: (vec1) Fix Linker problem with template overload for print char, str
-// std::ostream& operator<<(std::ostream &os, const vec1<char>& v)
-// {
-//     os << "{ '" << v.x << "' }";
-//     return os;
-// }
-// std::ostream& operator<<(std::ostream &os, const vec1<std::string>& v)
-// {
-//     os << "{ \"" << v.x << "\" }";
-//     return os;
-// }
-
-// -- vec2
-template<typename Type>
-std::ostream &operator<<(std::ostream &os, const vec2<Type> &v)
+template<typename Type, size_t N>
+std::ostream& operator<<(std::ostream& os, const vec<Type, N>& v)
 {
-    os << "{ " << v.x << ", " << v.y << " }";
+    os << "{ ";
+    for (size_t i = 0; i < N; i++)
+        os << (i == 0 ? "" : ", ") << v.get(i);
+    os << " }";
     return os;
 }
-// TODO: (vec2) Fix Linker problem with template overload for print char, str
-// std::ostream& operator<<(std::ostream &os, const vec2<char>& v)
-// {
-//     os << "{ '" << v.x << "', '" << v.y << "' }";
-//     return os;
-// }
-// std::ostream& operator<<(std::ostream &os, const vec2<std::string>& v)
-// {
-//     os << "{ \"" << v.x << "\", \"" << v.y << "\" }";
-//     return os;
-// }
-
-// -- vec3
-template<typename Type>
-std::ostream& operator<<(std::ostream &os, const vec3<Type>& v)
-{
-    os << "{ " << v.x << ", " << v.y << ", " << v.z << " }";
-    return os;
-}
-// TODO: (vec3) Fix Linker problem with template overload for print char, str
-// std::ostream& operator<<(std::ostream &os, const vec3<char>& v)
-// {
-//     os << "{ '" << v.x << "', '" << v.y << "', '" << v.z << "' }";
-//     return os;
-// }
-// std::ostream& operator<<(std::ostream &os, const vec3<std::string>& v)
-// {
-//     os << "{ \"" << v.x << "\", \"" << v.y << "\", \"" << v.z << "\" }";
-//     return os;
-// }
-
-// -- vec4
-template<typename Type>
-std::ostream& operator<<(std::ostream &os, const vec4<Type>& v)
+
+template<typename Op, typename L, typename R>
+std::ostream& operator<<(std::ostream& os, const vec_binary<Op, L, R>& e)
 {
-    os << "{ " << v.x << ", " << v.y << ", " << v.z << ", " << v.w << " }";
-    return os;
+    return os << e.eval();
 }
-// TODO: (vec4) Fix Linker problem with template overload for print char, str
-// std::ostream& operator<<(std::ostream &os, const vec4<char>& v)
-// {
-//     os << "{ '" << v.x << "', '" << v.y << "', '" << v.z << "', '" << v.w << "' }";
-//     return os;
-// }
-// std::ostream& operator<<(std::ostream &os, const vec4<std::string>& v)
-// {
-//     os << "{ \"" << v.x << "\", \"" << v.y << "\", \"" << v.z << "\", \"" << v.w << "\" }";
-//     return os;
-// }
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "vertex-quantize.h"
+
+namespace vertex_quantize
+{
+    std::uint16_t to_half(float value)
+    {
+        const auto bits = std::bit_cast<std::uint32_t>(value);
+        const auto sign = (std::uint16_t) ((bits >> 16) & 0x8000);
+        const std::uint32_t magnitude = bits & 0x7FFFFFFF;
+
+        // infinity and NaN (which stays a NaN)
+        if (magnitude >= 0x7F800000)
+            return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0);
+        // rounds past 65504, the largest half
+        if (magnitude >= 0x477FF000)
+            return sign | 0x7C00;
+        // below 2^-14 halves are subnormal: multiples of 2^-24
+        if (magnitude < 0x38800000)
+            return sign | (std::uint16_t) std::nearbyint(std::bit_cast<float>(magnitude) * 16777216.0f);
+
+        // rebias the exponent (127 -> 15) and keep 10 of the 23 mantissa bits, rounding to nearest even.
+        // A mantissa that rounds up to 1024 carries into the exponent, which is the right result
+        std::uint32_t half = (magnitude - 0x38000000) >> 13;
+        const std::uint32_t rest = magnitude & 0x1FFF;
+        if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+            half++;
+        return sign | (std::uint16_t) half;
+    }
+
+    float from_half(std::uint16_t half)
+    {
+        const std::uint32_t sign = (std::uint32_t) (half & 0x8000) << 16;
+        const std::uint32_t exponent = (half >> 10) & 0x1F;
+        const std::uint32_t mantissa = half & 0x3FF;
+        if (exponent == 0)
+        {
+            const float value = std::ldexp((float) mantissa, -24);
+            return sign ? -value : value;
+        }
+        if (exponent == 31)
+            return std::bit_cast<float>(sign | 0x7F800000 | mantissa << 13);
+        return std::bit_cast<float>(sign | (exponent + 112) << 23 | mantissa << 13);
+    }
+
+    //! @brief Round @param value (clamped to -1 to 1) to a signed normalized integer whose largest value is @param max
+    static int to_snorm(float value, int max) { return (int) std::lround(std::clamp(value, -1.0f, 1.0f) * (float) max); }
+    //! @brief What GL reads a signed normalized @param value as (the GL 4.2 rule, which GPUs also use in 3.3 contexts)
+    static float from_snorm(int value, int max) { return std::max((float) value / (float) max, -1.0f); }
+
+    std::uint32_t pack_snorm_10_10_10_2(float x, float y, float z, float w)
+    {
+        return ((std::uint32_t) to_snorm(x, 511) & 0x3FF)
+             | ((std::uint32_t) to_snorm(y, 511) & 0x3FF) << 10
+             | ((std::uint32_t) to_snorm(z, 511) & 0x3FF) << 20
+             | ((std::uint32_t) to_snorm(w, 1) & 0x3) << 30;
+    }
+
+    //! @brief Bytes @param components values take in @param type
+    static size_t size_of(format type, unsigned int components)
+    {
+        switch (type)
+        {
+            case format::float32:          return 4 * components;
+            case format::half:
+            case format::snorm16:
+            case format::unorm16:          return 2 * components;
+            case format::unorm8:           return components;
+            case format::snorm_10_10_10_2: return 4;
+        }
+        return 0;
+    }
+
+    template<typename Type>
+    static void store(std::byte* out, size_t i, Type value) { std::memcpy(out + i * sizeof(Type), &value, sizeof(Type)); }
+
+    /*! @brief Write @param components values of @param in as @param type at @param out.
+     *  @return the largest difference between a value and what the GPU will read */
+    static float encode(format type, const float* in, unsigned int components, std::byte* out)
+    {
+        float error = 0;
+        const auto track = [&error](float original, float decoded) { error = std::max(error, std::abs(decoded - original)); };
+        switch (type)
+        {
+            case format::float32:
+                std::memcpy(out, in, components * sizeof(float));
+                break;
+            case format::half:
+                for (unsigned int i = 0; i < components; i++)
+                {
+                    const std::uint16_t half = to_half(in[i]);
+                    store(out, i, half);
+                    track(in[i], from_half(half));
+                }
+                break;
+            case format::snorm16:
+                for (unsigned int i = 0; i < components; i++)
+                {
+                    const int value = to_snorm(in[i], 32767);
+                    store(out, i, (std::int16_t) value);
+                    track(in[i], from_snorm(value, 32767));
+                }
+                break;
+            case format::unorm16:
+            case format::unorm8:
+            {
+                const bool wide = type == format::unorm16;
+                const float max = wide ? 65535.0f : 255.0f;
+                for (unsigned int i = 0; i < components; i++)
+                {
+                    // not negative, so adding 0.5 and truncating rounds (much faster than lround)
+                    const auto value = (long) (std::clamp(in[i], 0.0f, 1.0f) * max + 0.5f);
+                    if (wide)
+                        store(out, i, (std::uint16_t) value);
+                    else
+                        store(out, i, (std::uint8_t) value);
+                    track(in[i], (float) value / max);
+                }
+                break;
+            }
+            case format::snorm_10_10_10_2:
+            {
+                // a normal only has a direction
+                const float length = std::sqrt(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+                const float scale = length > 0 ? 1 / length : 0;
+                const float normal[3] = { in[0] * scale, in[1] * scale, in[2] * scale };
+                store(out, 0, pack_snorm_10_10_10_2(normal[0], normal[1], normal[2]));
+                for (const float n : normal)
+                    track(n, from_snorm(to_snorm(n, 511), 511));
+                break;
+            }
+        }
+        return error;
+    }
+
+    vertices quantize(std::span<const float> source, unsigned int vertex_length, const options& formats)
+    {
+        std::string error_str;
+        if (vertex_length != 3 && vertex_length != 7 && vertex_length != 9 && vertex_length != 12)
+            error_str = "Can't quantize vertices of " + std::to_string(vertex_length)
+                      + " floats: they must be position(3), color(4), tex_coord(2), normal(3), up to one of them";
+        else if (source.size() % vertex_length != 0)
+            error_str = "Can't quantize " + std::to_string(source.size()) + " floats as vertices of " + std::to_string(vertex_length);
+        else if (formats.position == format::unorm8 || formats.tex_coord == format::unorm8 || formats.normal == format::unorm8)
+            error_str = "Only colors can be quantized to format::unorm8";
+        else if (formats.position == format::snorm_10_10_10_2 || formats.color == format::snorm_10_10_10_2
+                 || formats.tex_coord == format::snorm_10_10_10_2)
+            error_str = "Only normals can be quantized to format::snorm_10_10_10_2";
+        if (!error_str.empty())
+        {
+            std::cerr << error_str << std::endl;
+            throw std::invalid_argument{error_str};
+        }
+
+        vertices result;
+        result.normal_location = formats.normal_location;
+        // the attributes the vertices have, where they are in a source vertex, and their maximum error
+        struct { attribute& quantized; format type; unsigned int components; unsigned int source_offset; float& error; } attributes[] = {
+            { result.position,  formats.position,  3, 0, result.stats.position_error },
+            { result.color,     formats.color,     4, 3, result.stats.color_error },
+            { result.tex_coord, formats.tex_coord, 2, 7, result.stats.tex_coord_error },
+            { result.normal,    formats.normal,    3, 9, result.stats.normal_error },
+        };
+        for (auto& a : attributes)
+            if (a.source_offset < vertex_length)
+            {
+                a.quantized = { a.type, a.components, result.stride };
+                // every attribute starts at a multiple of 4 bytes, like VertexLayout::add()
+                result.stride = (result.stride + size_of(a.type, a.components) + 3) / 4 * 4;
+            }
+
+        const size_t vertex_count = source.size() / vertex_length;
+        result.data.resize(vertex_count * result.stride);
+        for (size_t v = 0; v < vertex_count; v++)
+        {
+            const float* in = source.data() + v * vertex_length;
+            std::byte* out = result.data.data() + v * result.stride;
+            for (auto& a : attributes)
+                if (a.source_offset < vertex_length)
+                    a.error = std::max(a.error, encode(a.type, in + a.source_offset, a.components, out + a.quantized.offset));
+        }
+
+        result.stats.vertices = vertex_count;
+        result.stats.source_bytes = source.size_bytes();
+        result.stats.bytes = result.data.size();
+        return result;
+    }
+}
+
+
+std::ostream& operator<<(std::ostream& os, const vertex_quantize::stats& stats)
+{
+    os << "vertex quantization: " << stats.vertices << " vertices, " << stats.source_bytes << " -> " << stats.bytes << " bytes ("
+       << std::lround(stats.saved() * 100) << "% saved), largest error: position " << stats.position_error
+       << ", color " << stats.color_error << ", tex_coord " << stats.tex_coord_error << ", normal " << stats.normal_error << '\n';
+    return os;
+}
@@ -0,0 +1,100 @@
+#ifndef OPENGL_BAKED_TEXTURE_H
+#define OPENGL_BAKED_TEXTURE_H
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "glad/glad.h"
+#include "pixel-ops.h"
+
+/// Container for textures that are ready to upload, made offline by the texture_baker tool (src/tools/texture-baker.cpp):
+///     texture_baker res/heart.png           # writes res/heart.gltx
+///     Texture heart{ baked_texture::file{ Resource_Path"/heart.gltx" } };
+/// The file has the whole mip chain, already converted to the upload format (RGBA, unsigned bytes, rows bottom to top),
+/// so loading it is mapping the file and passing the mapped pages to glTexImage2D: no decoding, no copy, no glGenerateMipmap.
+///
+/// Layout (little endian):
+///     header                          32 bytes
+///     level[header.levels]            24 bytes each, largest first
+///     pixels of each level            at level.offset, aligned to 64 bytes
+
+namespace baked_texture
+{
+    constexpr char magic[4] = { 'G', 'L', 'T', 'X' };
+    constexpr std::uint32_t version = 1;
+    //! @brief File extension the baker writes, and that TextureRegistry recognizes
+    constexpr std::string_view extension = ".gltx";
+
+    struct header
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        //! @brief glTexImage2D format and type of every level
+        std::uint32_t format;
+        std::uint32_t type;
+        std::uint32_t levels;
+        std::uint32_t reserved;
+    };
+    struct level
+    {
+        //! @brief From the start of the file
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint32_t width;
+        std::uint32_t height;
+    };
+    static_assert(sizeof(header) == 32 && sizeof(level) == 24);
+
+    //! @brief How bake() prepares the pixels (see pixel-ops.h)
+    struct options
+    {
+        pixel_ops::mip_filter mipmaps = pixel_ops::mip_filter::box;
+        //! @brief Average the colors of the mipmaps in linear light
+        bool srgb = true;
+        bool premultiply_alpha = false;
+    };
+
+    /*! @brief Make the container of an image: convert it to RGBA and compute every mipmap level down to 1x1.
+     *  @param pixels rows in the order they should be uploaded, @param channels bytes per pixel (1 to 4) */
+    [[nodiscard]] std::vector<unsigned char> bake(const unsigned char* pixels, int width, int height, int channels, options opts={});
+
+    //! @brief Whether @param path has the baked texture extension
+    [[nodiscard]] bool is_baked(std::string_view path);
+
+    //! @brief A container mapped in memory (read-only). The pixels are only read from disk when they are used
+    class file {
+    public:
+        //! @brief Map and check the file at @param path. Throws std::invalid_argument if it can't be mapped or isn't a container
+        explicit file(const char* path);
+        ~file();
+        file(const file&) = delete;
+        file& operator=(const file&) = delete;
+
+        [[nodiscard]] int width() const { return (int) this->head->width; }
+        [[nodiscard]] int height() const { return (int) this->head->height; }
+        [[nodiscard]] GLenum format() const { return this->head->format; }
+        [[nodiscard]] GLenum type() const { return this->head->type; }
+        [[nodiscard]] size_t level_count() const { return this->head->levels; }
+        [[nodiscard]] const level& level_info(size_t i) const;
+        //! @brief Mapped pixels of level @param i
+        [[nodiscard]] const unsigned char* pixels(size_t i) const;
+
+        [[nodiscard]] size_t size() const { return this->length; }
+
+    private:
+        const unsigned char* data = nullptr;
+        size_t length = 0;
+        const header* head = nullptr;
+        const level* levels = nullptr;
+#ifdef _WIN32
+        void* mapping = nullptr;
+#endif
+
+        void unmap();
+    };
+}
+
+
+#endif //OPENGL_BAKED_TEXTURE_H
@@ -0,0 +1,114 @@
+#ifndef OPENGL_BATCH_RENDERER_H
+#define OPENGL_BATCH_RENDERER_H
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "gl-state.h"
+#include "shader-program.h"
+#include "texture.h"
+#include "texture-atlas.h"
+
+/// Draws many quads and triangles with few draw calls, instead of one primitive::Shape2D (and one glDrawElements) each.
+///     BatchRenderer batch;
+///     batch.set_shader(basic.get(shader_feature::vertex_color | shader_feature::textured | shader_feature::texture_slots));
+///     for (const sprite& s : sprites)
+///         batch.quad(s.x, s.y, s.width, s.height, s.color, atlas.page(s.region.page), s.region);
+///     batch.quad(-1, -1, 0.5f, 0.5f, { 1, 0, 0, 1 });   // untextured
+///     batch.end_frame();                              // draws what's left
+/// Primitives are added to one vertex buffer on the CPU, which is uploaded and drawn with one glDrawElements
+/// when something forces it (flush()): another shader, a 9th texture, a full buffer, or the end of the frame.
+/// Each vertex has the slot (0 to 7) of its texture, so up to texture_slots textures are drawn together;
+/// they are bound to texture units 0 to 7 when the batch is drawn. Primitives without a texture use a white one.
+/// The shader must have the VERTEX_COLOR, TEXTURED and TEXTURE_SLOTS features (see shader-variants.h).
+/// Primitives are drawn in the order they were added. Set uniforms of the shader before adding primitives, or flush() first.
+
+//! @brief A vertex of a batch: the layout of primitive::Shape2D's vertices, plus the texture slot
+struct batch_vertex
+{
+    float position[3];
+    float color[4];
+    float tex_coord[2];
+    //! @brief Set by BatchRenderer
+    float texture_slot;
+};
+
+class BatchRenderer {
+public:
+    //! @brief Textures a batch can use. The size of texture_data in the TEXTURE_SLOTS shaders
+    static constexpr size_t texture_slots = 8;
+
+    struct stats
+    {
+        //! @brief Draw calls (one per batch)
+        size_t batches   = 0;
+        size_t quads     = 0;
+        size_t triangles = 0;
+        size_t vertices  = 0;
+        //! @brief Why batches were drawn before the end of the frame (or an explicit flush())
+        size_t shader_breaks  = 0;
+        size_t texture_breaks = 0;
+        size_t full_breaks    = 0;
+        //! @brief Bytes uploaded to the vertex and element buffers
+        size_t bytes     = 0;
+
+        stats& operator+=(const stats& other);
+    };
+
+    //! @brief @param max_vertices is the size of the buffers. A batch that would have more is drawn in parts
+    explicit BatchRenderer(size_t max_vertices = 4 * 4096);
+    //! @brief Deletes the buffers. Destroy before the context (glfwTerminate())
+    ~BatchRenderer();
+    // the GL objects have one owner
+    BatchRenderer(const BatchRenderer&) = delete;
+    BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+    //! @brief Draw what comes next with @param shader. Draws the batch first if it was another shader
+    void set_shader(ShaderProgram& shader);
+
+    /*! @brief Add a rectangle from (@param x, @param y) (bottom left) to (x + @param width, y + @param height), multiplied by
+     *         @param color, showing the part of @param texture (gl_texture, 0 for none) from @param uv_min to @param uv_max */
+    void quad(float x, float y, float width, float height, vec4<float> color, GLuint texture=0,
+              vec2<float> uv_min={ 0, 0 }, vec2<float> uv_max={ 1, 1 });
+    //! @brief Add a rectangle showing the image of @param region, in @param page (atlas.page(region.page))
+    void quad(float x, float y, float width, float height, vec4<float> color, const Texture& page, const atlas_region& region);
+    /*! @brief Add a quad from its 4 @param vertices, in Shape2D's order: top left, bottom left, top right, bottom right.
+     *         Their texture_slot is ignored */
+    void quad(const std::array<batch_vertex, 4>& vertices, GLuint texture=0);
+    //! @brief Add a triangle. The texture_slot of @param vertices is ignored
+    void triangle(const std::array<batch_vertex, 3>& vertices, GLuint texture=0);
+
+    //! @brief Draw the batch (if it has anything) and start a new one
+    void flush();
+    //! @brief Draw the batch and finish the frame. @return its stats
+    stats end_frame();
+    //! @brief Stats of the frame in progress (since the last end_frame())
+    [[nodiscard]] const stats& frame() const { return this->current; }
+
+private:
+    std::vector<batch_vertex> vertices;
+    std::vector<unsigned int> indices;
+    size_t max_vertices;
+    //! @brief Textures of the batch, in slot order
+    std::vector<GLuint> textures;
+    ShaderProgram* shader = nullptr;
+    UniformHandle texture_data;
+
+    unsigned int vertex_array{};
+    unsigned int vertex_buffer{};
+    unsigned int element_buffer{};
+    //! @brief 1x1 white, for primitives without a texture
+    Texture white;
+
+    stats current;
+
+    //! @brief Slot of @param texture in the batch. Draws the batch first if it is full of other textures
+    float slot_of(GLuint texture);
+    //! @brief Make room for @param count more vertices. Draws the batch first if they don't fit
+    void reserve(size_t count);
+};
+
+std::ostream& operator<<(std::ostream& os, const BatchRenderer::stats& stats);
+
+
+#endif //OPENGL_BATCH_RENDERER_H
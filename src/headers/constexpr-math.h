@@ -0,0 +1,65 @@
+#ifndef OPENGL_CONSTEXPR_MATH_H
+#define OPENGL_CONSTEXPR_MATH_H
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+/// <cmath> functions that can also run at compile time (std::sqrt, std::sin, etc. only become constexpr in C++26).
+/// At runtime they forward to <cmath>, so there is no cost to using them in normal code.
+namespace constexpr_math
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    constexpr double sqrt(double x)
+    {
+        if (!std::is_constant_evaluated())
+            return std::sqrt(x);
+        if (x < 0 || x != x)
+            return std::numeric_limits<double>::quiet_NaN(); // like std::sqrt
+        if (x == 0 || x == std::numeric_limits<double>::infinity())
+            return x;
+
+        // Newton's method. Converges quadratically from any starting point above the root
+        double guess = x < 1 ? 1 : x;
+        for (double prev = 0; guess != prev; )
+        {
+            prev  = guess;
+            guess = 0.5 * (guess + x / guess);
+            if (guess >= prev) // reached the root (can oscillate by 1 ulp)
+                return prev;
+        }
+        return guess;
+    }
+
+    //! @brief @param x angle in radians
+    constexpr double sin(double x)
+    {
+        if (!std::is_constant_evaluated())
+            return std::sin(x);
+
+        // reduce to [-pi, pi], where the Taylor series converges fast
+        const double turns = (double) (long long) (x / (2 * pi));
+        x -= turns * 2 * pi;
+        if (x >  pi) x -= 2 * pi;
+        if (x < -pi) x += 2 * pi;
+
+        double term = x, sum = x;
+        for (int n = 1; n < 16; n++)
+        {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum  += term;
+        }
+        return sum;
+    }
+
+    //! @brief @param x angle in radians
+    constexpr double cos(double x)
+    {
+        if (!std::is_constant_evaluated())
+            return std::cos(x);
+        return constexpr_math::sin(x + pi / 2);
+    }
+}
+
+
+#endif //OPENGL_CONSTEXPR_MATH_H
@@ -0,0 +1,176 @@
+#ifndef OPENGL_GL_BACKEND_H
+#define OPENGL_GL_BACKEND_H
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include "glad/glad.h"
+
+/// Swaps glad's function pointers for wrappers that count every call, so rendering code
+/// (ShaderProgram, Texture, primitive::Shape2D, the render loop) can be instrumented or run without a GPU.
+///     gl_backend::install(gl_backend::mode::null);  // no context needed. Every call is counted, then ignored
+///     ... draw a frame ...
+///     gl_backend::frame_stats stats = gl_backend::end_frame();
+/// In recording mode (after gladLoadGLLoader) the calls are counted and then forwarded to the driver.
+
+/*! @brief Every GL function the backend intercepts: X(kind, return type, name, (parameters), (arguments)).
+ *         kind is how the call affects the stats (see gl_backend::frame_stats):
+ *         state (changes GL state), other, or a draw/upload function that is measured on its own.
+ *         pixel_store is a state change that also sets how the uploads after it are measured
+ *         Any GL function the rendering code starts using must be added here, or it will be null in null mode */
+#define OPENGL_GL_FUNCTIONS(X) \
+    X(state,            void,           glActiveTexture,           (GLenum texture), (texture)) \
+    X(other,            void,           glAttachShader,            (GLuint program, GLuint shader), (program, shader)) \
+    X(state,            void,           glBindBuffer,              (GLenum target, GLuint buffer), (target, buffer)) \
+    X(state,            void,           glBindSampler,             (GLuint unit, GLuint sampler), (unit, sampler)) \
+    X(state,            void,           glBindTexture,             (GLenum target, GLuint texture), (target, texture)) \
+    X(state,            void,           glBindVertexArray,         (GLuint array), (array)) \
+    X(state,            void,           glBlendFunc,               (GLenum sfactor, GLenum dfactor), (sfactor, dfactor)) \
+    X(buffer_data,      void,           glBufferData,              (GLenum target, GLsizeiptr size, const void* data, GLenum usage), (target, size, data, usage)) \
+    X(buffer_sub_data,  void,           glBufferSubData,           (GLenum target, GLintptr offset, GLsizeiptr size, const void* data), (target, offset, size, data)) \
+    X(other,            void,           glClear,                   (GLbitfield mask), (mask)) \
+    X(state,            void,           glClearColor,              (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha)) \
+    X(other,            void,           glCompileShader,           (GLuint shader), (shader)) \
+    X(other,            GLuint,         glCreateProgram,           (), ()) \
+    X(other,            GLuint,         glCreateShader,            (GLenum type), (type)) \
+    X(other,            void,           glDeleteBuffers,           (GLsizei n, const GLuint* buffers), (n, buffers)) \
+    X(other,            void,           glDeleteProgram,           (GLuint program), (program)) \
+    X(other,            void,           glDeleteSamplers,          (GLsizei n, const GLuint* samplers), (n, samplers)) \
+    X(other,            void,           glDeleteShader,            (GLuint shader), (shader)) \
+    X(other,            void,           glDeleteTextures,          (GLsizei n, const GLuint* textures), (n, textures)) \
+    X(other,            void,           glDeleteVertexArrays,      (GLsizei n, const GLuint* arrays), (n, arrays)) \
+    X(state,            void,           glDisable,                 (GLenum cap), (cap)) \
+    X(draw_arrays,      void,           glDrawArrays,              (GLenum mode, GLint first, GLsizei count), (mode, first, count)) \
+    X(draw_elements,    void,           glDrawElements,            (GLenum mode, GLsizei count, GLenum type, const void* indices), (mode, count, type, indices)) \
+    X(draw_instanced,   void,           glDrawElementsInstanced,   (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount), (mode, count, type, indices, instancecount)) \
+    X(state,            void,           glEnable,                  (GLenum cap), (cap)) \
+    X(state,            void,           glEnableVertexAttribArray, (GLuint index), (index)) \
+    X(other,            void,           glFinish,                  (), ()) \
+    X(other,            void,           glGenBuffers,              (GLsizei n, GLuint* buffers), (n, buffers)) \
+    X(other,            void,           glGenSamplers,             (GLsizei n, GLuint* samplers), (n, samplers)) \
+    X(other,            void,           glGenTextures,             (GLsizei n, GLuint* textures), (n, textures)) \
+    X(other,            void,           glGenVertexArrays,         (GLsizei n, GLuint* arrays), (n, arrays)) \
+    X(other,            void,           glGenerateMipmap,          (GLenum target), (target)) \
+    X(other,            void,           glGetActiveUniform,        (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name), (program, index, bufSize, length, size, type, name)) \
+    X(other,            GLenum,         glGetError,                (), ()) \
+    X(other,            void,           glGetIntegerv,             (GLenum pname, GLint* data), (pname, data)) \
+    X(other,            void,           glGetProgramInfoLog,       (GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog), (program, bufSize, length, infoLog)) \
+    X(other,            void,           glGetProgramiv,            (GLuint program, GLenum pname, GLint* params), (program, pname, params)) \
+    X(other,            void,           glGetShaderInfoLog,        (GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog), (shader, bufSize, length, infoLog)) \
+    X(other,            void,           glGetShaderiv,             (GLuint shader, GLenum pname, GLint* params), (shader, pname, params)) \
+    X(other,            const GLubyte*, glGetString,               (GLenum name), (name)) \
+    X(other,            const GLubyte*, glGetStringi,              (GLenum name, GLuint index), (name, index)) \
+    X(other,            GLint,          glGetUniformLocation,      (GLuint program, const GLchar* name), (program, name)) \
+    X(other,            void,           glGetUniformfv,            (GLuint program, GLint location, GLfloat* params), (program, location, params)) \
+    X(other,            void,           glGetUniformiv,            (GLuint program, GLint location, GLint* params), (program, location, params)) \
+    X(other,            void,           glGetUniformuiv,           (GLuint program, GLint location, GLuint* params), (program, location, params)) \
+    X(other,            void,           glLinkProgram,             (GLuint program), (program)) \
+    X(other,            void*,          glMapBufferRange,          (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access), (target, offset, length, access)) \
+    X(pixel_store,      void,           glPixelStorei,             (GLenum pname, GLint param), (pname, param)) \
+    X(state,            void,           glPolygonMode,             (GLenum face, GLenum mode), (face, mode)) \
+    X(state,            void,           glSamplerParameterfv,      (GLuint sampler, GLenum pname, const GLfloat* params), (sampler, pname, params)) \
+    X(state,            void,           glSamplerParameteri,       (GLuint sampler, GLenum pname, GLint param), (sampler, pname, param)) \
+    X(state,            void,           glScissor,                 (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height)) \
+    X(other,            void,           glShaderSource,            (GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length), (shader, count, string, length)) \
+    X(tex_image_2d,     void,           glTexImage2D,              (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalformat, width, height, border, format, type, pixels)) \
+    X(tex_image_3d,     void,           glTexImage3D,              (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalformat, width, height, depth, border, format, type, pixels)) \
+    X(state,            void,           glTexParameterf,           (GLenum target, GLenum pname, GLfloat param), (target, pname, param)) \
+    X(state,            void,           glTexParameterfv,          (GLenum target, GLenum pname, const GLfloat* params), (target, pname, params)) \
+    X(state,            void,           glTexParameteri,           (GLenum target, GLenum pname, GLint param), (target, pname, param)) \
+    X(tex_sub_image_2d, void,           glTexSubImage2D,           (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels), (target, level, xoffset, yoffset, width, height, format, type, pixels)) \
+    X(tex_sub_image_3d, void,           glTexSubImage3D,           (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels), (target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels)) \
+    X(state,            void,           glUniform1f,               (GLint location, GLfloat v0), (location, v0)) \
+    X(state,            void,           glUniform1fv,              (GLint location, GLsizei count, const GLfloat* value), (location, count, value)) \
+    X(state,            void,           glUniform1i,               (GLint location, GLint v0), (location, v0)) \
+    X(state,            void,           glUniform1iv,              (GLint location, GLsizei count, const GLint* value), (location, count, value)) \
+    X(state,            void,           glUniform1uiv,             (GLint location, GLsizei count, const GLuint* value), (location, count, value)) \
+    X(state,            void,           glUniform2f,               (GLint location, GLfloat v0, GLfloat v1), (location, v0, v1)) \
+    X(state,            void,           glUniform2fv,              (GLint location, GLsizei count, const GLfloat* value), (location, count, value)) \
+    X(state,            void,           glUniform2iv,              (GLint location, GLsizei count, const GLint* value), (location, count, value)) \
+    X(state,            void,           glUniform2uiv,             (GLint location, GLsizei count, const GLuint* value), (location, count, value)) \
+    X(state,            void,           glUniform3f,               (GLint location, GLfloat v0, GLfloat v1, GLfloat v2), (location, v0, v1, v2)) \
+    X(state,            void,           glUniform3fv,              (GLint location, GLsizei count, const GLfloat* value), (location, count, value)) \
+    X(state,            void,           glUniform3iv,              (GLint location, GLsizei count, const GLint* value), (location, count, value)) \
+    X(state,            void,           glUniform3uiv,             (GLint location, GLsizei count, const GLuint* value), (location, count, value)) \
+    X(state,            void,           glUniform4f,               (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3), (location, v0, v1, v2, v3)) \
+    X(state,            void,           glUniform4fv,              (GLint location, GLsizei count, const GLfloat* value), (location, count, value)) \
+    X(state,            void,           glUniform4iv,              (GLint location, GLsizei count, const GLint* value), (location, count, value)) \
+    X(state,            void,           glUniform4uiv,             (GLint location, GLsizei count, const GLuint* value), (location, count, value)) \
+    X(state,            void,           glUniformMatrix2fv,        (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value)) \
+    X(state,            void,           glUniformMatrix3fv,        (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value)) \
+    X(state,            void,           glUniformMatrix4fv,        (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value)) \
+    X(other,            GLboolean,      glUnmapBuffer,             (GLenum target), (target)) \
+    X(state,            void,           glUseProgram,              (GLuint program), (program)) \
+    X(state,            void,           glVertexAttribDivisor,     (GLuint index, GLuint divisor), (index, divisor)) \
+    X(state,            void,           glVertexAttribPointer,     (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer), (index, size, type, normalized, stride, pointer)) \
+    X(state,            void,           glViewport,                (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height))
+
+
+namespace gl_backend
+{
+    //! @brief One entry per intercepted function, in the order of OPENGL_GL_FUNCTIONS
+    enum class function : unsigned short
+    {
+#define OPENGL_GL_ENUM(kind, ret, name, params, args) name,
+        OPENGL_GL_FUNCTIONS(OPENGL_GL_ENUM)
+#undef OPENGL_GL_ENUM
+    };
+#define OPENGL_GL_COUNT(kind, ret, name, params, args) + 1
+    constexpr size_t function_count = 0 OPENGL_GL_FUNCTIONS(OPENGL_GL_COUNT);
+#undef OPENGL_GL_COUNT
+
+    enum class mode
+    {
+        //! @brief No OpenGL context. Calls are counted and do nothing. Functions that return something
+        //!        return plausible values (new ids, successful compiles, GL_NO_ERROR, memory for mapped buffers)
+        null,
+        //! @brief Calls are counted, then forwarded to the real functions loaded by glad. Needs a context
+        recording,
+    };
+
+    struct frame_stats
+    {
+        //! @brief All intercepted calls
+        size_t calls          = 0;
+        //! @brief Calls to functions that change GL state (binds, glUseProgram, uniforms, glTexParameter, etc.)
+        size_t state_changes  = 0;
+        size_t draw_calls     = 0;
+        //! @brief Vertices processed by draw calls (the count of glDrawArrays/glDrawElements, times the instances of glDrawElementsInstanced)
+        size_t vertices       = 0;
+        //! @brief Bytes sent to buffers and textures (glBufferData, glTexImage2D/3D and their Sub versions)
+        size_t bytes_uploaded = 0;
+        //! @brief Number of calls to each function. Index with (size_t) gl_backend::function
+        std::array<size_t, function_count> per_function{};
+
+        [[nodiscard]] size_t count(function f) const { return this->per_function[(size_t) f]; }
+        frame_stats& operator+=(const frame_stats& other);
+    };
+
+    //! @brief Start intercepting GL calls. Replaces the backend that is already installed, if any
+    void install(mode m);
+    //! @brief Put back the function pointers that were there before install()
+    void uninstall();
+    [[nodiscard]] bool installed();
+    [[nodiscard]] mode current_mode();
+
+    //! @brief Stats of the frame in progress (since the last end_frame() or install())
+    [[nodiscard]] const frame_stats& frame();
+    //! @brief Finish the frame in progress. @return its stats
+    frame_stats end_frame();
+    //! @brief Stats of every frame since install(), including the one in progress
+    [[nodiscard]] frame_stats totals();
+    //! @brief Number of frames finished with end_frame()
+    [[nodiscard]] size_t frame_count();
+
+    //! @brief e.g. "glDrawElements"
+    const char* function_name(function f);
+
+    /*! @brief Bytes in a @param width x @param height image of the given format and type (only common formats).
+     *  @param row_alignment GL_UNPACK_ALIGNMENT: every row but the last is padded to a multiple of it */
+    size_t image_size(GLsizei width, GLsizei height, GLenum format, GLenum type, GLint row_alignment=1);
+}
+
+//! @brief Summary of the stats, plus the calls to every function that was called
+std::ostream& operator<<(std::ostream& os, const gl_backend::frame_stats& stats);
+
+
+#endif //OPENGL_GL_BACKEND_H
@@ -0,0 +1,63 @@
+#ifndef OPENGL_GL_STATE_H
+#define OPENGL_GL_STATE_H
+#include <cstddef>
+#include <iostream>
+#include "glad/glad.h"
+
+/// Shadow copy of the bindings that change the most (program, textures and samplers per unit, vertex array, buffers),
+/// so binding something that is already bound doesn't reach the driver.
+/// ShaderProgram, Texture, SamplerCache and primitive::Shape2D bind through here. Code that calls glUseProgram, glBindTexture,
+/// glActiveTexture, glBindSampler, glBindVertexArray or glBindBuffer directly must call gl_state::invalidate() afterwards.
+
+namespace gl_state
+{
+    //! @brief Texture units that are tracked. Binds to higher units always reach GL
+    constexpr size_t max_texture_units = 32;
+
+    //! @brief How many calls were skipped because they would not have changed anything
+    struct stats
+    {
+        size_t programs_skipped        = 0;
+        size_t active_textures_skipped = 0;
+        size_t textures_skipped        = 0;
+        size_t samplers_skipped        = 0;
+        size_t vertex_arrays_skipped   = 0;
+        size_t buffers_skipped         = 0;
+        //! @brief Calls that did reach GL
+        size_t issued                  = 0;
+
+        [[nodiscard]] size_t skipped() const
+        {
+            return this->programs_skipped + this->active_textures_skipped + this->textures_skipped
+                 + this->samplers_skipped + this->vertex_arrays_skipped + this->buffers_skipped;
+        }
+    };
+
+    void use_program(GLuint program);
+    //! @brief @param unit GL_TEXTURE0 + i
+    void active_texture(GLenum unit);
+    //! @brief Bind @param texture to the active texture unit
+    void bind_texture(GLenum target, GLuint texture);
+    //! @brief Bind @param sampler to texture unit @param unit (0, 1, ..., not GL_TEXTURE0 + i). 0 unbinds it
+    void bind_sampler(GLuint unit, GLuint sampler);
+    void bind_vertex_array(GLuint array);
+    void bind_buffer(GLenum target, GLuint buffer);
+
+    // -- deleting a bound object unbinds it, so the cache has to know about it
+    void delete_program(GLuint program);
+    void delete_textures(GLsizei n, const GLuint* textures);
+    void delete_samplers(GLsizei n, const GLuint* samplers);
+    void delete_vertex_arrays(GLsizei n, const GLuint* arrays);
+    void delete_buffers(GLsizei n, const GLuint* buffers);
+
+    //! @brief Forget everything, so the next bind of each kind always reaches GL (e.g. after making another context current)
+    void invalidate();
+
+    [[nodiscard]] const stats& counters();
+    void reset_counters();
+}
+
+std::ostream& operator<<(std::ostream& os, const gl_state::stats& stats);
+
+
+#endif //OPENGL_GL_STATE_H
@@ -0,0 +1,161 @@
+#ifndef OPENGL_GL_TRACE_H
+#define OPENGL_GL_TRACE_H
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include "gl-backend.h"
+
+/// Capture of GL calls into a binary trace file, and replay of that file (see src/tools/gl-replay.cpp).
+///     gl_backend::install(gl_backend::mode::recording);
+///     gl_trace::start_capture("frame.gltrace");
+///     ... draw frames (gl_backend::end_frame() after each) ...
+///     gl_trace::stop_capture();
+/// Every call that goes through gl_backend is written with its arguments, including the data behind pointers
+/// (buffer contents, pixels, shader sources, uniform matrices), so the trace can be replayed without the application.
+///
+/// File layout (little endian): "GLTRACE" 0, u32 version, u32 function count, the function names (u8 length + chars),
+/// then records. A record is a u16 function index followed by its arguments and its return value (u64, if it returns a number).
+/// Numbers are written with their own size. Pointers start with a u8 pointer_kind, then u64 offset or u32 size + data
+/// (data is padded to 8 bytes). Function 0xFFFF marks the end of a frame.
+/// Pixel pointers are offsets while a GL_PIXEL_UNPACK_BUFFER is bound. What was written to a mapped buffer
+/// (glMapBufferRange) is stored after the glUnmapBuffer record that ends the mapping (u32 size + data).
+
+namespace gl_trace
+{
+    //! @brief How the data behind a pointer argument is stored in the trace
+    enum class pointer_kind : unsigned char
+    {
+        //! @brief nullptr, or a pointer that is not needed for replay
+        null,
+        //! @brief Offset into a bound buffer (e.g. the indices of glDrawElements with an element buffer)
+        offset,
+        //! @brief Data read by the function (e.g. glBufferData's data)
+        input,
+        //! @brief Data written by the function (e.g. glGenBuffers' ids). Stored as it was after the call
+        output,
+        //! @brief Array of strings (glShaderSource)
+        strings,
+    };
+
+    // -- capture
+    /*! @brief Write every GL call that goes through gl_backend to @param filename, until stop_capture().
+     *         gl_backend must be installed (in either mode). Throws std::invalid_argument if the file can't be created */
+    void start_capture(const char* filename);
+    void stop_capture();
+    [[nodiscard]] bool capturing();
+
+
+    namespace detail
+    {
+        //! @brief Write a call to the trace. Pointers are in @param slots as integers; @param sizes is 0 for pointers
+        void record(gl_backend::function f, const std::uint64_t* slots, const unsigned char* sizes, size_t count,
+                    const std::uint64_t* result, unsigned char result_size);
+        void record_end_frame();
+        //! @brief Called before the GL function, for what has to be read before it runs (the mapped range of glUnmapBuffer)
+        void prepare(gl_backend::function f, const std::uint64_t* slots);
+
+        //! @brief Store any argument in a 64 bit slot, without changing its bits
+        template<typename Type>
+        std::uint64_t to_slot(Type val)
+        {
+            std::uint64_t slot = 0;
+            if constexpr (std::is_pointer_v<Type>)
+                slot = (std::uint64_t) (std::uintptr_t) val;
+            else
+                std::memcpy(&slot, &val, sizeof(Type));
+            return slot;
+        }
+
+        template<typename Type>
+        Type from_slot(std::uint64_t slot)
+        {
+            if constexpr (std::is_pointer_v<Type>)
+                return (Type) (std::uintptr_t) slot;
+            else
+            {
+                Type val;
+                std::memcpy(&val, &slot, sizeof(Type));
+                return val;
+            }
+        }
+
+        template<typename Type>
+        constexpr unsigned char slot_size() { return std::is_pointer_v<Type> ? 0 : sizeof(Type); }
+
+        //! @brief Calls a GL function and records the call. See gl_trace::capture()
+        template<typename Ret, typename... Args>
+        struct call_recorder
+        {
+            gl_backend::function f;
+            Ret (APIENTRYP fn)(Args...);
+
+            Ret operator()(Args... args) const
+            {
+                static constexpr std::array<unsigned char, sizeof...(Args)> sizes{ slot_size<Args>()... };
+                const std::array<std::uint64_t, sizeof...(Args)> slots{ to_slot(args)... };
+                prepare(this->f, slots.data());
+                if constexpr (std::is_void_v<Ret>)
+                {
+                    this->fn(args...);
+                    record(this->f, slots.data(), sizes.data(), slots.size(), nullptr, 0);
+                }
+                else
+                {
+                    // outputs (e.g. generated ids) are recorded after the call
+                    const Ret result = this->fn(args...);
+                    const std::uint64_t result_slot = to_slot(result);
+                    record(this->f, slots.data(), sizes.data(), slots.size(), &result_slot, slot_size<Ret>());
+                    return result;
+                }
+            }
+        };
+    }
+
+    //! @brief Used by gl_backend's wrappers: gl_trace::capture(f, fn)(args...) calls fn(args...) and records it
+    template<typename Ret, typename... Args>
+    detail::call_recorder<Ret, Args...> capture(gl_backend::function f, Ret (APIENTRYP fn)(Args...)) { return { f, fn }; }
+
+
+    // -- replay
+    struct call_timing
+    {
+        size_t calls = 0;
+        double total_ns = 0;
+    };
+
+    //! @brief A trace loaded into memory, ready to be replayed any number of times
+    class replayer
+    {
+    public:
+        //! @brief Load and decode a trace. Throws std::invalid_argument if the file is not a trace or uses unknown functions
+        explicit replayer(const char* filename);
+        ~replayer();
+
+        //! @brief Number of frames in the trace (calls after the last end_frame() count as a frame)
+        [[nodiscard]] size_t frame_count() const;
+        /*! @brief Whether the last frame has no end_frame(): calls made after the last frame (e.g. deleting objects),
+         *         which shouldn't be replayed more than once */
+        [[nodiscard]] bool last_frame_partial() const;
+        //! @brief Number of calls in frame @param i
+        [[nodiscard]] size_t call_count(size_t i) const;
+
+        /*! @brief Make all calls of frame @param i through glad's function pointers (a real context or gl_backend).
+         *         Object ids and uniform locations from the trace are mapped to the ones created during replay,
+         *         so frames that create objects must be replayed before the frames that use them.
+         *  @return nanoseconds spent in GL calls */
+        double play_frame(size_t i);
+
+        //! @brief Time spent in each function since construction (or reset_timings()). Index with (size_t) gl_backend::function
+        [[nodiscard]] const std::array<call_timing, gl_backend::function_count>& timings() const;
+        void reset_timings();
+
+    private:
+        struct state;
+        std::unique_ptr<state> s;
+    };
+}
+
+
+#endif //OPENGL_GL_TRACE_H
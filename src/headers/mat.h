@@ -0,0 +1,165 @@
+#ifndef OPENGL_MAT_H
+#define OPENGL_MAT_H
+#include <array>
+#include "vec.h"
+#include "vec-stream.h"
+
+/// Square matrices built from column vecs. Storage is column-major, like OpenGL expects,
+/// so m[col][row] is the element at (row, col) and mat4<float>::data() can be passed to glUniformMatrix4fv.
+
+template<typename Type> struct mat2;
+template<typename Type> struct mat3;
+template<typename Type> struct mat4;
+
+template<typename Type> std::ostream& operator<<(std::ostream&, const mat2<Type>&);
+template<typename Type> std::ostream& operator<<(std::ostream&, const mat3<Type>&);
+template<typename Type> std::ostream& operator<<(std::ostream&, const mat4<Type>&);
+
+
+template<typename Type>
+struct mat2
+{
+    static_assert(std::is_arithmetic_v<Type>, "mat2 components must be numbers (char, int, float, etc..)");
+    std::array<vec2<Type>, 2> cols;
+
+    //! @brief Matrix with @param diag on the diagonal and 0 everywhere else
+    explicit mat2(Type diag=1) : cols{ vec2<Type>{ diag, 0 }, vec2<Type>{ 0, diag } } {  }
+    mat2(const vec2<Type>& c0, const vec2<Type>& c1) : cols{ c0, c1 } {  }
+
+    static mat2 identity() { return mat2{ 1 }; }
+    //! @brief Counter-clockwise rotation of @param angle radians
+    static mat2 rotation(Type angle) requires std::is_floating_point_v<Type>;
+    static mat2 scaling(const vec2<Type>& s);
+
+    //! @brief For printing a mat2 object
+    friend std::ostream& operator<<<Type>(std::ostream&, const mat2<Type>&);
+
+    //! @brief Get the ith column of this matrix
+    vec2<Type>&       operator[](unsigned char i);
+    const vec2<Type>& operator[](unsigned char i) const;
+
+    [[nodiscard]] mat2 transposed() const;
+    [[nodiscard]] Type determinant() const;
+    //! @brief Throws std::domain_error if the matrix is singular
+    [[nodiscard]] mat2 inverse() const requires std::is_floating_point_v<Type>;
+
+    mat2       operator*(const mat2& other)     const;
+    vec2<Type> operator*(const vec2<Type>& v)   const;
+    mat2       operator*(Type val)              const;
+
+    //! @brief The components in column-major order (for glUniformMatrix2fv)
+    [[nodiscard]] std::array<Type, 2*2> to_array() const;
+};
+
+
+template<typename Type>
+struct mat3
+{
+    static_assert(std::is_arithmetic_v<Type>, "mat3 components must be numbers (char, int, float, etc..)");
+    std::array<vec3<Type>, 3> cols;
+
+    //! @brief Matrix with @param diag on the diagonal and 0 everywhere else
+    explicit mat3(Type diag=1) : cols{ vec3<Type>{ diag, 0, 0 }, vec3<Type>{ 0, diag, 0 }, vec3<Type>{ 0, 0, diag } } {  }
+    mat3(const vec3<Type>& c0, const vec3<Type>& c1, const vec3<Type>& c2) : cols{ c0, c1, c2 } {  }
+    //! @brief Upper left 3x3 of a mat4 (drops translation)
+    explicit mat3(const mat4<Type>& m);
+
+    static mat3 identity() { return mat3{ 1 }; }
+    // -- 2D transforms in homogeneous coordinates (x, y, 1)
+    static mat3 translation(const vec2<Type>& t);
+    //! @brief Counter-clockwise rotation of @param angle radians around the origin
+    static mat3 rotation(Type angle) requires std::is_floating_point_v<Type>;
+    static mat3 scaling(const vec2<Type>& s);
+
+    //! @brief For printing a mat3 object
+    friend std::ostream& operator<<<Type>(std::ostream&, const mat3<Type>&);
+
+    //! @brief Get the ith column of this matrix
+    vec3<Type>&       operator[](unsigned char i);
+    const vec3<Type>& operator[](unsigned char i) const;
+
+    [[nodiscard]] mat3 transposed() const;
+    [[nodiscard]] Type determinant() const;
+    //! @brief Throws std::domain_error if the matrix is singular
+    [[nodiscard]] mat3 inverse() const requires std::is_floating_point_v<Type>;
+
+    mat3       operator*(const mat3& other)     const;
+    vec3<Type> operator*(const vec3<Type>& v)   const;
+    mat3       operator*(Type val)              const;
+
+    //! @brief The components in column-major order (for glUniformMatrix3fv). vec3<float> is padded, so this copies
+    [[nodiscard]] std::array<Type, 3*3> to_array() const;
+};
+
+
+template<typename Type>
+struct mat4
+{
+    static_assert(std::is_arithmetic_v<Type>, "mat4 components must be numbers (char, int, float, etc..)");
+    std::array<vec4<Type>, 4> cols;
+
+    //! @brief Matrix with @param diag on the diagonal and 0 everywhere else
+    explicit mat4(Type diag=1) : cols{ vec4<Type>{ diag, 0, 0, 0 }, vec4<Type>{ 0, diag, 0, 0 },
+                                       vec4<Type>{ 0, 0, diag, 0 }, vec4<Type>{ 0, 0, 0, diag } } {  }
+    mat4(const vec4<Type>& c0, const vec4<Type>& c1, const vec4<Type>& c2, const vec4<Type>& c3) : cols{ c0, c1, c2, c3 } {  }
+    //! @brief Embed a 3x3 (rotation/scale) matrix, with no translation
+    explicit mat4(const mat3<Type>& m);
+
+    static mat4 identity() { return mat4{ 1 }; }
+    static mat4 translation(const vec3<Type>& t);
+    static mat4 scaling(const vec3<Type>& s);
+    //! @brief Rotation of @param angle radians around @param axis (does not have to be normalized)
+    static mat4 rotation(Type angle, const vec3<Type>& axis) requires std::is_floating_point_v<Type>;
+    //! @brief Rotation of @param angle radians around the z axis (in the screen plane)
+    static mat4 rotation_z(Type angle) requires std::is_floating_point_v<Type>;
+    //! @brief Orthographic projection that maps the given box to the -1.0f to 1.0f cube
+    static mat4 ortho(Type left, Type right, Type bottom, Type top, Type near=-1, Type far=1) requires std::is_floating_point_v<Type>;
+    //! @brief Perspective projection. @param fov_y vertical field of view in radians
+    static mat4 perspective(Type fov_y, Type aspect, Type near, Type far) requires std::is_floating_point_v<Type>;
+
+    //! @brief For printing a mat4 object
+    friend std::ostream& operator<<<Type>(std::ostream&, const mat4<Type>&);
+
+    //! @brief Get the ith column of this matrix
+    vec4<Type>&       operator[](unsigned char i);
+    const vec4<Type>& operator[](unsigned char i) const;
+
+    //! @brief Pointer to the 16 components in column-major order (for glUniformMatrix4fv)
+    Type*       data()       { return &this->cols[0].x; }
+    const Type* data() const { return &this->cols[0].x; }
+
+    //! @brief Whether the bottom row is (0, 0, 0, 1), meaning the matrix has no projection
+    [[nodiscard]] bool is_affine() const;
+    [[nodiscard]] mat4 transposed() const;
+    [[nodiscard]] Type determinant() const;
+    //! @brief General inverse. Throws std::domain_error if the matrix is singular
+    [[nodiscard]] mat4 inverse() const requires std::is_floating_point_v<Type>;
+    /*! @brief Fast inverse for affine matrices (rotation, scale, translation. See this->is_affine()).
+     *         Only inverts the upper 3x3 and the translation. Throws std::domain_error if the matrix is singular */
+    [[nodiscard]] mat4 inverse_affine() const requires std::is_floating_point_v<Type>;
+
+    mat4       operator*(const mat4& other)   const;
+    vec4<Type> operator*(const vec4<Type>& v) const;
+    mat4       operator*(Type val)            const;
+
+    //! @brief Transform a position (w = 1). Divides by w when the matrix is not affine
+    [[nodiscard]] vec3<Type> transform_point(const vec3<Type>& p) const;
+    //! @brief Transform a direction (w = 0). Translation has no effect
+    [[nodiscard]] vec3<Type> transform_vector(const vec3<Type>& v) const;
+
+    // -- batch transforms
+    //! @brief Transform every position in @param points in place (w = 1)
+    void transform_points(vec3_stream<Type>& points) const;
+    /*! @brief Transform the position attribute of interleaved vertices in place (w = 1)
+     *  @param vertices      array of vertices, like the ones primitive::Shape2D takes
+     *  @param count         how many vertices are in @param vertices
+     *  @param vertex_length how many floats long a single vertex is
+     *  @param offset        index of the position's x inside a vertex */
+    void transform_points(float* vertices, size_t count, unsigned int vertex_length, unsigned int offset=0) const
+    requires std::is_same_v<Type, float>;
+};
+
+#include "../cpp/mat.tpp"
+
+
+#endif //OPENGL_MAT_H
@@ -0,0 +1,74 @@
+#ifndef OPENGL_MESH_GEN_H
+#define OPENGL_MESH_GEN_H
+#include <array>
+#include "vec.h"
+#include "constexpr-math.h"
+
+/// Vertex and index data for common 2D shapes, generated at compile time.
+/// Store the result in a constexpr (or static constexpr) variable and the data is baked into the binary:
+///     static constexpr auto circle = mesh_gen::circle<32>({ 0, 0 }, 0.5f);
+///     primitive::Shape2D shape{ circle };
+/// Uses the Cartesian Plane (origin(0, 0), y up), like primitive::Rectangle.
+
+namespace mesh_gen
+{
+    /*! @brief Vertices and indices of a shape, ready to be passed to primitive::Shape2D.
+     *         Vertex attributes follow the order primitive::Shape2D takes: position(3), color(4), tex_coord(2).
+     *         tex_coord maps the shape's bounding box to 0.0f to 1.0f */
+    template<size_t v_count, size_t i_count>
+    struct mesh
+    {
+        static constexpr unsigned int vertex_length = 3 + 4 + 2;
+        static constexpr size_t vertex_count = v_count;
+        static constexpr size_t index_count  = i_count;
+
+        std::array<float, v_count * vertex_length> vertices{};
+        //! @brief Counter-clockwise triangles
+        std::array<unsigned int, i_count> indices{};
+    };
+
+    /*! @brief Rectangle made of 2 triangles. Same vertex order as primitive::Rectangle (top left, bottom left, top right,
+     *         bottom right), but the indices are { 0, 1, 3,  0, 3, 2 }: Rectangle's second triangle (0, 2, 3) is clockwise,
+     *         and every triangle here is counter-clockwise, so they survive glCullFace(GL_BACK)
+     *  @param position   top left corner
+     *  @param dimensions width and height */
+    constexpr mesh<4, 6> rect(vec2<float> position, vec2<float> dimensions, rgba<float> color={ 1, 1, 1, 1 });
+
+    /*! @brief Regular polygon, triangulated as a fan from its first vertex
+     *  @param radius   distance from @param center to every vertex
+     *  @param rotation radians. At 0 the first vertex is to the right of the center */
+    template<size_t sides> requires (sides >= 3)
+    constexpr mesh<sides, 3 * (sides - 2)> ngon(vec2<float> center, float radius, rgba<float> color={ 1, 1, 1, 1 },
+                                                float rotation=0);
+
+    /*! @brief Circle approximated by a fan of @param segments triangles around a center vertex.
+     *         The center vertex is vertex 0, so it can be given a different color with set_color() */
+    template<size_t segments> requires (segments >= 3)
+    constexpr mesh<segments + 1, 3 * segments> circle(vec2<float> center, float radius, rgba<float> color={ 1, 1, 1, 1 });
+
+    /*! @brief Rectangle with round corners. Triangle fan around the center of the rectangle
+     *  @param position        top left corner (of the bounding box)
+     *  @param dimensions      width and height
+     *  @param radius          corner radius. Must be at most half of the width and of the height
+     *  @param corner_segments how many triangles are used for each corner's arc */
+    template<size_t corner_segments> requires (corner_segments >= 1)
+    constexpr mesh<1 + 4 * (corner_segments + 1), 3 * 4 * (corner_segments + 1)>
+    rounded_rect(vec2<float> position, vec2<float> dimensions, float radius, rgba<float> color={ 1, 1, 1, 1 });
+
+    /*! @brief Rectangle split into @param columns x @param rows cells (2 triangles each).
+     *         Vertices go left to right, then top to bottom
+     *  @param position   top left corner
+     *  @param dimensions width and height */
+    template<size_t columns, size_t rows> requires (columns >= 1 && rows >= 1)
+    constexpr mesh<(columns + 1) * (rows + 1), 6 * columns * rows>
+    grid(vec2<float> position, vec2<float> dimensions, rgba<float> color={ 1, 1, 1, 1 });
+
+    //! @brief Change the color of vertex @param i (e.g. the center of a circle, for a radial gradient)
+    template<size_t v_count, size_t i_count>
+    constexpr void set_color(mesh<v_count, i_count>& m, size_t i, rgba<float> color);
+}
+
+#include "../cpp/mesh-gen.tpp"
+
+
+#endif //OPENGL_MESH_GEN_H
@@ -0,0 +1,131 @@
+#ifndef OPENGL_MESH_H
+#define OPENGL_MESH_H
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <vector>
+#include "gl-state.h"
+#include "mesh-gen.h"
+#include "vertex-quantize.h"
+
+/// Vertices and indices whose sizes and attribute layout are chosen at runtime (loaded or generated meshes),
+/// unlike primitive::Shape2D, whose sizes are template arguments and whose attributes are always position(3),
+/// color(4), tex_coord(2) floats.
+///     VertexLayout layout;
+///     layout.add(0, 3)                                     // position: 3 floats
+///           .add(1, 4, GL_UNSIGNED_BYTE, true)             // color: 4 bytes read as 0 to 1
+///           .add(2, 2, GL_FLOAT, false, 1);                // tex_coord: 2 floats in a second buffer
+///     Mesh mesh{ layout, { std::as_bytes(std::span(vertices)), std::as_bytes(std::span(tex_coords)) }, indices };
+///     shader.use();
+///     mesh.draw();
+/// Each stream is one vertex buffer: attributes of the same stream are interleaved, and attributes that change
+/// often can go in a stream of their own (see Mesh::update_stream()).
+/// With fewer than 65536 vertices, indices are stored as GL_UNSIGNED_SHORT: half the memory (and bandwidth) of 32-bit ones.
+
+//! @brief Where a vertex attribute is and how the shader reads it
+struct vertex_attribute
+{
+    //! @brief layout (location = ...) in the vertex shader
+    GLuint location = 0;
+    //! @brief Values per vertex (1 to 4)
+    GLint components = 0;
+    /*! @brief Type stored in the buffer: GL_FLOAT, GL_HALF_FLOAT, GL_(UNSIGNED_)BYTE, GL_(UNSIGNED_)SHORT, GL_(UNSIGNED_)INT,
+     *         or GL_(UNSIGNED_)INT_2_10_10_10_REV (4 components in 4 bytes) */
+    GLenum type = GL_FLOAT;
+    //! @brief Integers are read as 0 to 1 (unsigned) or -1 to 1 (signed) instead of their value. The shader always gets floats
+    bool normalized = false;
+    //! @brief Index of the vertex buffer it is in
+    size_t stream = 0;
+    //! @brief Bytes from the start of a vertex of its stream
+    size_t offset = 0;
+
+    //! @brief Bytes it takes in a vertex
+    [[nodiscard]] size_t bytes() const;
+};
+
+class VertexLayout {
+public:
+    /*! @brief Add an attribute after the last one of @param stream. It starts at a multiple of 4 bytes (where GPUs read
+     *         attributes fastest), so a struct describing the vertex may need padding. Throws std::invalid_argument
+     *         if @param components isn't 1 to 4 or @param type isn't one of vertex_attribute::type */
+    VertexLayout& add(GLuint location, GLint components, GLenum type=GL_FLOAT, bool normalized=false, size_t stream=0);
+
+    //! @brief The layout of primitive::Shape2D and mesh_gen: position(3), color(4), tex_coord(2) floats, in one stream
+    static VertexLayout shape2d();
+
+    [[nodiscard]] const std::vector<vertex_attribute>& attributes() const { return this->_attributes; }
+    //! @brief Number of vertex buffers
+    [[nodiscard]] size_t streams() const { return this->strides.size(); }
+    //! @brief Bytes of one vertex of @param stream
+    [[nodiscard]] size_t stride(size_t stream) const { return stream < this->strides.size() ? this->strides[stream] : 0; }
+    //! @brief Bytes of one vertex in every stream
+    [[nodiscard]] size_t vertex_bytes() const;
+
+    //! @brief Bytes of one value of @param type, 0 if it can't be a vertex attribute
+    static size_t size_of(GLenum type);
+
+private:
+    std::vector<vertex_attribute> _attributes;
+    std::vector<size_t> strides;
+};
+
+class Mesh {
+public:
+    /*! @brief Upload @param streams (one per stream of @param layout, with the same number of vertices) and @param indices.
+     *         @param mode is what the indices draw (GL_TRIANGLES, GL_TRIANGLE_STRIP, GL_LINES, ...), @param usage the hint of
+     *         the vertex buffers. Throws std::invalid_argument if the streams don't fit the layout, there are no indices,
+     *         or an index is past the last vertex */
+    Mesh(const VertexLayout& layout, std::initializer_list<std::span<const std::byte>> streams, std::span<const unsigned int> indices,
+         GLenum mode=GL_TRIANGLES, GLenum usage=GL_STATIC_DRAW);
+    //! @brief Mesh of one stream of floats (e.g. VertexLayout::shape2d())
+    Mesh(const VertexLayout& layout, std::span<const float> vertices, std::span<const unsigned int> indices,
+         GLenum mode=GL_TRIANGLES, GLenum usage=GL_STATIC_DRAW);
+    /*! @brief Mesh of quantized vertices (see vertex-quantize.h). The layout is the one of VertexLayout::shape2d() with each
+     *         attribute's smaller type, and the normal at vertices.normal_location */
+    Mesh(const vertex_quantize::vertices& vertices, std::span<const unsigned int> indices,
+         GLenum mode=GL_TRIANGLES, GLenum usage=GL_STATIC_DRAW);
+    //! @brief Mesh of generated vertices and indices (see mesh-gen.h)
+    template<size_t v_count, size_t i_count>
+    explicit Mesh(const mesh_gen::mesh<v_count, i_count>& mesh)
+        : Mesh(VertexLayout::shape2d(), std::span<const float>(mesh.vertices), std::span<const unsigned int>(mesh.indices)) {  }
+    //! @brief Deletes the buffers. Destroy before the context (glfwTerminate())
+    ~Mesh();
+    // the GL objects have one owner
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+    Mesh(Mesh&& other) noexcept;
+    Mesh& operator=(Mesh&& other) noexcept;
+
+    /*! @brief Replace the vertices of @param stream from @param first_vertex with @param data (whole vertices of that stream).
+     *         Throws std::out_of_range if they go past the last vertex */
+    void update_stream(size_t stream, std::span<const std::byte> data, size_t first_vertex=0);
+
+    //! @brief Draw every index
+    void draw() const;
+
+    [[nodiscard]] const VertexLayout& layout() const { return this->_layout; }
+    [[nodiscard]] size_t vertex_count() const { return this->_vertex_count; }
+    [[nodiscard]] size_t index_count() const { return this->_index_count; }
+    //! @brief GL_UNSIGNED_SHORT with fewer than 65536 vertices, else GL_UNSIGNED_INT
+    [[nodiscard]] GLenum index_type() const { return this->_index_type; }
+    [[nodiscard]] size_t index_bytes() const;
+    //! @brief Memory of the vertex buffers and the element buffer
+    [[nodiscard]] size_t gpu_bytes() const;
+
+private:
+    VertexLayout _layout;
+    size_t _vertex_count = 0;
+    size_t _index_count = 0;
+    GLenum _index_type = GL_UNSIGNED_INT;
+    GLenum mode = GL_TRIANGLES;
+
+    unsigned int vertex_array{};
+    //! @brief One per stream
+    std::vector<GLuint> vertex_buffers;
+    unsigned int element_buffer{};
+
+    void release();
+};
+
+
+#endif //OPENGL_MESH_H
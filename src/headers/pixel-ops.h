@@ -0,0 +1,66 @@
+#ifndef OPENGL_PIXEL_OPS_H
+#define OPENGL_PIXEL_OPS_H
+#include <cstddef>
+#include <vector>
+
+/// CPU side of preparing decoded images for upload: channel expansion, premultiplied alpha, vertical flip and mipmaps.
+/// Kernels use SSE2 only (see simd.h), so every x64 build has them, and work in place where they can,
+/// so a decoded image goes through the pipeline without being copied:
+///     stbi_load (no flip) -> flip_vertically -> expand_to_rgba (into level 0 of the mip chain) -> premultiply_alpha -> generate_mipmaps
+/// pixel_ops::scalar has the plain C++ version of every kernel. It is what builds with OPENGL_NO_SIMD use,
+/// and the reference the bench compares against (src/bench/pixels.cpp).
+
+namespace pixel_ops
+{
+    enum class mip_filter
+    {
+        //! @brief Average of 2x2 pixels (what glGenerateMipmap does)
+        box,
+        //! @brief 8x8 Kaiser-windowed sinc. Sharper than box, with less aliasing, but 16 times the work
+        kaiser,
+    };
+
+    //! @brief Where a level is in a mip chain (see mip_levels())
+    struct mip_level
+    {
+        int width;
+        int height;
+        //! @brief In bytes, from the start of the chain
+        size_t offset;
+        size_t size;
+    };
+
+    //! @brief Levels of a @param width x @param height RGBA image down to 1x1, packed one after the other
+    [[nodiscard]] std::vector<mip_level> mip_levels(int width, int height);
+    //! @brief Bytes of the whole mip chain of an RGBA image (about 4/3 of level 0)
+    [[nodiscard]] size_t mip_chain_size(int width, int height);
+
+    /*! @brief Convert @param count pixels of grey (1), grey-alpha (2) or RGB (3) @param channels to RGBA.
+     *         Grey is copied to R, G and B and missing alpha is opaque. @param dst may be @param src (in place),
+     *         if the buffer has room for count * 4 bytes. Otherwise they must not overlap */
+    void expand_to_rgba(const unsigned char* src, unsigned char* dst, size_t count, int channels);
+    //! @brief Multiply R, G and B by alpha (rounded), for @param count RGBA pixels in place
+    void premultiply_alpha(unsigned char* rgba, size_t count);
+    //! @brief Reverse the order of the rows in place, so the first row is the bottom of the image (what GL expects)
+    void flip_vertically(unsigned char* pixels, int width, int height, int bytes_per_pixel);
+
+    /*! @brief Write the next mipmap level of the RGBA image @param src (@param width x @param height) to @param dst.
+     *  @param srgb whether R, G and B are sRGB encoded (like PNGs are). They are then averaged as linear light,
+     *         so the levels don't get darker. Alpha is always linear */
+    void downsample(const unsigned char* src, int width, int height, unsigned char* dst, mip_filter filter, bool srgb);
+    /*! @brief Fill every level after the first of @param chain (laid out like mip_levels()),
+     *         from level 0 (@param width x @param height RGBA), which must already be there */
+    void generate_mipmaps(unsigned char* chain, int width, int height, mip_filter filter, bool srgb);
+
+    //! @brief Reference implementations, without SIMD
+    namespace scalar
+    {
+        void expand_to_rgba(const unsigned char* src, unsigned char* dst, size_t count, int channels);
+        void premultiply_alpha(unsigned char* rgba, size_t count);
+        void flip_vertically(unsigned char* pixels, int width, int height, int bytes_per_pixel);
+        void downsample(const unsigned char* src, int width, int height, unsigned char* dst, mip_filter filter, bool srgb);
+    }
+}
+
+
+#endif //OPENGL_PIXEL_OPS_H
@@ -0,0 +1,55 @@
+#ifndef OPENGL_PNG_H
+#define OPENGL_PNG_H
+#include <cstddef>
+#include <vector>
+
+/// PNG decoder for the texture load path (TextureLoader::decode), faster than stbi_load on the PNGs we ship:
+///     - inflate reads 64 bits at a time and decodes most Huffman codes with one table lookup,
+///       into a buffer of the exact size of the image (the size is known from the header, so it never grows)
+///     - Sub (4 bytes per pixel), Average and Paeth (3 and 4) are unfiltered with SSE2, one pixel per step (see simd.h)
+/// It gives the same pixels and channels as stbi_load(..., 0) (rows top to bottom, 16 bits reduced to 8, palettes expanded,
+/// tRNS turned into alpha). Anything it doesn't handle makes decode() return false, and the caller uses stbi_load instead:
+/// interlaced images, iPhone (CgBI) PNGs, palette indices past the palette and files that are corrupt.
+/// Define OPENGL_NO_PNG_DECODER to always use stbi_load.
+/// A deflate stream can't be split without decoding it, and every row is unfiltered from the one before it,
+/// so one image is decoded on one thread. TextureLoader decodes different images on its worker threads.
+
+namespace png
+{
+    struct image
+    {
+        int width = 0;
+        int height = 0;
+        //! @brief 1 (grey), 2 (grey-alpha), 3 (RGB) or 4 (RGBA), like stbi_load reports them
+        int channels = 0;
+        //! @brief 8 bits per channel, rows top to bottom
+        std::vector<unsigned char> pixels;
+    };
+
+    //! @brief Filter type byte at the start of each row of a PNG
+    enum class row_filter : unsigned char { none, sub, up, average, paeth };
+
+    //! @brief Whether @param data starts with the PNG signature
+    [[nodiscard]] bool is_png(const unsigned char* data, size_t size);
+    /*! @brief Decode the PNG file in @param data into @param out.
+     *  @returns false if it couldn't: @param data isn't a PNG, is corrupt, or is a kind of PNG this decoder leaves to stbi */
+    [[nodiscard]] bool decode(const unsigned char* data, size_t size, image& out);
+
+    /*! @brief Decompress the zlib stream @param data (what the IDAT chunks hold) into exactly @param out_size bytes.
+     *  @returns false if the stream is corrupt or doesn't have exactly @param out_size bytes */
+    [[nodiscard]] bool inflate(const unsigned char* data, size_t size, unsigned char* out, size_t out_size);
+    /*! @brief Undo @param filter on the row @param src (@param length bytes, without the filter type byte) into @param dst.
+     *  @param prior is the row above, already unfiltered (zeros for the first row). @param bytes_per_pixel at least 1 */
+    void unfilter_row(row_filter filter, const unsigned char* src, const unsigned char* prior, unsigned char* dst,
+                      size_t length, int bytes_per_pixel);
+
+    //! @brief Reference implementations, without SIMD
+    namespace scalar
+    {
+        void unfilter_row(row_filter filter, const unsigned char* src, const unsigned char* prior, unsigned char* dst,
+                          size_t length, int bytes_per_pixel);
+    }
+}
+
+
+#endif //OPENGL_PNG_H
@@ -2,12 +2,38 @@
 #define OPENGL_PRIMITIVE_H
 
 #include <array>
+#include <span>
 #include "vec.h"
+#include "mesh-gen.h"
 #include "util.h"
+#include "gl-state.h"
+#include "shader-program.h"
+#include "texture-atlas.h"
 
 
 namespace primitive
 {
+    /*! @brief One copy of an instanced shape (see Shape2D::set_instances()). Needs the INSTANCED shader feature,
+     *         which reads these as vertex attributes 4 to 7, advanced once per instance */
+    struct shape_instance
+    {
+        //! @brief Rows of a 2x3 transform: x' = [0] * x + [1] * y + [2], y' = [3] * x + [4] * y + [5]
+        float transform[6] = { 1, 0, 0,  0, 1, 0 };
+        //! @brief Multiplies the color of the vertices
+        float color[4] = { 1, 1, 1, 1 };
+        //! @brief u_min, v_min, u_max, v_max: the rectangle the tex_coords of the shape (0 to 1) are mapped into
+        float uv_rect[4] = { 0, 0, 1, 1 };
+
+        //! @brief Scaled by @param scale, rotated by @param angle (radians, counterclockwise), then moved to (@param x, @param y)
+        static shape_instance at(float x, float y, float scale=1, float angle=0);
+        //! @brief Showing the image of @param region (its page must be bound) instead of the whole texture
+        shape_instance& with_region(const atlas_region& region);
+        shape_instance& with_color(vec4<float> rgba);
+
+        //! @brief Point attributes 4 to 7 of the bound vertex array at the bound GL_ARRAY_BUFFER of shape_instances
+        static void enable_attributes();
+    };
+
     template<size_t v_size, size_t i_size>
     struct Shape2D
     {
@@ -36,9 +62,9 @@ namespace primitive
             glGenBuffers(1, &this->element_buffer);
 
             // * the following must be done in sequence:
-            glBindVertexArray(this->vertex_array);
-            glBindBuffer(GL_ARRAY_BUFFER, this->vertex_buffer); // (can simultaneously bind buffers of different types)
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->element_buffer);
+            gl_state::bind_vertex_array(this->vertex_array);
+            gl_state::bind_buffer(GL_ARRAY_BUFFER, this->vertex_buffer); // (can simultaneously bind buffers of different types)
+            gl_state::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, this->element_buffer);
 
             /*! @brief Transfer vertices data from RAM (CPU) to VRAM (GPU).
              *  Do this the least amount of times possible (or do it in bulk) because it is slow
@@ -79,22 +105,42 @@ namespace primitive
             }
         }
 
+        /*! @brief Define a Shape from generated vertices and indices (see mesh-gen.h).
+         *         e.g. primitive::Shape2D circle{ mesh_gen::circle<32>({ 0, 0 }, 0.5f) }; */
+        Shape2D(const mesh_gen::mesh<v_size / mesh_gen::mesh<0, 0>::vertex_length, i_size>& mesh) // NOLINT(google-explicit-constructor)
+        requires (v_size % mesh_gen::mesh<0, 0>::vertex_length == 0)
+            : Shape2D(mesh.vertices, mesh.vertex_length, mesh.indices) {  }
+
+        /*! @brief Define a Shape textured with an image of a TextureAtlas. The tex_coords of @param vertices (0 to 1 over the image)
+         *         are remapped to where the image is in its page, so shapes on the same page share one bind:
+         *         atlas.use(@param region.page) before draw() */
+        Shape2D(std::array<float, v_size> vertices, unsigned int vertex_length, std::array<unsigned int, i_size> indices,
+                const atlas_region& region)
+            : Shape2D(remap_tex_coords(vertices, vertex_length, region), vertex_length, indices) {  }
+
+        //! @brief Define a Shape from generated vertices and indices, textured with an image of a TextureAtlas (see above)
+        Shape2D(const mesh_gen::mesh<v_size / mesh_gen::mesh<0, 0>::vertex_length, i_size>& mesh, const atlas_region& region)
+        requires (v_size % mesh_gen::mesh<0, 0>::vertex_length == 0)
+            : Shape2D(remap_tex_coords(mesh.vertices, mesh.vertex_length, region), mesh.vertex_length, mesh.indices) {  }
+
         // TODO: create constructor where vertex position, color, and tex_coord are separate arrays
 
         ~Shape2D()
         {
-            glDeleteVertexArrays(1, &this->vertex_array);
-            glDeleteBuffers(1, &this->vertex_buffer);
-            glDeleteBuffers(1, &this->element_buffer);
+            gl_state::delete_vertex_arrays(1, &this->vertex_array);
+            gl_state::delete_buffers(1, &this->vertex_buffer);
+            gl_state::delete_buffers(1, &this->element_buffer);
+            if (this->instance_buffer != 0)
+                gl_state::delete_buffers(1, &this->instance_buffer);
         }
 
 
         //! @brief Use the Vertex Array that holds a specified object/shape we want to render
-        void bind_array() const { glBindVertexArray(this->vertex_array); }
+        void bind_array() const { gl_state::bind_vertex_array(this->vertex_array); }
 
         void draw() const
         {
-            glBindVertexArray(this->vertex_array);
+            gl_state::bind_vertex_array(this->vertex_array);
 
             /*! @brief Render vertices
              *  @param mode  type of primitive (shape) to render
@@ -107,7 +153,52 @@ namespace primitive
              *  @param count   how many vertices to render
              *  @param type    data type of indices (e.g. Int, Float, etc.)
              *  @param indices offset of indices to use from the Element Array */
-            glDrawElements(GL_TRIANGLES, 6, Unsigned_Int, nullptr); // * USE FOR MORE COMPLEX SHAPES
+            ShaderProgram::flush_in_use();
+            glDrawElements(GL_TRIANGLES, i_size, Unsigned_Int, nullptr); // * USE FOR MORE COMPLEX SHAPES
+        }
+
+        /*! @brief Set the copies draw_instanced() draws, replacing the last ones. Call it whenever they change (e.g. every frame):
+         *         all of them are uploaded at once, to a buffer next to the vertex buffer, which the vertices don't leave */
+        void set_instances(std::span<const shape_instance> instances)
+        {
+            this->instance_count = (GLsizei) instances.size();
+            if (instances.empty())
+                return;
+            if (this->instance_buffer == 0)
+            {
+                // the per-instance attributes are part of the vertex array, like the per-vertex ones
+                glGenBuffers(1, &this->instance_buffer);
+                gl_state::bind_vertex_array(this->vertex_array);
+                gl_state::bind_buffer(GL_ARRAY_BUFFER, this->instance_buffer);
+                shape_instance::enable_attributes();
+            }
+            else
+                gl_state::bind_buffer(GL_ARRAY_BUFFER, this->instance_buffer);
+            // new storage every time (orphaning), so the upload doesn't wait for the GPU to finish drawing the old instances
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) instances.size_bytes(), instances.data(), GL_STREAM_DRAW);
+        }
+
+        //! @brief Draw every instance of set_instances() with one draw call. Use a shader with the INSTANCED feature
+        void draw_instanced() const
+        {
+            if (this->instance_count == 0)
+                return;
+            gl_state::bind_vertex_array(this->vertex_array);
+            ShaderProgram::flush_in_use();
+            glDrawElementsInstanced(GL_TRIANGLES, i_size, Unsigned_Int, nullptr, this->instance_count);
+        }
+
+        //! @brief Number of instances draw_instanced() draws
+        [[nodiscard]] size_t instances() const { return (size_t) this->instance_count; }
+
+        //! @brief Copy of @param vertices with their tex_coords (after position(3) and color(4)) mapped into @param region
+        static constexpr std::array<float, v_size> remap_tex_coords(std::array<float, v_size> vertices, unsigned int vertex_length,
+                                                                    const atlas_region& region)
+        {
+            if (vertex_length > 7)
+                for (size_t i = 0; i + vertex_length <= v_size; i += vertex_length)
+                    region.map(vertices[i + 7], vertices[i + 8]);
+            return vertices;
         }
 
     private:
@@ -117,8 +208,16 @@ namespace primitive
         unsigned int vertex_buffer;
         //! @brief Stores indices that specify the order in which to draw vertices in the Vertex Buffer
         unsigned int element_buffer;
+        //! @brief Per-instance attributes (shape_instance), created by the first set_instances()
+        unsigned int instance_buffer = 0;
+        GLsizei instance_count = 0;
     };
 
+    template<size_t v_count, size_t i_count>
+    Shape2D(const mesh_gen::mesh<v_count, i_count>&) -> Shape2D<v_count * mesh_gen::mesh<v_count, i_count>::vertex_length, i_count>;
+    template<size_t v_count, size_t i_count>
+    Shape2D(const mesh_gen::mesh<v_count, i_count>&, const atlas_region&) -> Shape2D<v_count * mesh_gen::mesh<v_count, i_count>::vertex_length, i_count>;
+
 
     // For a triangle an Element Buffer is NOT necessary, only for more complex shapes
     struct Triangle : public Shape2D<3*3, 3>
@@ -176,7 +275,7 @@ namespace primitive
         /*! @brief Generate an array containing vertices for the rectangle. Uses Cartesian Plane (origin(0, 0), y up)
          *  @param x     range: -1.0f to 1.0f  @param y      range: -1.0f to 1.0f
          *  @param width range: -1.0f to 1.0f  @param height range: -1.0f to 1.0f */
-        static std::array<float, 4*3> gen_vertices(float x, float y, float width, float height)
+        static constexpr std::array<float, 4*3> gen_vertices(float x, float y, float width, float height)
         {
             return std::array<float, 4 * 3> {
                 x,         y         , 0.0f, //    top left
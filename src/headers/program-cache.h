@@ -0,0 +1,53 @@
+#ifndef OPENGL_PROGRAM_CACHE_H
+#define OPENGL_PROGRAM_CACHE_H
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <string_view>
+#include "glad/glad.h"
+
+/// On-disk cache of linked shader programs (glGetProgramBinary/glProgramBinary), so ShaderProgram
+/// doesn't have to compile and link its shaders on every launch.
+///     program_cache::init((GLADloadproc) glfwGetProcAddress, "shader-cache");  // after gladLoadGLLoader
+/// Programs are keyed by a hash of their sources, their defines and the driver (vendor, renderer and version),
+/// so editing a shader or updating the driver makes a new entry. Blobs the driver rejects are deleted and compiled again.
+/// The cache stays disabled if init() is not called, if the driver has no binary formats, or while a gl_trace capture runs.
+
+namespace program_cache
+{
+    //! @brief Startup cost of the ShaderProgram constructors, split by whether the program came from the cache
+    struct stats
+    {
+        size_t hits   = 0;
+        size_t misses = 0;
+        //! @brief Blobs that existed but were rejected by the driver (also counted as misses)
+        size_t stale  = 0;
+        double hit_ms  = 0;
+        double miss_ms = 0;
+    };
+
+    /*! @brief Load the program binary functions (GL 4.1 or ARB_get_program_binary) with @param load,
+     *         and store the binaries in @param directory (created if it doesn't exist).
+     *  @return whether the cache can be used */
+    bool init(GLADloadproc load, const char* directory);
+    [[nodiscard]] bool enabled();
+
+    //! @brief Hash of the @param sources of every stage, the @param defines they were compiled with and the driver
+    [[nodiscard]] std::uint64_t key(std::initializer_list<std::string_view> sources, std::string_view defines="");
+
+    //! @brief Link @param program from the cached binary of @param key. @return false if there is none or it is stale
+    bool load(GLuint program, std::uint64_t key);
+    //! @brief Call before glLinkProgram, so the driver keeps the binary of @param program around for store()
+    void prepare(GLuint program);
+    //! @brief Save the binary of the linked @param program under @param key
+    void store(GLuint program, std::uint64_t key);
+
+    //! @brief Add a program's creation time to the stats
+    void count(bool hit, double ms);
+    [[nodiscard]] const stats& counters();
+}
+
+std::ostream& operator<<(std::ostream& os, const program_cache::stats& stats);
+
+
+#endif //OPENGL_PROGRAM_CACHE_H
@@ -0,0 +1,82 @@
+#ifndef OPENGL_SAMPLER_CACHE_H
+#define OPENGL_SAMPLER_CACHE_H
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "glad/glad.h"
+
+/// Sampler objects (glGenSamplers, GL 3.3) shared by everything that samples the same way. A sampler bound to a texture
+/// unit overrides the wrap and filter modes of the texture bound there (Texture::set_wrap_mode(), set_filter_mode()),
+/// so sampling state lives in a few objects instead of in every texture, and switching textures doesn't touch it:
+///     SamplerCache samplers;
+///     samplers.bind(0, sampler_state{ .wrap_s = GL_CLAMP_TO_EDGE, .wrap_t = GL_CLAMP_TO_EDGE });
+///     heart.use(); rect.draw();
+///     logo.use();  sprite.draw();   // same sampler
+/// States that are equal get the same sampler. Binds go through gl_state, so binding the sampler a unit already has
+/// doesn't reach GL. Destroy the cache before the context (glfwTerminate()).
+
+//! @brief Everything a sampler object holds. The defaults are the ones Texture gives new textures
+struct sampler_state
+{
+    //! @brief GL_REPEAT, GL_MIRRORED_REPEAT, GL_CLAMP_TO_EDGE or GL_CLAMP_TO_BORDER (see Texture::set_wrap_mode())
+    GLint wrap_s = GL_MIRRORED_REPEAT;
+    GLint wrap_t = GL_MIRRORED_REPEAT;
+    GLint wrap_r = GL_MIRRORED_REPEAT;
+    //! @brief See Texture::set_filter_mode()
+    GLint min_filter = GL_LINEAR_MIPMAP_LINEAR;
+    GLint mag_filter = GL_NEAREST;
+    //! @brief Only used by GL_CLAMP_TO_BORDER (opaque black, like Texture::border_col). SamplerCache ignores it in states that don't wrap to the border
+    std::array<float, 4> border_color{ 0, 0, 0, 1 };
+
+    [[nodiscard]] constexpr bool uses_border() const
+    {
+        return this->wrap_s == GL_CLAMP_TO_BORDER || this->wrap_t == GL_CLAMP_TO_BORDER || this->wrap_r == GL_CLAMP_TO_BORDER;
+    }
+
+    bool operator==(const sampler_state& other) const = default;
+};
+
+class SamplerCache {
+public:
+    struct stats
+    {
+        //! @brief get() calls that found a sampler with the same state
+        size_t hits    = 0;
+        //! @brief Samplers made (get() calls that didn't find one)
+        size_t created = 0;
+    };
+
+    SamplerCache() = default;
+    //! @brief Deletes every sampler
+    ~SamplerCache();
+    // the samplers have one owner
+    SamplerCache(const SamplerCache&) = delete;
+    SamplerCache& operator=(const SamplerCache&) = delete;
+    SamplerCache(SamplerCache&& other) noexcept;
+    SamplerCache& operator=(SamplerCache&& other) noexcept;
+
+    //! @brief The sampler with @param state, made the first time it's asked for
+    GLuint get(const sampler_state& state);
+    //! @brief Bind the sampler with @param state to texture unit @param unit (0, 1, ..., not GL_TEXTURE0 + i)
+    void bind(GLuint unit, const sampler_state& state);
+    //! @brief Let texture unit @param unit use the wrap and filter modes of its texture again
+    static void unbind(GLuint unit);
+
+    //! @brief Number of different samplers
+    [[nodiscard]] size_t size() const { return this->samplers.size(); }
+    [[nodiscard]] const stats& counters() const { return this->_counters; }
+
+private:
+    //! @brief There are only a few different states, so a search through them is cheaper than hashing
+    std::vector<std::pair<sampler_state, GLuint>> samplers;
+    stats _counters;
+
+    void clear();
+};
+
+std::ostream& operator<<(std::ostream& os, const SamplerCache::stats& stats);
+
+
+#endif //OPENGL_SAMPLER_CACHE_H
@@ -0,0 +1,36 @@
+#ifndef OPENGL_SHADER_PREPROCESSOR_H
+#define OPENGL_SHADER_PREPROCESSOR_H
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Resolves #include "file" in GLSL (which the driver doesn't support) and inserts #defines after the #version line.
+///     glsl::source vert = glsl::preprocess(Shaders_Path"/basic.vert.glsl");
+///     std::string code = vert.with_defines("#define TEXTURED\n");
+/// Include paths are relative to the file that includes them. Every file is included at most once per shader,
+/// so headers don't need include guards. #line directives keep the driver's error messages pointing at the right line:
+/// the source string number in the message is the index of the file in source::files.
+
+namespace glsl
+{
+    struct source
+    {
+        //! @brief The shader with every #include replaced by the file's contents
+        std::string code;
+        //! @brief Every file that makes up the shader. The first one is the file given to preprocess()
+        std::vector<std::string> files;
+        //! @brief Where defines go in code (after the #version line, if any)
+        size_t defines_at = 0;
+        //! @brief Line of the first file after the #version line, for the #line after the defines
+        size_t line_after_version = 1;
+
+        //! @brief The code with @param defines (e.g. "#define TEXTURED\n") after the #version line
+        [[nodiscard]] std::string with_defines(std::string_view defines) const;
+    };
+
+    //! @brief Read @param path and resolve its includes. Throws std::invalid_argument if a file can't be read
+    source preprocess(const char* path);
+}
+
+
+#endif //OPENGL_SHADER_PREPROCESSOR_H
@@ -1,19 +1,40 @@
 #ifndef OPENGL_SHADERPROGRAM_H
 #define OPENGL_SHADERPROGRAM_H
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <fstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "util.h"
+#include "mat.h"
+#include "gl-state.h"
+#include "shader-preprocessor.h"
 // glad must always be included before glfw
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 
 
+/*! @brief Refers to a uniform of one ShaderProgram without looking up its name (see ShaderProgram::uniform()).
+ *         Only valid for the program that created it */
+struct UniformHandle {
+    static constexpr unsigned int invalid = ~0u;
+    unsigned int index = invalid;
+
+    //! @brief false if the uniform is not active in the program (writes to it are ignored, like location -1)
+    [[nodiscard]] bool valid() const { return this->index != invalid; }
+};
+
+
 //! @brief Shader Programs contain compiled shaders, uniforms, and define how to draw something
 struct ShaderProgram {
     //! @brief ID to the Shader Program on the GPU
-    unsigned int gl_program;
+    unsigned int gl_program = 0;
 
     /*! @brief Create shader program with Vertex and Fragment Shaders.
      *  @param use_now bind Shader Program as soon as it is created
@@ -21,21 +42,155 @@ struct ShaderProgram {
      *  @param frag_shader_path file path GLSL source code for fragment shader. If not given, will use default shader */
     explicit ShaderProgram(const char* vert_shader_path=nullptr, const char* frag_shader_path=nullptr);
 
-    void use() const;
+    enum class compile {
+        //! @brief Wait for the shaders to compile and link, and check for errors, in the constructor
+        now,
+        /*! @brief Only submit the compiles and the link. Errors are checked (and uniforms found) by finish(),
+         *         so the driver can compile while the app does something else (see ShaderBatch) */
+        deferred,
+    };
+    ShaderProgram(const char* vert_shader_path, const char* frag_shader_path, compile when);
+    /*! @brief Create shader program from preprocessed shaders (see shader-preprocessor.h).
+     *  @param defines inserted after the #version line of both shaders, e.g. "#define TEXTURED\n" (see ShaderVariants) */
+    ShaderProgram(const glsl::source& vert_shader, const glsl::source& frag_shader, std::string_view defines, compile when=compile::now);
+    //! @brief Deletes the program (and the shaders of a pending one). Destroy before the context (glfwTerminate())
+    ~ShaderProgram();
+    // the GL program has one owner
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    /*! @brief Enable KHR_parallel_shader_compile (or the ARB version) if the driver has it, so ready() doesn't block
+     *         and the driver compiles with its own threads. Call after gladLoadGLLoader, with the same @param load.
+     *  @return whether the extension is available */
+    static bool enable_parallel_compile(GLADloadproc load);
+    [[nodiscard]] static bool parallel_compile();
+
+    //! @brief Whether a deferred program is still waiting for finish()
+    [[nodiscard]] bool pending() const { return this->submitted.has_value(); }
+    /*! @brief Whether finish() would return without waiting for the driver. Never blocks.
+     *         Without parallel compile (see enable_parallel_compile()), a pending program is never ready, because asking would block */
+    [[nodiscard]] bool ready() const;
+    //! @brief Wait for a deferred program to link and check it for errors. Does nothing if it's not pending
+    void finish();
+
+    //! @brief Bind the program and upload the uniforms that changed since it was last used. Finishes a pending program first
+    void use();
     //! @brief alias to shader-program::use()
-    void bind() const;
+    void bind();
+    /*! @brief Upload the changed uniforms of the program in use, if any. Called by draw functions (e.g. Shape2D::draw()),
+     *         so uniforms set after use() still reach GL before the draw */
+    static void flush_in_use();
 
     void get_uniform(const char* uniform) const;
 
-    void set_uniform(const char* uniform, vec4<float> val) const;
-    void set_uniform(const char* uniform, float val) const;
-    void set_uniform(const char* uniform, int val) const;
-    void set_uniform(const char* uniform, unsigned int val) const;
+    /*! @brief Find an active uniform once, then set it with the handle. For arrays, the handle refers to element 0.
+     *         Finishes a pending program first */
+    [[nodiscard]] UniformHandle uniform(std::string_view name);
+
+    /// Values are written to a copy of the uniforms on the CPU and only uploaded (by use(), or before a draw) if they changed.
+    /// Setting a uniform that is not active does nothing. Setting it with a value of the wrong type throws std::invalid_argument
+    void set_uniform(UniformHandle uniform, float val);
+    void set_uniform(UniformHandle uniform, int val);
+    void set_uniform(UniformHandle uniform, unsigned int val);
+    void set_uniform(UniformHandle uniform, vec2<float> val);
+    void set_uniform(UniformHandle uniform, vec3<float> val);
+    void set_uniform(UniformHandle uniform, vec4<float> val);
+    void set_uniform(UniformHandle uniform, const mat4<float>& val);
+    //! @brief Set the first elements of an int (or sampler) array, one value per element
+    void set_uniform(UniformHandle uniform, std::span<const int> values);
+
+    void set_uniform(const char* uniform, vec4<float> val);
+    void set_uniform(const char* uniform, float val);
+    void set_uniform(const char* uniform, int val);
+    void set_uniform(const char* uniform, unsigned int val);
+    //! @brief Upload a transform (e.g. model or projection matrix), so vertices can be moved on the GPU
+    void set_uniform(const char* uniform, const mat4<float>& val);
 
 private:
+    //! @brief What finish() needs of a program that was only submitted
+    struct Submitted {
+        //! @brief 0 if the program came from the program cache
+        unsigned int vert_shader;
+        unsigned int frag_shader;
+        std::uint64_t cache_key;
+        //! @brief Time the constructor took, for the program cache's stats
+        double ms;
+    };
+    std::optional<Submitted> submitted;
+
+    static inline bool has_parallel_compile = false;
+
+    //! @brief An active uniform, found after linking
+    struct Uniform {
+        std::string name;
+        int location;
+        //! @brief e.g. GL_FLOAT_VEC3 or GL_SAMPLER_2D
+        unsigned int type;
+        //! @brief 'f' (float), 'i' (int, bool and samplers) or 'u' (unsigned int)
+        char base;
+        //! @brief Values per element (e.g. 3 for vec3, 16 for mat4). 0 for types set_uniform can't set
+        unsigned int components;
+        //! @brief Elements in the array (1 if the uniform is not an array)
+        int array_size;
+        //! @brief Where the uniform's values start in this->shadow
+        unsigned int offset;
+    };
+
+    //! @brief Lets uniform_index be searched with a std::string_view, without making a std::string
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    std::vector<Uniform> uniforms;
+    std::unordered_map<std::string, unsigned int, NameHash, std::equal_to<>> uniform_index;
+    //! @brief Values of every uniform (4 bytes each: float, int or unsigned int), as GL has them after the next flush
+    std::vector<std::uint32_t> shadow;
+    //! @brief Uniforms changed since the last flush
+    mutable std::vector<unsigned int> dirty;
+    mutable std::vector<bool> is_dirty;
+
+    //! @brief The program that use() was last called on
+    static inline const ShaderProgram* in_use = nullptr;
+
+    //! @brief Submit the compiles and the link (or load the program from the program cache)
+    void create(const std::string& vert_shader_src, const std::string& frag_shader_src, std::string_view defines, compile when);
+    void reflect_uniforms();
+    //! @brief Read the value the program has for one element of a uniform into @param out (@param components values of type @param base)
+    void read_uniform(int location, char base, unsigned int components, std::uint32_t* out) const;
+    /*! @brief Copy @param count values of type @param base into the shadow of @param uniform, and mark it dirty if they changed.
+     *         @param count is the components of one element, or of several elements of an array */
+    void write_uniform(UniformHandle uniform, char base, const void* values, unsigned int count);
+    void flush_uniforms() const;
+
     void checkProgramCompileErrors() const;
     static void checkShaderCompileErrors(unsigned int shader, const char* shader_type="");
 };
 
 
+/*! @brief Creates many programs at once: every compile and link is submitted before any of them is waited for,
+ *         so the driver can work on them in parallel while the app loads other assets. e.g.
+ *             ShaderBatch shaders;
+ *             ShaderProgram& sprite = shaders.add("sprite.vert.glsl", "sprite.frag.glsl");
+ *             ... load textures ...
+ *             shaders.finish();
+ *         The app can also call poll() every frame and only draw with programs that are no longer pending. */
+class ShaderBatch {
+public:
+    //! @brief Submit a program. The reference stays valid for the life of the batch
+    ShaderProgram& add(const char* vert_shader_path, const char* frag_shader_path);
+    //! @brief Finish the programs that are ready, without waiting. @return how many are still pending
+    size_t poll();
+    //! @brief Wait for every program to finish
+    void finish();
+
+    [[nodiscard]] size_t size() const { return this->programs.size(); }
+    ShaderProgram& operator[](size_t i) { return this->programs[i]; }
+
+private:
+    //! @brief A deque, so adding programs doesn't move the ones that were already added
+    std::deque<ShaderProgram> programs;
+};
+
+
 #endif //OPENGL_SHADERPROGRAM_H
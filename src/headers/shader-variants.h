@@ -0,0 +1,71 @@
+#ifndef OPENGL_SHADER_VARIANTS_H
+#define OPENGL_SHADER_VARIANTS_H
+#include <array>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include "shader-program.h"
+#include "shader-preprocessor.h"
+
+/// One pair of shader files (e.g. basic.vert.glsl/basic.frag.glsl) compiled into a program per combination of features,
+/// instead of keeping a near-duplicate file for every combination.
+///     ShaderVariants basic{ Shaders_Path"/basic.vert.glsl", Shaders_Path"/basic.frag.glsl" };
+///     basic.get(shader_feature::textured | shader_feature::alpha_test).use();
+/// A variant is only compiled the first time it is needed (or by prebuild()), then kept.
+
+namespace shader_feature
+{
+    //! @brief Bits of a variant key. Each one #defines a macro in both shaders (see shader_feature::defines)
+    enum : unsigned int
+    {
+        //! @brief VERTEX_COLOR: color comes from vertex attribute 1
+        vertex_color = 1u << 0,
+        //! @brief TEXTURED: multiply by texture_data at the coordinates in vertex attribute 2
+        textured     = 1u << 1,
+        //! @brief ALPHA_TEST: discard fragments with alpha lower than the alpha_cutoff uniform
+        alpha_test   = 1u << 2,
+        //! @brief TEXTURE_ARRAY: with TEXTURED, texture_data is a sampler2DArray (see texture-array.h) read at layer texture_layer
+        texture_array = 1u << 3,
+        /*! @brief TEXTURE_SLOTS: with TEXTURED, texture_data is an array of 8 textures, picked by the slot in vertex
+         *         attribute 3 (see batch-renderer.h). Not with TEXTURE_ARRAY */
+        texture_slots = 1u << 4,
+        /*! @brief INSTANCED: each instance (see primitive::Shape2D::set_instances()) moves the vertices by its transform
+         *         (attributes 4 and 5), multiplies the color by its own (attribute 6) and maps tex_coord into its
+         *         UV rectangle (attribute 7) */
+        instanced     = 1u << 5,
+    };
+    constexpr unsigned int count = 6;
+    //! @brief Macro defined for each bit, in bit order
+    constexpr const char* defines[count] = { "VERTEX_COLOR", "TEXTURED", "ALPHA_TEST", "TEXTURE_ARRAY", "TEXTURE_SLOTS",
+                                             "INSTANCED" };
+}
+
+class ShaderVariants {
+public:
+    //! @brief Preprocesses the files (see glsl::preprocess()) but doesn't compile anything
+    ShaderVariants(const char* vert_shader_path, const char* frag_shader_path);
+
+    //! @brief The program for @param features (shader_feature bits). Compiled on the first call with these features
+    ShaderProgram& get(unsigned int features);
+    /*! @brief Submit the variants with @param features that aren't built yet without waiting for them
+     *         (see ShaderProgram::compile::deferred), so they compile in parallel. get() finishes them */
+    void prebuild(std::initializer_list<unsigned int> features);
+    //! @brief Number of variants that have been built (or submitted)
+    [[nodiscard]] size_t built() const;
+    //! @brief Delete every variant (get() builds them again). Call before the context is destroyed (glfwTerminate())
+    void clear();
+
+    //! @brief The #defines of @param features, e.g. "#define TEXTURED\n"
+    static std::string defines_of(unsigned int features);
+
+private:
+    glsl::source vert_shader;
+    glsl::source frag_shader;
+    //! @brief Indexed by the features, so picking a variant costs an array access
+    std::array<std::unique_ptr<ShaderProgram>, 1u << shader_feature::count> variants;
+
+    ShaderProgram& build(unsigned int features, ShaderProgram::compile when);
+};
+
+
+#endif //OPENGL_SHADER_VARIANTS_H
@@ -0,0 +1,222 @@
+#ifndef OPENGL_SIMD_H
+#define OPENGL_SIMD_H
+#include <cmath>
+#include <cstddef>
+#include <new>
+
+/// Pick the widest instruction set the compiler is targeting.
+/// Define OPENGL_NO_SIMD to force the portable scalar fallback.
+#if !defined(OPENGL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define OPENGL_SIMD_SSE 1
+    #include <immintrin.h>
+    // MSVC has no __SSE4_1__ macro, but /arch:AVX implies it
+    #if defined(__SSE4_1__) || defined(__AVX__)
+        #define OPENGL_SIMD_SSE4_1 1
+    #endif
+    #if defined(__AVX__)
+        #define OPENGL_SIMD_AVX 1
+    #endif
+#endif
+
+
+namespace simd
+{
+    //! @brief 4 packed single precision floats. Maps to one SSE register when available
+    struct f32x4
+    {
+#ifdef OPENGL_SIMD_SSE
+        __m128 v;
+#else
+        alignas(16) float v[4];
+#endif
+    };
+
+    //! @brief Name of the instruction set the vector math was compiled for
+    constexpr const char* isa()
+    {
+#if defined(OPENGL_SIMD_AVX)
+        return "AVX";
+#elif defined(OPENGL_SIMD_SSE4_1)
+        return "SSE4.1";
+#elif defined(OPENGL_SIMD_SSE)
+        return "SSE2";
+#else
+        return "scalar";
+#endif
+    }
+
+#ifdef OPENGL_SIMD_SSE
+    //! @brief Load 4 floats. @param p must be 16 byte aligned
+    inline f32x4 load(const float* p)  { return { _mm_load_ps(p) }; }
+    //! @brief Load 4 floats from any address
+    inline f32x4 loadu(const float* p) { return { _mm_loadu_ps(p) }; }
+    //! @brief Store 4 floats. @param p must be 16 byte aligned
+    inline void store(float* p, f32x4 a)  { _mm_store_ps(p, a.v); }
+    inline void storeu(float* p, f32x4 a) { _mm_storeu_ps(p, a.v); }
+
+    inline f32x4 set(float x, float y, float z, float w) { return { _mm_setr_ps(x, y, z, w) }; }
+    inline f32x4 splat(float val) { return { _mm_set1_ps(val) }; }
+
+    inline f32x4 add(f32x4 a, f32x4 b) { return { _mm_add_ps(a.v, b.v) }; }
+    inline f32x4 sub(f32x4 a, f32x4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+    inline f32x4 mul(f32x4 a, f32x4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+    inline f32x4 div(f32x4 a, f32x4 b) { return { _mm_div_ps(a.v, b.v) }; }
+    inline f32x4 min(f32x4 a, f32x4 b) { return { _mm_min_ps(a.v, b.v) }; }
+    inline f32x4 max(f32x4 a, f32x4 b) { return { _mm_max_ps(a.v, b.v) }; }
+    inline f32x4 sqrt(f32x4 a)         { return { _mm_sqrt_ps(a.v) }; }
+
+    //! @brief Add all 4 lanes together
+    inline float hsum(f32x4 a)
+    {
+        __m128 shuf = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1)); // (y, x, w, z)
+        __m128 sums = _mm_add_ps(a.v, shuf);                              // (x+y, x+y, z+w, z+w)
+        shuf = _mm_movehl_ps(shuf, sums);                                 // (z+w, z+w, ...)
+        return _mm_cvtss_f32(_mm_add_ss(sums, shuf));
+    }
+
+    inline float dot4(f32x4 a, f32x4 b)
+    {
+    #ifdef OPENGL_SIMD_SSE4_1
+        return _mm_cvtss_f32(_mm_dp_ps(a.v, b.v, 0xF1));
+    #else
+        return hsum(mul(a, b));
+    #endif
+    }
+
+    //! @brief Dot product of the first 3 lanes. The 4th lane is ignored
+    inline float dot3(f32x4 a, f32x4 b)
+    {
+    #ifdef OPENGL_SIMD_SSE4_1
+        return _mm_cvtss_f32(_mm_dp_ps(a.v, b.v, 0x71));
+    #else
+        __m128 m = _mm_mul_ps(a.v, b.v);
+        m = _mm_and_ps(m, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+        return hsum({ m });
+    #endif
+    }
+
+    //! @brief Cross product of the first 3 lanes. The 4th lane is a.w*b.w - a.w*b.w (0 for finite values)
+    inline f32x4 cross3(f32x4 a, f32x4 b)
+    {
+        // a.yzx * b.zxy - a.zxy * b.yzx
+        __m128 a_yzx = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 b_yzx = _mm_shuffle_ps(b.v, b.v, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 c = _mm_sub_ps(_mm_mul_ps(a.v, b_yzx), _mm_mul_ps(a_yzx, b.v)); // result in zxy order
+        return { _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)) };
+    }
+
+    //! @brief Set the 4th lane to 0, keep the first 3
+    inline f32x4 zero_w(f32x4 a)
+    {
+    #ifdef OPENGL_SIMD_SSE4_1
+        return { _mm_blend_ps(a.v, _mm_setzero_ps(), 0b1000) };
+    #else
+        return { _mm_and_ps(a.v, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0))) };
+    #endif
+    }
+
+    inline float lane(f32x4 a, int i)
+    {
+        alignas(16) float out[4];
+        _mm_store_ps(out, a.v);
+        return out[i];
+    }
+#else
+    inline f32x4 load(const float* p)  { return { p[0], p[1], p[2], p[3] }; }
+    inline f32x4 loadu(const float* p) { return { p[0], p[1], p[2], p[3] }; }
+    inline void store(float* p, f32x4 a)  { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+    inline void storeu(float* p, f32x4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+
+    inline f32x4 set(float x, float y, float z, float w) { return { x, y, z, w }; }
+    inline f32x4 splat(float val) { return { val, val, val, val }; }
+
+    inline f32x4 add(f32x4 a, f32x4 b) { return { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }; }
+    inline f32x4 sub(f32x4 a, f32x4 b) { return { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }; }
+    inline f32x4 mul(f32x4 a, f32x4 b) { return { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }; }
+    inline f32x4 div(f32x4 a, f32x4 b) { return { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] }; }
+    inline f32x4 min(f32x4 a, f32x4 b)
+    {
+        return { b.v[0] < a.v[0] ? b.v[0] : a.v[0], b.v[1] < a.v[1] ? b.v[1] : a.v[1],
+                 b.v[2] < a.v[2] ? b.v[2] : a.v[2], b.v[3] < a.v[3] ? b.v[3] : a.v[3] };
+    }
+    inline f32x4 max(f32x4 a, f32x4 b)
+    {
+        return { b.v[0] > a.v[0] ? b.v[0] : a.v[0], b.v[1] > a.v[1] ? b.v[1] : a.v[1],
+                 b.v[2] > a.v[2] ? b.v[2] : a.v[2], b.v[3] > a.v[3] ? b.v[3] : a.v[3] };
+    }
+    inline f32x4 sqrt(f32x4 a) { return { std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3]) }; }
+
+    inline float hsum(f32x4 a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+    inline float dot4(f32x4 a, f32x4 b) { return hsum(mul(a, b)); }
+    inline float dot3(f32x4 a, f32x4 b) { return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]; }
+
+    inline f32x4 cross3(f32x4 a, f32x4 b)
+    {
+        return {
+            a.v[1] * b.v[2] - a.v[2] * b.v[1],
+            a.v[2] * b.v[0] - a.v[0] * b.v[2],
+            a.v[0] * b.v[1] - a.v[1] * b.v[0],
+            a.v[3] * b.v[3] - a.v[3] * b.v[3]
+        };
+    }
+
+    inline f32x4 zero_w(f32x4 a) { return { a.v[0], a.v[1], a.v[2], 0.0f }; }
+
+    inline float lane(f32x4 a, int i) { return a.v[i]; }
+#endif
+
+
+    /// --- WIDE PACKETS ---
+    /// Batch kernels (see vec-stream.h) work on the widest packet available: 8 floats with AVX, otherwise 4.
+#ifdef OPENGL_SIMD_AVX
+    struct f32x8 { __m256 v; };
+
+    inline f32x8 load(const float* p, f32x8)  { return { _mm256_load_ps(p) }; }
+    inline f32x8 loadu(const float* p, f32x8) { return { _mm256_loadu_ps(p) }; }
+    inline void store(float* p, f32x8 a)  { _mm256_store_ps(p, a.v); }
+    inline void storeu(float* p, f32x8 a) { _mm256_storeu_ps(p, a.v); }
+    inline f32x8 splat(float val, f32x8) { return { _mm256_set1_ps(val) }; }
+
+    inline f32x8 add(f32x8 a, f32x8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+    inline f32x8 sub(f32x8 a, f32x8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    inline f32x8 mul(f32x8 a, f32x8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    inline f32x8 div(f32x8 a, f32x8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+    inline f32x8 min(f32x8 a, f32x8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+    inline f32x8 max(f32x8 a, f32x8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+    inline f32x8 sqrt(f32x8 a)         { return { _mm256_sqrt_ps(a.v) }; }
+
+    using f32xN = f32x8;
+#else
+    // tag-dispatched overloads so kernels can be written once for both packet widths
+    inline f32x4 load(const float* p, f32x4)  { return load(p); }
+    inline f32x4 loadu(const float* p, f32x4) { return loadu(p); }
+    inline f32x4 splat(float val, f32x4)      { return splat(val); }
+
+    using f32xN = f32x4;
+#endif
+    //! @brief Number of floats in a wide packet
+    constexpr size_t width = sizeof(f32xN) / sizeof(float);
+    //! @brief Alignment (bytes) of a wide packet. Arrays processed by batch kernels should use this alignment
+    constexpr size_t alignment = sizeof(f32xN);
+
+    //! @brief Allocator for std::vector so that its data can be loaded with aligned SIMD loads
+    template<typename Type>
+    struct aligned_allocator
+    {
+        using value_type = Type;
+
+        aligned_allocator() = default;
+        template<typename Type2> aligned_allocator(const aligned_allocator<Type2>&) {  } // NOLINT(google-explicit-constructor)
+
+        Type* allocate(size_t n)
+        {
+            return static_cast<Type*>(::operator new(n * sizeof(Type), std::align_val_t{ alignment }));
+        }
+        void deallocate(Type* p, size_t) { ::operator delete(p, std::align_val_t{ alignment }); }
+
+        template<typename Type2> bool operator==(const aligned_allocator<Type2>&) const { return true; }
+    };
+}
+
+
+#endif //OPENGL_SIMD_H
@@ -0,0 +1,94 @@
+#ifndef OPENGL_STREAMING_TEXTURE_H
+#define OPENGL_STREAMING_TEXTURE_H
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "gl-state.h"
+
+/// A texture whose image is replaced often (video frames, generated heatmaps) without making the CPU wait for the GPU.
+///     StreamingTexture video{ 1280, 720 };
+///     unsigned char* frame = video.begin_update();   // width * height RGBA pixels, rows bottom to top
+///     decode_frame_into(frame);
+///     video.end_update();                            // the GPU copies it into the texture when it gets to it
+///     video.use();
+/// Each update is written into the next of a ring of GL_PIXEL_UNPACK_BUFFERs, which glTexSubImage2D copies from
+/// without reading client memory, so the call returns right away. The buffer is mapped with GL_MAP_INVALIDATE_BUFFER_BIT:
+/// if the GPU is still copying the frame that used it last, the driver gives the buffer new memory (orphaning)
+/// instead of waiting for it. While the application writes frame N + 1, the GPU can still be copying frame N.
+/// The texture has no mipmaps (making them every frame would cost more than the upload). Destroy it before the context.
+
+class StreamingTexture {
+public:
+    //! @brief Updates and their cost: CPU time spent in begin_update(), end_update() and update()'s copy, not writing the pixels yourself
+    struct stats
+    {
+        size_t updates = 0;
+        //! @brief Updates that were lost because GL lost the buffer's memory while it was mapped (glUnmapBuffer false)
+        size_t dropped = 0;
+        size_t bytes   = 0;
+        double cpu_ms  = 0;
+
+        //! @brief Upload throughput: bytes per second of CPU time spent on updates
+        [[nodiscard]] double bytes_per_second() const { return this->cpu_ms > 0 ? (double) this->bytes / this->cpu_ms * 1000 : 0; }
+        stats& operator+=(const stats& other);
+    };
+
+    unsigned int gl_texture{};
+
+    //! @brief Allocate a @param width x @param height RGBA texture and @param ring_size buffers (at least 1) to upload through
+    StreamingTexture(int width, int height, size_t ring_size=3);
+    //! @brief Deletes gl_texture and the buffers
+    ~StreamingTexture();
+    // the GL objects have one owner
+    StreamingTexture(const StreamingTexture&) = delete;
+    StreamingTexture& operator=(const StreamingTexture&) = delete;
+    StreamingTexture(StreamingTexture&& other) noexcept;
+    StreamingTexture& operator=(StreamingTexture&& other) noexcept;
+
+    /*! @brief Start an update. @returns where to write the new image (width * height RGBA pixels, rows bottom to top),
+     *         valid until end_update(). Don't make other GL calls that use GL_PIXEL_UNPACK_BUFFER in between */
+    unsigned char* begin_update();
+    //! @brief Send the image written since begin_update() to the texture
+    void end_update();
+    //! @brief Update with @param pixels (rows bottom to top, @param num_col_channels bytes per pixel), written straight into the buffer
+    void update(const unsigned char* pixels, int num_col_channels=4);
+
+    [[nodiscard]] int width() const { return _width; }
+    [[nodiscard]] int height() const { return _height; }
+    [[nodiscard]] size_t ring_size() const { return this->buffers.size(); }
+    //! @brief Bytes of one image
+    [[nodiscard]] size_t image_bytes() const { return (size_t) this->_width * this->_height * 4; }
+
+    //! @brief Stats of the frame in progress (since the last end_frame())
+    [[nodiscard]] const stats& frame() const { return this->current; }
+    //! @brief Finish the frame in progress. @return its stats
+    stats end_frame();
+    //! @brief Stats of every frame, including the one in progress
+    [[nodiscard]] stats totals() const;
+
+    //! @brief Bind to the active texture unit
+    void use() const;
+    //! @brief alias to this->use()
+    void bind() const;
+
+private:
+    int _width{};
+    int _height{};
+    std::vector<GLuint> buffers;
+    //! @brief Index of the buffer the next update uses
+    size_t next = 0;
+    //! @brief Buffer mapped by begin_update(), 0 if there is none
+    GLuint mapped = 0;
+    //! @brief Where the image goes if the buffer can't be mapped: it's then uploaded from client memory
+    std::vector<unsigned char> fallback;
+    bool updating = false;
+    stats current;
+    stats finished;
+
+    void release();
+};
+
+std::ostream& operator<<(std::ostream& os, const StreamingTexture::stats& stats);
+
+
+#endif //OPENGL_STREAMING_TEXTURE_H
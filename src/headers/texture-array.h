@@ -0,0 +1,59 @@
+#ifndef OPENGL_TEXTURE_ARRAY_H
+#define OPENGL_TEXTURE_ARRAY_H
+#include <cstddef>
+#include "gl-state.h"
+
+/// Images of the same size in one GL_TEXTURE_2D_ARRAY texture, picked by layer in the shader (the TEXTURE_ARRAY
+/// shader feature: sampler2DArray texture_data and int texture_layer, see shader-variants.h).
+/// Drawing with another image only changes a uniform, so the texture stays bound:
+///     TextureArray tiles{ 64, 64, 3 };
+///     tiles.set_layer(0, Resource_Path"/grass.png");
+///     tiles.set_layer(1, Resource_Path"/dirt.png");
+///     tiles.generate_mipmaps();
+///     tiles.use();
+///     shader.set_uniform("texture_layer", 1);
+/// Wrap and filter modes come from a sampler (see sampler-cache.h). Without one, they are the ones Texture uses.
+
+class TextureArray {
+public:
+    unsigned int gl_texture{};
+
+    //! @brief Allocate @param layers images of @param width x @param height (RGBA). Their pixels are undefined until set_layer()
+    TextureArray(int width, int height, int layers);
+    //! @brief Deletes gl_texture. Destroy textures before the context (glfwTerminate())
+    ~TextureArray();
+    // the GL texture has one owner
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+    TextureArray(TextureArray&& other) noexcept;
+    TextureArray& operator=(TextureArray&& other) noexcept;
+
+    /*! @brief Replace the image of @param layer (rows bottom to top, @param num_col_channels bytes per pixel, the size of the array).
+     *         Call generate_mipmaps() after the last layer. Throws std::out_of_range if there is no such layer */
+    void set_layer(int layer, int num_col_channels, const unsigned char* data);
+    /*! @brief Replace the image of @param layer with the image at @param filename (stbi_load, flipped if
+     *         stbi_set_flip_vertically_on_load is on). Throws std::invalid_argument if it isn't the size of the array.
+     *         If it can't be loaded, the layer keeps its image */
+    void set_layer(int layer, const char* filename);
+    //! @brief Make the mipmaps of every layer from their images
+    void generate_mipmaps();
+
+    [[nodiscard]] int width() const { return _width; }
+    [[nodiscard]] int height() const { return _height; }
+    [[nodiscard]] int layers() const { return _layers; }
+    //! @brief GPU memory of every layer and its mipmaps (stored as RGBA, 4 bytes per pixel)
+    [[nodiscard]] size_t gpu_bytes() const;
+
+    //! @brief Bind to the active texture unit
+    void use() const;
+    //! @brief alias to this->use()
+    void bind() const;
+
+private:
+    int _width{};
+    int _height{};
+    int _layers{};
+};
+
+
+#endif //OPENGL_TEXTURE_ARRAY_H
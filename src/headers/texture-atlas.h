@@ -0,0 +1,134 @@
+#ifndef OPENGL_TEXTURE_ATLAS_H
+#define OPENGL_TEXTURE_ATLAS_H
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "texture.h"
+
+/// Packs many small images into a few large textures (pages), so the sprites on a page are drawn with one bind:
+///     TextureAtlas atlas;
+///     const atlas_region heart = atlas.add(Resource_Path"/heart.png");
+///     const atlas_region logo = atlas.add(Resource_Path"/opengl.png");
+///     atlas.upload();
+///     primitive::Shape2D heart_rect{ vertices, 3 + 4 + 2, indices, heart }; // tex_coords (0 to 1) are remapped to the region
+///     atlas.use(heart.page);
+///     heart_rect.draw(); logo_rect.draw();
+/// Images are placed by a skyline packer (SkylinePacker). The space around each image (the gutter) repeats its edge pixels,
+/// so linear filtering at the edges doesn't pick up the neighbors. Each image's slot is aligned to 2^(mip_levels - 1) pixels,
+/// so the (box filtered) mipmaps of a page never average two images together, and pages only have mip_levels levels.
+/// Every level halves the gutter, so it is `padding << (mip_levels - 1)` pixels in level 0: the deepest level still has
+/// `padding` texels of it, and the image starts on a texel of every level. (Clamping GL_TEXTURE_MAX_LOD to the levels
+/// whose gutter is still a texel would leave the default options with 2 of their 4 levels.)
+/// The texture coordinates of a region can't wrap: GL_REPEAT would repeat the whole page.
+
+struct atlas_options
+{
+    //! @brief Width and height of each page, in pixels. A multiple of 2^(mip_levels - 1)
+    int page_size = 2048;
+    //! @brief Texels of repeated edge pixels around each image in the smallest level (2^(mip_levels - 1) times that in level 0)
+    int padding = 2;
+    //! @brief Levels of each page (1: no mipmaps)
+    int mip_levels = 4;
+    //! @brief The colors are sRGB encoded, so mipmaps are averaged in linear light (see pixel_ops::downsample())
+    bool srgb = true;
+    bool premultiply_alpha = false;
+};
+
+//! @brief Where an image is in a TextureAtlas
+struct atlas_region
+{
+    //! @brief Index of the page (TextureAtlas::page())
+    size_t page = 0;
+    //! @brief Pixels of the image in the page. y is the bottom row
+    int x = 0, y = 0, width = 0, height = 0;
+    //! @brief Texture coordinates of the bottom left and top right corners of the image in the page
+    float u_min = 0, v_min = 0, u_max = 1, v_max = 1;
+
+    //! @brief Turn texture coordinates of the image (@param u, @param v from 0 to 1) into texture coordinates in the page
+    constexpr void map(float& u, float& v) const
+    {
+        u = this->u_min + u * (this->u_max - this->u_min);
+        v = this->v_min + v * (this->v_max - this->v_min);
+    }
+};
+
+/// Skyline bottom-left packing: keeps the top edge of the packed rectangles as a list of horizontal segments,
+/// and puts each new rectangle where its top would be lowest (then leftmost). Only uses the CPU
+class SkylinePacker {
+public:
+    SkylinePacker(int width, int height);
+
+    //! @brief Find a place for a @param width x @param height rectangle and take it. @returns its bottom left corner, if it fits
+    std::optional<std::pair<int, int>> insert(int width, int height);
+
+    [[nodiscard]] int width() const { return this->_width; }
+    [[nodiscard]] int height() const { return this->_height; }
+    //! @brief Fraction of the area taken by rectangles (0 to 1)
+    [[nodiscard]] float occupancy() const;
+
+private:
+    struct segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+    //! @brief Sorted by x, covering the whole width
+    std::vector<segment> skyline;
+    int _width;
+    int _height;
+    size_t used_area = 0;
+
+    //! @brief Lowest y a @param width x @param height rectangle can have, starting at segment @param i. -1 if it doesn't fit there
+    [[nodiscard]] int fit(size_t i, int width, int height) const;
+};
+
+class TextureAtlas {
+public:
+    explicit TextureAtlas(atlas_options options={});
+
+    /*! @brief Pack an image (@param channels 1 to 4, rows bottom to top like Texture's). Only uses the CPU: call upload() to
+     *         see it. Adding the larger images first packs tighter.
+     *         Throws std::invalid_argument if the image (with padding) is larger than a page */
+    atlas_region add(int width, int height, int channels, const unsigned char* pixels);
+    /*! @brief Decode and pack the image at @param filename, like Texture(const char*) loads it (stbi_load, flipped if
+     *         stbi_set_flip_vertically_on_load is on). If it can't be loaded, packs TextureLoader::placeholder_color */
+    atlas_region add(const char* filename);
+
+    //! @brief Make the mipmaps of the pages that changed since the last upload, and upload them. Call on the GL thread
+    void upload();
+
+    //! @brief Bind page @param i (to the active texture unit)
+    void use(size_t i) const;
+    //! @brief Texture of page @param i. It exists after the first upload() since the page was made
+    [[nodiscard]] const Texture& page(size_t i) const;
+    [[nodiscard]] size_t page_count() const { return this->pages.size(); }
+    //! @brief Fraction of page @param i taken by images and their padding (0 to 1)
+    [[nodiscard]] float occupancy(size_t i) const;
+
+private:
+    struct atlas_page
+    {
+        //! @brief Packs slots, in blocks of 2^(mip_levels - 1) pixels
+        SkylinePacker packer;
+        //! @brief Level 0 of the page, RGBA
+        std::vector<unsigned char> pixels;
+        std::unique_ptr<Texture> texture;
+        bool dirty = true;
+    };
+
+    atlas_options options;
+    //! @brief Size of the blocks slots are aligned to
+    int block;
+    //! @brief Pixels of level 0 around each image: padding in every level
+    int gutter;
+    std::vector<atlas_page> pages;
+
+    //! @brief Copy the RGBA image @param rgba into @param page, surrounded by its edge pixels up to the slot's edges
+    void blit(atlas_page& page, const unsigned char* rgba, int width, int height, int slot_x, int slot_y, int slot_width, int slot_height) const;
+};
+
+
+#endif //OPENGL_TEXTURE_ATLAS_H
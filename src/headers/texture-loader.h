@@ -0,0 +1,146 @@
+#ifndef OPENGL_TEXTURE_LOADER_H
+#define OPENGL_TEXTURE_LOADER_H
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "texture.h"
+
+/// Loads textures without stalling the render thread: images are decoded (png.h, falling back to stbi_load) and turned into an RGBA mip chain
+/// (pixel-ops.h) by a pool of worker threads, and the levels are uploaded by upload(), on the GL thread, a few images per frame.
+///     TextureLoader loader;
+///     Texture& heart = loader.load(Resource_Path"/heart.png");
+///     while (...) { loader.upload(); heart.use(); ... }
+/// Until its image is uploaded, a texture shows a 1x1 placeholder (TextureLoader::placeholder_color),
+/// so it can be used right away. Only upload() and finish() call GL.
+
+//! @brief How an image is decoded
+struct texture_params
+{
+    //! @brief Channels to decode to (1 to 4). 0: as many as the file has
+    int channels = 0;
+    //! @brief Flip rows so the first one is the bottom of the image (what GL expects)
+    bool flip_vertically = true;
+    //! @brief Multiply the colors by alpha (before the mipmaps are made, so transparent pixels don't bleed into them)
+    bool premultiply_alpha = false;
+    pixel_ops::mip_filter mipmaps = pixel_ops::mip_filter::box;
+    //! @brief The colors are sRGB encoded (like most images), so mipmaps are averaged in linear light
+    bool srgb = true;
+
+    bool operator==(const texture_params&) const = default;
+};
+
+class TextureLoader {
+public:
+    //! @brief Called on the GL thread once the image of @param texture is uploaded, or with @param loaded false if it couldn't be decoded
+    using callback = std::function<void(Texture& texture, bool loaded)>;
+
+    //! @brief How much upload() can do in one frame. The first texture of a frame is always uploaded, even if it's bigger
+    struct budget
+    {
+        size_t bytes = 4 * 1024 * 1024;
+        double ms    = 2.0;
+    };
+
+    struct stats
+    {
+        //! @brief Waiting for a worker
+        size_t queued   = 0;
+        size_t decoding = 0;
+        //! @brief Decoded, waiting for upload()
+        size_t decoded  = 0;
+        size_t uploaded = 0;
+        size_t failed   = 0;
+        //! @brief Decoded after every other reference to the texture was dropped, so never uploaded
+        size_t dropped  = 0;
+        size_t bytes_uploaded = 0;
+        //! @brief Time spent by the workers, summed over every worker
+        double decode_ms = 0;
+        //! @brief Time spent uploading images (and deleting dropped ones) in upload() on the GL thread
+        double upload_ms = 0;
+
+        [[nodiscard]] size_t pending() const { return this->queued + this->decoding + this->decoded; }
+    };
+
+    //! @brief RGBA of the placeholder (magenta, so a missing texture stands out)
+    static constexpr unsigned char placeholder_color[4] = { 255, 0, 255, 255 };
+
+    //! @brief Start @param threads workers (0: one less than the hardware threads, at least 1)
+    explicit TextureLoader(unsigned int threads=0);
+    //! @brief Stops the workers. Images that weren't uploaded yet are dropped (their textures keep the placeholder)
+    ~TextureLoader();
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    //! @brief A new texture that shows placeholder_color. Call on the GL thread
+    static std::shared_ptr<Texture> placeholder();
+
+    /*! @brief Queue @param filename for decoding. Call on the GL thread (creates the placeholder texture).
+     *  @return the texture, valid for the life of the loader. @param on_loaded is called by upload() when it's done */
+    Texture& load(const char* filename, callback on_loaded={});
+    /*! @brief Queue @param filename for decoding into @param texture, which keeps its image until upload().
+     *         The loader holds a reference until then. If it's the last one left, the image is dropped instead (see TextureRegistry) */
+    void load(std::shared_ptr<Texture> texture, const char* filename, texture_params params, callback on_loaded={});
+
+    /*! @brief Upload decoded images until @param limit is used up, and call their callbacks. Call once per frame.
+     *  @return how many textures were uploaded */
+    size_t upload(budget limit);
+    //! @brief upload() with the default budget
+    size_t upload();
+    //! @brief Wait for every queued image and upload all of them, ignoring the budget (e.g. for a loading screen)
+    void finish();
+
+    //! @brief Number of textures that still show the placeholder (queued, decoding or decoded)
+    [[nodiscard]] size_t pending() const;
+    //! @brief Copy of the stats, taken under the lock
+    [[nodiscard]] stats counters() const;
+
+private:
+    struct request
+    {
+        std::shared_ptr<Texture> texture;
+        std::string filename;
+        texture_params params;
+        callback on_loaded;
+    };
+    struct decoded_image
+    {
+        request req;
+        //! @brief RGBA mip chain (see pixel_ops::mip_levels()). Empty if the image couldn't be decoded
+        std::vector<unsigned char> mipmaps;
+        int width = 0;
+        int height = 0;
+    };
+
+    //! @brief Textures of load(filename), which belong to the loader. Only used on the GL thread
+    std::vector<std::shared_ptr<Texture>> textures;
+
+    // -- shared with the workers. Guarded by this->mutex
+    mutable std::mutex mutex;
+    std::condition_variable request_added;
+    std::condition_variable image_decoded;
+    std::deque<request> requests;
+    std::deque<decoded_image> decoded;
+    stats loader_stats;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+
+    void work();
+    //! @brief Decode the file of @param image and make its mip chain. Runs on a worker
+    static void decode(decoded_image& image);
+    /*! @brief Upload @param image and call its callback. Doesn't lock.
+     *  @return the size of the pixels uploaded (0 if the image failed or was dropped) */
+    size_t upload_image(decoded_image& image);
+};
+
+std::ostream& operator<<(std::ostream& os, const TextureLoader::stats& stats);
+
+
+#endif //OPENGL_TEXTURE_LOADER_H
@@ -0,0 +1,106 @@
+#ifndef OPENGL_TEXTURE_REGISTRY_H
+#define OPENGL_TEXTURE_REGISTRY_H
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "texture-loader.h"
+
+/// Makes sure every image is decoded and uploaded once, however many times it's asked for.
+///     TextureRegistry textures{ texture_loader };
+///     TextureHandle heart = textures.get(Resource_Path"/heart.png");
+///     TextureHandle same  = textures.get("../../res/./heart.png");  // same texture, nothing is loaded
+/// Textures are keyed by their canonical path and texture_params, and loaded by the TextureLoader (so they show the
+/// placeholder until upload() gets to them). Asking for a texture that is still loading returns the same one.
+/// Baked textures (*.gltx, see baked-texture.h) are mapped and uploaded by get() instead, since there is nothing to decode
+/// (texture_params don't apply to them: the baker already flipped and converted them).
+/// The registry doesn't own the textures: the GL texture is deleted when the last handle is dropped.
+
+//! @brief Shared reference to a texture of a TextureRegistry
+using TextureHandle = std::shared_ptr<Texture>;
+
+class TextureRegistry {
+public:
+    struct stats
+    {
+        size_t requests = 0;
+        //! @brief Requests that got a texture that was already resident
+        size_t hits     = 0;
+        //! @brief Requests that got a texture that was still loading
+        size_t in_flight_hits = 0;
+        //! @brief Requests that started a load
+        size_t loads    = 0;
+    };
+
+    //! @brief What one texture costs (see assets())
+    struct asset
+    {
+        std::string path;
+        texture_params params;
+        //! @brief Handles held outside the registry and the loader
+        long handles;
+        //! @brief Still showing the placeholder
+        bool loading;
+        //! @brief Couldn't be decoded, so it shows the placeholder for good
+        bool failed;
+        int width;
+        int height;
+        //! @brief GPU memory (see Texture::gpu_bytes())
+        size_t bytes;
+    };
+
+    //! @brief @param loader loads the textures. The registry can be destroyed before or after it
+    explicit TextureRegistry(TextureLoader& loader);
+
+    /*! @brief The texture of @param path decoded with @param params. Starts loading it if it isn't alive.
+     *  @param on_loaded called when the image is resident (right away if it already is), or with false if it couldn't be decoded */
+    TextureHandle get(const char* path, texture_params params={}, const TextureLoader::callback& on_loaded={});
+    //! @brief The texture if it is alive, without loading it. Null otherwise
+    [[nodiscard]] TextureHandle find(const char* path, texture_params params={}) const;
+
+    //! @brief Every texture that is alive, and its memory
+    [[nodiscard]] std::vector<asset> assets() const;
+    //! @brief Sum of the gpu_bytes() of every texture that is alive
+    [[nodiscard]] size_t memory() const;
+    //! @brief Forget the textures that are no longer alive. @return how many. Also done by get()
+    size_t prune();
+
+    [[nodiscard]] const stats& counters() const { return this->registry_stats; }
+
+    //! @brief "path" made absolute and normalized, with symlinks resolved for the part that exists
+    static std::string canonical_path(const char* path);
+
+private:
+    struct key
+    {
+        std::string path;
+        texture_params params;
+
+        bool operator==(const key&) const = default;
+    };
+    struct key_hash
+    {
+        size_t operator()(const key& k) const;
+    };
+    //! @brief Shared with the loader callback, which may run after the registry is gone
+    struct entry
+    {
+        std::weak_ptr<Texture> texture;
+        bool loading = true;
+        bool loaded = false;
+        //! @brief Callbacks of the get() calls made while loading
+        std::vector<TextureLoader::callback> waiting;
+    };
+
+    TextureLoader& loader;
+    std::unordered_map<key, std::shared_ptr<entry>, key_hash> entries;
+    stats registry_stats;
+};
+
+std::ostream& operator<<(std::ostream& os, const TextureRegistry::stats& stats);
+std::ostream& operator<<(std::ostream& os, const TextureRegistry::asset& asset);
+
+
+#endif //OPENGL_TEXTURE_REGISTRY_H
@@ -2,6 +2,9 @@
 #define OPENGL_TEXTURE_H
 #include "stb_image.h"
 #include "util.h"
+#include "gl-state.h"
+#include "baked-texture.h"
+#include "pixel-ops.h"
 
 struct Texture {
 public:
@@ -9,11 +12,34 @@ public:
     vec4<float> border_col;
 
     explicit Texture(const char* filename);
+    //! @brief Create texture from decoded pixels (rows bottom to top, @param num_col_channels bytes per pixel)
+    Texture(int width, int height, int num_col_channels, const unsigned char* data);
+    //! @brief Create texture from a baked container (see baked-texture.h), uploading its mip chain from the mapped file
+    explicit Texture(const baked_texture::file& baked);
+    //! @brief Deletes gl_texture. Destroy textures before the context (glfwTerminate())
+    ~Texture();
+    // the GL texture has one owner
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+    Texture(Texture&& other) noexcept;
+    Texture& operator=(Texture&& other) noexcept;
+
+    /*! @brief Replace the image of the texture (and its mipmaps). Keeps gl_texture and the wrap and filter modes,
+     *         so anything that uses the texture gets the new image (see TextureLoader) */
+    void set_image(int width, int height, int num_col_channels, const unsigned char* data);
+    /*! @brief Replace the image and mipmaps of the texture with an RGBA mip chain made on the CPU
+     *  @param chain every level, laid out like pixel_ops::mip_levels(@param width, @param height)
+     *  @param level_count how many levels of the chain to upload (and sample from). 0: all of them */
+    void set_mipmaps(int width, int height, const unsigned char* chain, int level_count=0);
+    //! @brief Replace the image and mipmaps of the texture with the levels of @param baked
+    void set_image(const baked_texture::file& baked);
 
     [[nodiscard]] int width() const { return _width; }
     [[nodiscard]] int height() const { return _height; }
     //! @brief number of color channels
     [[nodiscard]] int num_col_channels() const { return _num_col_channels; }
+    //! @brief GPU memory of the image and its mipmaps (stored as RGBA, 4 bytes per pixel)
+    [[nodiscard]] size_t gpu_bytes() const;
 
     /*! @brief Set how the image wraps. Means when the texture coordinates go beyond the texture (beyond -1 to 1 range)
      *         Wrap in (s, t, r) -> (x, y, z) directions (z not used for 2D texture).
@@ -22,7 +48,8 @@ public:
      *         // GL_REPEAT:          Repeats the texture, like 'image-repeat: repeat' in css
      *         // GL_MIRRORED_REPEAT: Every other iteration of the repeat is mirrored (works in both x- and y-axis)
      *         // GL_CLAMP_TO_EDGE:   Repeats the last pixel at the edge of the texture
-     *         // GL_CLAMP_TO_BORDER: Use a border color. Have to set this->border_col first (default is transparent) */
+     *         // GL_CLAMP_TO_BORDER: Use a border color. Have to set this->border_col first (default is opaque black)
+     *  @brief A sampler bound to the texture unit (see sampler-cache.h) overrides this and set_filter_mode() */
     void set_wrap_mode(vec3<int> modes) const;
 
     /*! @brief Set how the image scales up and down (minifying and magnifying).
@@ -42,6 +69,9 @@ public:
     void bind() const;
 
 private:
+    //! @brief Generate gl_texture and set the default wrap and filter modes
+    void create();
+
     int _width{};
     int _height{};
     //! @brief number of color channels
@@ -0,0 +1,94 @@
+#ifndef OPENGL_VEC_STREAM_H
+#define OPENGL_VEC_STREAM_H
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "vec.h"
+#include "simd.h"
+
+/*! @brief Structure-of-arrays storage for a large number of vecs.
+ *         Every component (x, y, z, w) is kept in its own contiguous, SIMD-aligned array
+ *         so batch operations process several vecs per instruction instead of one vec per call.
+ *  @param N number of components per vec (1 to 4) */
+template<typename Type, size_t N>
+struct vec_stream
+{
+    static_assert(std::is_arithmetic_v<Type>, "vec_stream components must be numbers (char, int, float, etc..)");
+    static_assert(N >= 1 && N <= 4, "vec_stream only supports 1 to 4 components");
+
+    using value_type      = vec<Type, N>;
+    using component_array = std::vector<Type, simd::aligned_allocator<Type>>;
+
+    vec_stream() = default;
+    //! @brief Create a stream of @param count vecs with all components set to 0
+    explicit vec_stream(size_t count) { this->resize(count); }
+
+    [[nodiscard]] size_t size() const { return this->components[0].size(); }
+    void resize(size_t count);
+    void reserve(size_t count);
+    void clear();
+
+    void push_back(const value_type& v);
+    //! @brief Gather the ith vec from the component arrays
+    value_type operator[](size_t i) const;
+    //! @brief Scatter a vec into the component arrays at index i
+    void set(size_t i, const value_type& v);
+
+    //! @brief Get the contiguous array for one component. @param c 0 for x, 1 for y, 2 for z, 3 for w
+    Type*       component(unsigned char c);
+    const Type* component(unsigned char c) const;
+
+    // -- conversion from/to interleaved vertex data (the layout primitive::Shape2D takes)
+    /*! @brief Replace the contents of this stream with one attribute of an interleaved vertex array
+     *  @param src           array of vertices (e.g. position(3), color(4), tex_coord(2), position(3), ...)
+     *  @param count         how many vertices are in @param src
+     *  @param vertex_length how many floats long a single vertex is (9 for the example above)
+     *  @param offset        index of the first float of the attribute inside a vertex (3 for color in the example above) */
+    void from_interleaved(const float* src, size_t count, unsigned int vertex_length, unsigned int offset);
+    /*! @brief Write this stream into one attribute of an interleaved vertex array. Other attributes are left untouched
+     *  @param dst must have room for this->size() vertices of @param vertex_length floats */
+    void to_interleaved(float* dst, unsigned int vertex_length, unsigned int offset) const;
+    template<size_t v_size>
+    void to_interleaved(std::array<float, v_size>& dst, unsigned int vertex_length, unsigned int offset) const;
+
+    // -- batch kernels (in place)
+    //! @brief this[i] = this[i] + other[i]. @param other may be *this
+    void add(const vec_stream& other);
+    //! @brief this[i] = this[i] - other[i]. @param other may be *this
+    void sub(const vec_stream& other);
+    //! @brief this[i] = this[i] + offset (translate every vec)
+    void add(const value_type& offset);
+    //! @brief this[i] = this[i] * val
+    void scale(Type val);
+    //! @brief this[i] = this[i] / this[i].length()
+    void normalize();
+
+    // -- batch kernels (results written to @param out, which must have room for this->size() values)
+    //! @brief out[i] = this[i].dot_mult(other[i]). @param other may be *this, @param out must not be one of their components
+    void dot(const vec_stream& other, Type* out) const;
+    //! @brief out[i] = this[i].length()
+    void length(Type* out) const;
+
+    // -- reductions
+    //! @brief Smallest value of each component (e.g. the min corner of a bounding box). Stream must not be empty
+    [[nodiscard]] value_type min() const;
+    //! @brief Largest value of each component (e.g. the max corner of a bounding box). Stream must not be empty
+    [[nodiscard]] value_type max() const;
+
+private:
+    std::array<component_array, N> components;
+
+    void check_same_size(const vec_stream& other) const;
+    static value_type make(const std::array<Type, N>& c);
+};
+
+
+template<typename Type> using vec1_stream = vec_stream<Type, 1>;
+template<typename Type> using vec2_stream = vec_stream<Type, 2>;
+template<typename Type> using vec3_stream = vec_stream<Type, 3>;
+template<typename Type> using vec4_stream = vec_stream<Type, 4>;
+
+#include "../cpp/vec-stream.tpp"
+
+
+#endif //OPENGL_VEC_STREAM_H
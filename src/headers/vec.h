@@ -1,291 +1,273 @@
 #ifndef OPENGL_VEC_H
 #define OPENGL_VEC_H
 #include <stdexcept>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
+#include <type_traits>
+#include "simd.h"
+#include "constexpr-math.h"
 
 #define SQR(x) x*x
 
 // template<typename Type>
 // concept number = std::is_arithmetic_v<Type>;
 
-template<typename Type> struct vec1;
-template<typename Type> struct vec2;
-template<typename Type> struct vec3;
-template<typename Type> struct vec4;
-
-// TODO: (func decl) See src/vec.tpp Line 613
-template<typename Type> std::ostream& operator<<(std::ostream&, const vec1<Type       >&);
-                        // std::ostream& operator<<(std::ostream&, const vec1<char       >&);
-                        // std::ostream& operator<<(std::ostream&, const vec1<std::string>&);
-template<typename Type> std::ostream& operator<<(std::ostream&, const vec2<Type       >&);
-                        // std::ostream& operator<<(std::ostream&, const vec2<char       >&);
-                        // std::ostream& operator<<(std::ostream&, const vec2<std::string>&);
-template<typename Type> std::ostream& operator<<(std::ostream&, const vec3<Type       >&);
-                        // std::ostream& operator<<(std::ostream&, const vec3<char       >&);
-                        // std::ostream& operator<<(std::ostream&, const vec3<std::string>&);
-template<typename Type> std::ostream& operator<<(std::ostream&, const vec4<Type       >&);
-                        // std::ostream& operator<<(std::ostream&, const vec4<char       >&);
-                        // std::ostream& operator<<(std::ostream&, const vec4<std::string>&);
-
-
-template <typename Type>
-struct vec1
+/// A vec is N components of the same Type. vec1 to vec4 are aliases of vec<Type, 1> to vec<Type, 4>.
+///
+/// Arithmetic between vecs does not produce a vec right away. Operators return a small expression object
+/// (see vec_binary) that remembers the operands, and the whole expression is evaluated in one loop
+/// when it is assigned to a vec. So `vec3<float> r = a + b * s - c;` creates no intermediate vecs.
+/// Store results in a vec, not in `auto`: an expression keeps references to its operands.
+///
+/// Mixed sizes work like they always have: the result has as many components as the biggest operand
+/// and the Type of the left operand. Components missing from the smaller operand count as 0,
+/// e.g. vec4{ 1, 2, 3, 4 } + vec1{ 1 } is vec4{ 2, 2, 3, 4 } and vec1{ 1 } - vec2{ 1, 1 } is vec2{ 0, -1 }.
+///
+/// vec3<float> and vec4<float> are stored 16 byte aligned and their expressions are evaluated
+/// with SIMD instructions (see simd.h).
+///
+/// Everything except printing and packed() is constexpr. In constant expressions the SIMD paths
+/// are skipped and the same math is done one component at a time.
+
+template<typename Type, size_t N> struct vec;
+
+template<typename Type> using vec1 = vec<Type, 1>;
+template<typename Type> using vec2 = vec<Type, 2>;
+template<typename Type> using vec3 = vec<Type, 3>;
+template<typename Type> using vec4 = vec<Type, 4>;
+
+template<typename T>                  struct is_vec                : std::false_type {  };
+template<typename Type, size_t N>     struct is_vec<vec<Type, N>>  : std::true_type  {  };
+template<typename T> constexpr bool is_vec_v = is_vec<std::remove_cvref_t<T>>::value;
+
+/*! @brief Anything that can be evaluated component by component like a vec: a vec or an arithmetic expression of vecs.
+ *         Needs a value_type, a size (number of components), get(i) (ith component, 0 when i >= size),
+ *         packetizable and packed() (all components in a SIMD register, only used when packetizable is true) */
+template<typename E>
+concept vec_expression = requires(const E& e) {
+    typename E::value_type;
+    { E::size } -> std::convertible_to<size_t>;
+    { E::packetizable } -> std::convertible_to<bool>;
+    e.get(size_t{});
+} && (E::size > 0);
+
+//! @brief A number or a vec of the same Type, which can be used to build a vec (see vec's constructor)
+template<typename Arg, typename Type>
+concept vec_component_source = std::is_arithmetic_v<Arg> || (is_vec_v<Arg> && std::is_same_v<typename Arg::value_type, Type>);
+
+//! @brief How many components an argument adds to a vec's constructor: 1 for a number, N for a vec
+template<typename Arg> struct vec_flat_size : std::integral_constant<size_t, 1> {  };
+template<typename Type, size_t N> struct vec_flat_size<vec<Type, N>> : std::integral_constant<size_t, N> {  };
+
+
+/// --- STORAGE ---
+//! @brief The named components of a vec
+template<typename Type, size_t N> struct vec_storage;
+template<typename Type> struct vec_storage<Type, 1> { Type x; };
+template<typename Type> struct vec_storage<Type, 2> { Type x, y; };
+template<typename Type> struct vec_storage<Type, 3> { Type x, y, z; };
+template<typename Type> struct vec_storage<Type, 4> { Type x, y, z, w; };
+// stored in a single SIMD register
+template<> struct alignas(16) vec_storage<float, 3>
 {
-    Type x;
-    // TODO: (vec1) angle class [requires arithmetic<Type>] (for vec1 angle is always 0)
+    float x, y, z;
+    //! @brief 4th SIMD lane. Always kept at 0 so it never leaks into dot products or mixed vec3/vec4 operations
+    float _pad = 0.0f;
+};
+template<> struct alignas(16) vec_storage<float, 4> { float x, y, z, w; };
 
-    explicit vec1(Type _x)             : x(_x)  {  }
-    explicit vec1(const vec2<Type>& v) : x(v.x) {  }
-    explicit vec1(const vec3<Type>& v) : x(v.x) {  }
-    explicit vec1(const vec4<Type>& v) : x(v.x) {  }
 
-    //! @brief For printing a vec1 object
-    friend std::ostream& operator<<<Type       >(std::ostream&, const vec1<Type       >&);
-    // TODO: (vec1) See src/vec.tpp Line 613
-    // friend std::ostream& operator<<<char       >(std::ostream&, const vec1<char       >&);
-    // friend std::ostream& operator<<<std::string>(std::ostream&, const vec1<std::string>&);
+template<typename Type, size_t N>
+struct vec : vec_storage<Type, N>
+{
+    static_assert(N >= 1 && N <= 4, "vecs have 1 to 4 components");
+    using value_type = Type;
+    static constexpr size_t size = N;
+    //! @brief Whether the vec is stored and evaluated in a single SIMD register
+    static constexpr bool packetizable = std::is_same_v<Type, float>;
+
+    //! @brief All components are 0
+    constexpr vec() : vec_storage<Type, N>{} {  }
+
+    /*! @brief Build a vec from any mix of numbers and smaller vecs, as long as they add up to N components.
+     *         e.g. vec4<float>{ 1, 2, 3, 4 }, vec4<float>{ vec3<float>{ 1, 2, 3 }, 4 }, vec3<float>{ vec1<float>{ 1 }, 2, 3 } */
+    template<typename... Args>
+    requires (sizeof...(Args) > 0) && (vec_component_source<Args, Type> && ...) &&
+             ((vec_flat_size<Args>::value + ...) == N)
+    constexpr explicit(sizeof...(Args) == 1) vec(const Args&... args) : vec_storage<Type, N>{}
+    {
+        size_t i = 0;
+        (this->assign_flat(i, args), ...);
+    }
+
+    //! @brief Drop the components that don't fit (e.g. vec3 from vec4 keeps x, y, z)
+    template<size_t M> requires (M > N)
+    constexpr explicit vec(const vec<Type, M>& v) : vec_storage<Type, N>{} { this->assign(v); }
+
+    //! @brief Evaluate an expression (e.g. a + b * s) straight into this vec
+    template<vec_expression E> requires (!is_vec_v<E>) && (E::size == N)
+    constexpr vec(const E& e) : vec_storage<Type, N>{} { this->assign(e); } // NOLINT(google-explicit-constructor)
+    //! @brief Evaluate an expression with more components and drop the ones that don't fit
+    template<vec_expression E> requires (!is_vec_v<E>) && (E::size > N)
+    constexpr explicit vec(const E& e) : vec_storage<Type, N>{} { this->assign(e); }
+
+    //! @brief Load from a SIMD register. Lanes past N are dropped
+    explicit vec(simd::f32x4 v) requires std::is_same_v<Type, float> : vec_storage<Type, N>{} { this->assign_packed(v); }
+
+    template<vec_expression E> requires (!is_vec_v<E>) && (E::size == N)
+    constexpr vec& operator=(const E& e) { this->assign(e); return *this; }
+
+    // -- compound assignment, evaluated in place
+    template<vec_expression E> requires (E::size <= N) constexpr vec& operator+=(const E& e);
+    template<vec_expression E> requires (E::size <= N) constexpr vec& operator-=(const E& e);
+    template<typename Type2> requires std::is_arithmetic_v<Type2> constexpr vec& operator+=(const Type2& val);
+    template<typename Type2> requires std::is_arithmetic_v<Type2> constexpr vec& operator-=(const Type2& val);
+    template<typename Type2> requires std::is_arithmetic_v<Type2> constexpr vec& operator*=(const Type2& val);
+    template<typename Type2> requires std::is_arithmetic_v<Type2> constexpr vec& operator/=(const Type2& val);
 
     //! @brief The Pythagoras Theorem. Only works when the Type stored is a number (char, int, float, etc..)
-    [[nodiscard]] double length() const requires std::is_arithmetic_v<Type>;
+    [[nodiscard]] constexpr double length() const requires std::is_arithmetic_v<Type>;
 
     //! @brief Get the Unit Vector (length=1). Components Type must be a number (char, int, float, etc..)
-    [[nodiscard]] vec1<double> normalized() const requires std::is_arithmetic_v<Type>;
+    [[nodiscard]] constexpr vec<double, N> normalized() const requires std::is_arithmetic_v<Type>;
 
     //! @brief Get the ith component of this vector (like an array)
-    Type& operator[](unsigned char i);
-    Type  operator[](unsigned char i) const;
-
-    // -- vector addition
-    template<typename Type2> vec4<Type> operator+(const vec4<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator+(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec2<Type> operator+(const vec2<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec1<Type> operator+(const vec1<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar addition
-    template<typename Type2> vec1<Type> operator+(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector subtraction
-    template<typename Type2> vec4<Type> operator-(const vec4<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator-(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec2<Type> operator-(const vec2<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec1<Type> operator-(const vec1<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar subtraction
-    template<typename Type2> vec1<Type> operator-(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector division
-    //! @brief vector-scalar division
-    template<typename Type2> vec1<Type> operator/(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
+    constexpr Type& operator[](unsigned char i);
+    constexpr Type  operator[](unsigned char i) const;
+
     // -- vector multiplication
-    template<typename Type2> double dot_mult(const vec1<Type2>&)      const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar multiplication
-    template<typename Type2> vec1<Type> operator*(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
+    template<vec_expression E> requires (E::size == N)
+    constexpr double dot_mult(const E& other) const;
+    //! @brief Produces a vec that is orthogonal to both vecs. Only works with vec3
+    template<vec_expression E> requires (N == 3 && E::size == 3)
+    constexpr vec<double, 3> cross_mult(const E& other) const;
+
+    // -- expression protocol (see vec_expression)
+    //! @brief The ith component, or 0 when i >= N
+    constexpr Type get(size_t i) const;
+    //! @brief Load the components into a SIMD register. Lanes past N are 0
+    [[nodiscard]] simd::f32x4 packed() const requires std::is_same_v<Type, float>;
+
+private:
+    template<typename Arg> constexpr void assign_flat(size_t& i, const Arg& arg);
+    //! @brief Evaluate every component of an expression into this vec
+    template<typename E> constexpr void assign(const E& e);
+    void assign_packed(simd::f32x4 v) requires std::is_same_v<Type, float>;
+    constexpr Type& component(size_t i);
 };
 
 
+/// --- EXPRESSIONS ---
+//! @brief A number on the right hand side of vec-scalar arithmetic. Applies to every component
 template<typename Type>
-struct vec2
+struct vec_scalar
 {
-    Type x, y;
-    // TODO: (vec2) angle class [requires arithmetic<Type>]
-
-             vec2(const vec1<Type>& v, Type _y) : x(v.x), y(_y)  {  }
-             vec2(Type _x, Type _y)             : x(_x),  y(_y)  {  }
-    explicit vec2(const vec3<Type>& v)          : x(v.x), y(v.y) {  }
-    explicit vec2(const vec4<Type>& v)          : x(v.x), y(v.y) {  }
+    using value_type = Type;
+    static constexpr size_t size = 0;
+    static constexpr bool packetizable = true;
 
-    //! @brief For printing a vec2 object
-    friend std::ostream& operator<<<Type       >(std::ostream&, const vec2<Type       >&);
-    // TODO: (vec2) See src/vec.tpp Line 632
-    // friend std::ostream& operator<<<char       >(std::ostream&, const vec2<char       >&);
-    // friend std::ostream& operator<<<std::string>(std::ostream&, const vec2<std::string>&);
+    Type val;
 
-    // function only works when the Type stored is a number (char, int, float, etc..)
-    [[nodiscard]] double length() const requires std::is_arithmetic_v<Type>;
-
-    //! @brief Get the Unit Vector (length=1). Components Type must be a number (char, int, float, etc..)
-    [[nodiscard]] vec2<double> normalized() const requires std::is_arithmetic_v<Type>;
-
-    //! @brief Get the ith component of this vector (like an array)
-    Type& operator[](unsigned char i);
-    Type  operator[](unsigned char i) const;
-
-    // -- vector addition
-    template<typename Type2> vec4<Type> operator+(const vec4<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator+(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec2<Type> operator+(const vec2<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec2<Type> operator+(const vec1<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar addition
-    template<typename Type2> vec2<Type> operator+(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector subtraction
-    template<typename Type2> vec4<Type> operator-(const vec4<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator-(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec2<Type> operator-(const vec2<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec2<Type> operator-(const vec1<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar subtraction
-    template<typename Type2> vec2<Type> operator-(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector division
-    //! @brief vector-scalar division
-    template<typename Type2> vec2<Type> operator/(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector multiplication
-    template<typename Type2> double dot_mult(const vec2<Type2>&)      const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar multiplication
-    template<typename Type2> vec2<Type> operator*(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
+    constexpr Type get(size_t) const { return val; }
+    //! @brief @param val in the first @param n lanes, @param pad in the rest
+    [[nodiscard]] simd::f32x4 packed(size_t n, float pad) const;
 };
 
-
-template <typename Type>
-struct vec3
+// -- operations
+struct vec_add
 {
-    Type x, y, z;
-    // TODO: (vec3) angle class [requires arithmetic<Type>]
-
-             vec3(const vec1<Type>& v, Type _y, Type _z) : x(v.x), y(_y),  z(_z)  {  }
-             vec3(const vec2<Type>& v, Type _z)          : x(v.x), y(v.y), z(_z)  {  }
-             vec3(Type _x, Type _y, Type _z)             : x(_x),  y(_y),  z(_z)  {  }
-    explicit vec3(const vec4<Type>& v)                   : x(v.x), y(v.y), z(v.z) {  }
-
-    //! @brief For printing a vec3 object
-    friend std::ostream& operator<<<Type       >(std::ostream&, const vec3<Type       >&);
-    // TODO: (vec3) See src/vec.tpp Line 651
-    // friend std::ostream& operator<<<char       >(std::ostream&, const vec3<char       >&);
-    // friend std::ostream& operator<<<std::string>(std::ostream&, const vec3<std::string>&);
-
-    // function only works when the Type stored is a number (char, int, float, etc..)
-    [[nodiscard]] double length() const requires std::is_arithmetic_v<Type>;
-
-    //! @brief Get the Unit Vector (length=1). Components Type must be a number (char, int, float, etc..)
-    [[nodiscard]] vec3<double> normalized() const requires std::is_arithmetic_v<Type>;
-
-    //! @brief Get the ith component of this vector (like an array)
-    Type& operator[](unsigned char i);
-    Type  operator[](unsigned char i) const;
-
-    // -- vector addition
-    template<typename Type2> vec4<Type> operator+(const vec4<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator+(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator+(const vec2<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator+(const vec1<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar addition
-    template<typename Type2> vec3<Type> operator+(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector subtraction
-    template<typename Type2> vec4<Type> operator-(const vec4<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator-(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator-(const vec2<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec3<Type> operator-(const vec1<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar subtraction
-    template<typename Type2> vec3<Type> operator-(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector division
-    //! @brief vector-scalar division
-    template<typename Type2> vec3<Type> operator/(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                            std::is_arithmetic_v<Type2>;
-    // -- vector multiplication
-    template<typename Type2> double dot_mult(const vec3<Type2>&)      const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief Produces a vec that is orthogonal to both vecs. Only works with vec3
-    template<typename Type2> vec3<double> cross_mult(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                        std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar multiplication
-    template<typename Type2> vec3<Type> operator*(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
+    template<typename A, typename B> static constexpr auto apply(A a, B b) { return a + b; }
+    static simd::f32x4 apply(simd::f32x4 a, simd::f32x4 b) { return simd::add(a, b); }
+    //! @brief scalar value for SIMD lanes past the size of the expression, such that 0 op pad = 0
+    static constexpr float pad = 0;
 };
-
-
-template <typename Type>
-struct vec4
+struct vec_sub
 {
-    Type x, y, z, w;
-    // TODO: (vec4) angle class [requires arithmetic<Type>]
-
-    vec4(const vec1<Type>& v, Type _y, Type _z, Type _w) : x(v.x), y(_y),  z(_z),  w(_w) {  }
-    vec4(const vec2<Type>& v, Type _z, Type _w)          : x(v.x), y(v.y), z(_z),  w(_w) {  }
-    vec4(const vec3<Type>& v, Type _w)                   : x(v.x), y(v.y), z(v.z), w(_w) {  }
-    vec4(Type _x, Type _y, Type _z, Type _w)             : x(_x),  y(_y),  z(_z),  w(_w) {  }
-
-    //! @brief For printing a vec4 object
-    friend std::ostream& operator<<<Type       >(std::ostream&, const vec4<Type       >&);
-    // TODO: (vec4) See src/vec.tpp Line 670
-    // friend std::ostream& operator<<<char       >(std::ostream&, const vec4<char       >&);
-    // friend std::ostream& operator<<<std::string>(std::ostream&, const vec4<std::string>&);
-
-    // function only works when the Type stored is a number (char, int, float, etc..)
-    [[nodiscard]] double length() const requires std::is_arithmetic_v<Type>;
+    template<typename A, typename B> static constexpr auto apply(A a, B b) { return a - b; }
+    static simd::f32x4 apply(simd::f32x4 a, simd::f32x4 b) { return simd::sub(a, b); }
+    static constexpr float pad = 0;
+};
+struct vec_mul
+{
+    template<typename A, typename B> static constexpr auto apply(A a, B b) { return a * b; }
+    static simd::f32x4 apply(simd::f32x4 a, simd::f32x4 b) { return simd::mul(a, b); }
+    static constexpr float pad = 0;
+};
+struct vec_div
+{
+    template<typename A, typename B> static constexpr auto apply(A a, B b) { return a / b; }
+    static simd::f32x4 apply(simd::f32x4 a, simd::f32x4 b) { return simd::div(a, b); }
+    static constexpr float pad = 1;
+};
 
-    //! @brief Get the Unit Vector (length=1). Components Type must be a number (char, int, float, etc..)
-    [[nodiscard]] vec4<double> normalized() const requires std::is_arithmetic_v<Type>;
+//! @brief vecs are held by reference, everything else (expressions, scalars) by value
+template<typename E>
+using vec_operand = std::conditional_t<is_vec_v<E>, const E&, E>;
 
-    //! @brief Get the ith component of this vector (like an array)
-    Type& operator[](unsigned char i);
-    Type  operator[](unsigned char i) const;
-
-    // -- vector addition
-    template<typename Type2> vec4<Type> operator+(const vec4<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec4<Type> operator+(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec4<Type> operator+(const vec2<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec4<Type> operator+(const vec1<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar addition
-    template<typename Type2> vec4<Type> operator+(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector subtraction
-    template<typename Type2> vec4<Type> operator-(const vec4<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec4<Type> operator-(const vec3<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec4<Type> operator-(const vec2<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    template<typename Type2> vec4<Type> operator-(const vec1<Type2>&) const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar subtraction
-    template<typename Type2> vec4<Type> operator-(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //--  vector division
-    //! @brief vector-scalar division
-    template<typename Type2> vec4<Type> operator/(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    // -- vector multiplication
-    template<typename Type2> double dot_mult(const vec4<Type2>&)      const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
-    //! @brief vector-scalar multiplication
-    template<typename Type2> vec4<Type> operator*(const Type2&)       const requires std::is_arithmetic_v<Type>   &&
-                                                                                     std::is_arithmetic_v<Type2>;
+/*! @brief The unevaluated result of `l Op r`. Evaluating component i only evaluates component i of the operands,
+ *         so nested expressions fuse into a single loop (or a few SIMD instructions) when assigned to a vec */
+template<typename Op, typename L, typename R>
+struct vec_binary
+{
+    using value_type = typename L::value_type;
+    static constexpr size_t size = L::size > R::size ? L::size : R::size;
+    static constexpr bool packetizable = std::is_same_v<value_type, float> && L::packetizable && R::packetizable;
+
+    vec_operand<L> l;
+    vec_operand<R> r;
+
+    constexpr value_type get(size_t i) const;
+    [[nodiscard]] simd::f32x4 packed() const;
+
+    // -- same as vec, for when the result is used directly (e.g. (a + b).length())
+    //! @brief Evaluate into a vec
+    [[nodiscard]] constexpr vec<value_type, size> eval() const { return *this; }
+    constexpr value_type operator[](unsigned char i) const { return this->eval()[i]; }
+    [[nodiscard]] constexpr double length() const { return this->eval().length(); }
+    [[nodiscard]] constexpr vec<double, size> normalized() const { return this->eval().normalized(); }
+    template<vec_expression E> requires (E::size == size)
+    constexpr double dot_mult(const E& other) const { return this->eval().dot_mult(other); }
 };
 
+//! @brief Number of operators in an expression, which is how many vecs would be created if every operator returned a vec
+template<typename E> struct vec_expr_operations : std::integral_constant<size_t, 0> {  };
+template<typename Op, typename L, typename R>
+struct vec_expr_operations<vec_binary<Op, L, R>>
+    : std::integral_constant<size_t, 1 + vec_expr_operations<L>::value + vec_expr_operations<R>::value> {  };
+
+// -- vector addition
+template<vec_expression L, vec_expression R> requires std::is_arithmetic_v<typename L::value_type> &&
+                                                      std::is_arithmetic_v<typename R::value_type>
+constexpr vec_binary<vec_add, L, R> operator+(const L& l, const R& r) { return { l, r }; }
+//! @brief vector-scalar addition
+template<vec_expression L, typename Type2> requires std::is_arithmetic_v<typename L::value_type> &&
+                                                    std::is_arithmetic_v<Type2>
+constexpr vec_binary<vec_add, L, vec_scalar<Type2>> operator+(const L& l, const Type2& val) { return { l, { val } }; }
+// -- vector subtraction
+template<vec_expression L, vec_expression R> requires std::is_arithmetic_v<typename L::value_type> &&
+                                                      std::is_arithmetic_v<typename R::value_type>
+constexpr vec_binary<vec_sub, L, R> operator-(const L& l, const R& r) { return { l, r }; }
+//! @brief vector-scalar subtraction
+template<vec_expression L, typename Type2> requires std::is_arithmetic_v<typename L::value_type> &&
+                                                    std::is_arithmetic_v<Type2>
+constexpr vec_binary<vec_sub, L, vec_scalar<Type2>> operator-(const L& l, const Type2& val) { return { l, { val } }; }
+// -- vector division
+//! @brief vector-scalar division
+template<vec_expression L, typename Type2> requires std::is_arithmetic_v<typename L::value_type> &&
+                                                    std::is_arithmetic_v<Type2>
+constexpr vec_binary<vec_div, L, vec_scalar<Type2>> operator/(const L& l, const Type2& val) { return { l, { val } }; }
+// -- vector multiplication
+//! @brief vector-scalar multiplication
+template<vec_expression L, typename Type2> requires std::is_arithmetic_v<typename L::value_type> &&
+                                                    std::is_arithmetic_v<Type2>
+constexpr vec_binary<vec_mul, L, vec_scalar<Type2>> operator*(const L& l, const Type2& val) { return { l, { val } }; }
+
+
+/// --- PRINTING VECS ---
+template<typename Type, size_t N> std::ostream& operator<<(std::ostream&, const vec<Type, N>&);
+template<typename Op, typename L, typename R> std::ostream& operator<<(std::ostream&, const vec_binary<Op, L, R>&);
+
 #include "../cpp/vec.tpp"
 
 
@@ -0,0 +1,100 @@
+#ifndef OPENGL_VERTEX_QUANTIZE_H
+#define OPENGL_VERTEX_QUANTIZE_H
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <vector>
+
+/// Smaller vertices for upload: the float vertices of primitive::Shape2D and mesh_gen (36 bytes each) stored with
+/// fewer bits per value, which the GPU converts back to floats when it reads them (see Mesh's constructor that takes them).
+///     static constexpr auto circle = mesh_gen::circle<64>({ 0, 0 }, 0.5f);
+///     const vertex_quantize::vertices small = vertex_quantize::quantize(circle.vertices, circle.vertex_length);
+///     std::cout << small.stats;          // 36 -> 16 bytes per vertex, and how far the values moved
+///     Mesh mesh{ small, circle.indices };
+/// The default formats: positions as half floats, colors as 4 bytes (0 to 1), tex_coords as 16-bit 0 to 1 and
+/// normals as 10 bits per component (GL_INT_2_10_10_10_REV). Each attribute starts at a multiple of 4 bytes.
+/// Values that don't fit the format (e.g. a tex_coord of 2 with format::unorm16) are clamped, and show up in the error.
+
+namespace vertex_quantize
+{
+    enum class format
+    {
+        //! @brief Unchanged: 4 bytes per value
+        float32,
+        //! @brief 16-bit float: about 3 decimal digits, for any range
+        half,
+        //! @brief 16 bits for -1 to 1 (e.g. positions on the screen, without a projection)
+        snorm16,
+        //! @brief 16 bits for 0 to 1 (e.g. tex_coords without repeat)
+        unorm16,
+        //! @brief 8 bits for 0 to 1. Only for colors
+        unorm8,
+        //! @brief x, y and z in 10 bits for -1 to 1 and 2 unused bits: 4 bytes. Only for normals, which are normalized first
+        snorm_10_10_10_2,
+    };
+
+    /*! @brief Format of each attribute of the source vertices, which are floats in the order position(3), color(4),
+     *         tex_coord(2), normal(3). Vertices shorter than 12 floats have no normal, shorter than 9 no tex_coord, etc. */
+    struct options
+    {
+        format position  = format::half;
+        format color     = format::unorm8;
+        format tex_coord = format::unorm16;
+        format normal    = format::snorm_10_10_10_2;
+        //! @brief Vertex attribute location of the normal (position, color and tex_coord are 0, 1 and 2, like Shape2D)
+        unsigned int normal_location = 8;
+    };
+
+    //! @brief An attribute of the quantized vertices
+    struct attribute
+    {
+        format type = format::float32;
+        //! @brief Values per vertex; 0 if the source vertices don't have this attribute
+        unsigned int components = 0;
+        //! @brief Bytes from the start of a vertex
+        size_t offset = 0;
+    };
+
+    //! @brief Savings and the largest difference between a source value and its quantized one (after decoding it)
+    struct stats
+    {
+        size_t vertices     = 0;
+        size_t source_bytes = 0;
+        size_t bytes        = 0;
+        float position_error  = 0;
+        float color_error     = 0;
+        float tex_coord_error = 0;
+        //! @brief Of each component of the normalized normal
+        float normal_error    = 0;
+
+        //! @brief Part of the source bytes that was saved, 0 to 1
+        [[nodiscard]] double saved() const { return this->source_bytes > 0 ? 1.0 - (double) this->bytes / (double) this->source_bytes : 0; }
+    };
+
+    struct vertices
+    {
+        //! @brief Interleaved vertices of stride bytes
+        std::vector<std::byte> data;
+        size_t stride = 0;
+        attribute position, color, tex_coord, normal;
+        unsigned int normal_location = 8;
+        vertex_quantize::stats stats;
+    };
+
+    /*! @brief Quantize @param source, whose vertices are @param vertex_length floats (3 to 12, see options).
+     *         Throws std::invalid_argument if @param formats gives an attribute a format it can't have
+     *         (unorm8 other than for colors, snorm_10_10_10_2 other than for normals) */
+    [[nodiscard]] vertices quantize(std::span<const float> source, unsigned int vertex_length, const options& formats={});
+
+    //! @brief Nearest 16-bit float (round to nearest even). Too large values become infinity
+    [[nodiscard]] std::uint16_t to_half(float value);
+    [[nodiscard]] float from_half(std::uint16_t half);
+    //! @brief @param x, @param y and @param z (-1 to 1) in 10 bits each from the low bits, @param w (-1 to 1) in the top 2
+    [[nodiscard]] std::uint32_t pack_snorm_10_10_10_2(float x, float y, float z, float w=0);
+}
+
+std::ostream& operator<<(std::ostream& os, const vertex_quantize::stats& stats);
+
+
+#endif //OPENGL_VERTEX_QUANTIZE_H
@@ -0,0 +1,63 @@
+#version 330 core
+// Features (defined by ShaderVariants, see shader-variants.h): VERTEX_COLOR, TEXTURED, ALPHA_TEST, TEXTURE_ARRAY,
+//           TEXTURE_SLOTS, INSTANCED
+#define VARYING in
+#include "include/varyings.glsl"
+
+#if !defined(VERTEX_COLOR) && !defined(TEXTURED) && !defined(INSTANCED)
+uniform vec4 color;
+#endif
+#if defined(TEXTURED) && defined(TEXTURE_ARRAY)
+uniform sampler2DArray texture_data;
+// layer of texture_data to read
+uniform int texture_layer;
+#elif defined(TEXTURED) && defined(TEXTURE_SLOTS)
+uniform sampler2D texture_data[8];
+#elif defined(TEXTURED)
+uniform sampler2D texture_data;
+#endif
+#ifdef ALPHA_TEST
+// fragments less opaque than this are discarded
+uniform float alpha_cutoff = 0.5;
+#endif
+
+out vec4 fragment_color;
+
+#if defined(TEXTURED) && defined(TEXTURE_SLOTS)
+// GLSL 3.30 can only index an array of samplers with a constant
+vec4 read_slot(vec2 coord)
+{
+    switch (texture_slot)
+    {
+        case 0:  return texture(texture_data[0], coord);
+        case 1:  return texture(texture_data[1], coord);
+        case 2:  return texture(texture_data[2], coord);
+        case 3:  return texture(texture_data[3], coord);
+        case 4:  return texture(texture_data[4], coord);
+        case 5:  return texture(texture_data[5], coord);
+        case 6:  return texture(texture_data[6], coord);
+        default: return texture(texture_data[7], coord);
+    }
+}
+#endif
+
+void main()
+{
+#if defined(VERTEX_COLOR) || defined(INSTANCED) || !defined(TEXTURED)
+    vec4 result = color;
+#else
+    vec4 result = vec4(1.0);
+#endif
+#if defined(TEXTURED) && defined(TEXTURE_ARRAY)
+    result *= texture(texture_data, vec3(tex_coord, texture_layer));
+#elif defined(TEXTURED) && defined(TEXTURE_SLOTS)
+    result *= read_slot(tex_coord);
+#elif defined(TEXTURED)
+    result *= texture(texture_data, tex_coord);
+#endif
+#ifdef ALPHA_TEST
+    if (result.a < alpha_cutoff)
+        discard;
+#endif
+    fragment_color = result;
+}
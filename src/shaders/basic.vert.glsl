@@ -0,0 +1,48 @@
+#version 330 core
+// Features (defined by ShaderVariants, see shader-variants.h): VERTEX_COLOR, TEXTURED, ALPHA_TEST, TEXTURE_ARRAY,
+//           TEXTURE_SLOTS, INSTANCED
+layout (location = 0) in vec3 position;
+#ifdef VERTEX_COLOR
+layout (location = 1) in vec4 vert_color;
+#endif
+#ifdef TEXTURED
+layout (location = 2) in vec2 vert_tex_coord;
+#endif
+#if defined(TEXTURED) && defined(TEXTURE_SLOTS)
+layout (location = 3) in float vert_texture_slot;
+#endif
+#ifdef INSTANCED
+// one value per instance: the rows of a 2x3 transform, a color and the rectangle (min, max) tex_coord is mapped into
+layout (location = 4) in vec3 instance_transform_x;
+layout (location = 5) in vec3 instance_transform_y;
+layout (location = 6) in vec4 instance_color;
+layout (location = 7) in vec4 instance_uv_rect;
+#endif
+
+#define VARYING out
+#include "include/varyings.glsl"
+
+void main()
+{
+#ifdef INSTANCED
+    vec3 point = vec3(position.xy, 1.0);
+    gl_Position = vec4(dot(instance_transform_x, point), dot(instance_transform_y, point), position.z, 1.0);
+#else
+    gl_Position = vec4(position, 1.0);
+#endif
+#if defined(VERTEX_COLOR) && defined(INSTANCED)
+    color = vert_color * instance_color;
+#elif defined(VERTEX_COLOR)
+    color = vert_color;
+#elif defined(INSTANCED)
+    color = instance_color;
+#endif
+#if defined(TEXTURED) && defined(INSTANCED)
+    tex_coord = mix(instance_uv_rect.xy, instance_uv_rect.zw, vert_tex_coord);
+#elif defined(TEXTURED)
+    tex_coord = vert_tex_coord;
+#endif
+#if defined(TEXTURED) && defined(TEXTURE_SLOTS)
+    texture_slot = int(vert_texture_slot);
+#endif
+}
@@ -1,8 +0,0 @@
-#version 330
-in vec4 color;
-out vec4 frag_color;
-
-void main()
-{
-    frag_color = color;
-}
\ No newline at end of file
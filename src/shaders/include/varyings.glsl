@@ -0,0 +1,12 @@
+// Outputs of the vertex shader and inputs of the fragment shader.
+// Define VARYING as `out` (vertex shader) or `in` (fragment shader) before including this
+#if defined(VERTEX_COLOR) || defined(INSTANCED)
+VARYING vec4 color;
+#endif
+#ifdef TEXTURED
+VARYING vec2 tex_coord;
+#endif
+#if defined(TEXTURED) && defined(TEXTURE_SLOTS)
+// the same for the whole triangle
+flat VARYING int texture_slot;
+#endif
@@ -1,6 +0,0 @@
-#version 330 core
-out vec4 fragment_color;
-uniform vec4 color;
-void main() {
-    fragment_color = color;
-}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef OPENGL_CHECK_H
+#define OPENGL_CHECK_H
+#include <cmath>
+#include <iostream>
+#include <string_view>
+
+/// What the tests in src/tests share. Each test is an executable of its own (see CMakeLists.txt) that runs every
+/// check, prints the ones that fail, and returns check::result() from main, so ctest sees a failure as a non-zero exit.
+///     check::that(a == b, "a == b");
+///     check::near(length, 5.0, 1e-6, "length");
+///     return check::result();
+
+namespace check
+{
+    inline int failures = 0;
+
+    inline void that(bool ok, std::string_view what)
+    {
+        if (!ok)
+        {
+            failures++;
+            std::cerr << "FAILED: " << what << '\n';
+        }
+    }
+
+    //! @brief @param actual is at most @param tolerance away from @param expected (relative when @param expected is over 1)
+    inline void near(double actual, double expected, double tolerance, std::string_view what)
+    {
+        const double scale = std::abs(expected) > 1 ? std::abs(expected) : 1;
+        if (!(std::abs(actual - expected) <= tolerance * scale))
+        {
+            failures++;
+            std::cerr << "FAILED: " << what << ": " << actual << " (expected " << expected << ")\n";
+        }
+    }
+
+    inline int result()
+    {
+        if (failures > 0)
+            std::cerr << failures << " check(s) failed\n";
+        return failures > 0 ? 1 : 0;
+    }
+}
+
+
+#endif //OPENGL_CHECK_H
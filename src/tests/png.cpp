@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "png.h"
+#include "stb_image.h"
+
+/// png::decode must give exactly the pixels stbi_load_from_memory does (png.h promises it, and TextureLoader relies on it
+/// to pick either one), for every PNG in res/. res/ has a PNG of each kind the decoder has a separate path for:
+/// 8-bit RGBA (heart.png, opengl.png), 8-bit paletted with tRNS (palette.png), 4-bit paletted with rows that don't
+/// end on a byte (palette-4bit.png) and 16-bit RGBA (rgba16.png). Their rows use every filter type.
+
+int main()
+{
+    int paletted = 0, sixteen_bit = 0, images = 0;
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator{ OPENGL_RES_DIR })
+        if (entry.path().extension() == ".png")
+            paths.push_back(entry.path());
+    std::ranges::sort(paths);
+
+    for (const auto& path : paths)
+    {
+        const std::string name = path.filename().string();
+        std::vector<unsigned char> encoded;
+        {
+            std::ifstream file{ path, std::ios::binary };
+            encoded.assign(std::istreambuf_iterator<char>(file), {});
+        }
+        // bit depth and color type of IHDR
+        if (encoded.size() > 25)
+        {
+            paletted += encoded[25] == 3;
+            sixteen_bit += encoded[24] == 16;
+        }
+
+        int width, height, channels;
+        unsigned char* expected = stbi_load_from_memory(encoded.data(), (int) encoded.size(), &width, &height, &channels, 0);
+        png::image decoded;
+        const bool ok = png::decode(encoded.data(), encoded.size(), decoded);
+        check::that(expected != nullptr, name + ": stbi_load_from_memory decodes it");
+        check::that(ok, name + ": png::decode decodes it");
+        if (expected && ok)
+        {
+            check::that(decoded.width == width && decoded.height == height, name + ": same size");
+            check::that(decoded.channels == channels, name + ": same channels");
+            check::that(decoded.pixels.size() == (size_t) width * height * channels
+                        && std::memcmp(decoded.pixels.data(), expected, decoded.pixels.size()) == 0, name + ": same pixels");
+        }
+        stbi_image_free(expected);
+        images++;
+        std::cout << name << '\n';
+    }
+
+    check::that(paletted > 0, "res/ has a paletted PNG");
+    check::that(sixteen_bit > 0, "res/ has a 16-bit PNG");
+    std::cout << images << " images compared\n";
+    return check::result();
+}
@@ -0,0 +1,93 @@
+#include <string>
+#include "check.h"
+#include "vec.h"
+
+/// vec3<float> and vec4<float> evaluate with SIMD instructions at runtime and one component at a time in constant
+/// expressions (see vec.h), so every operation is done both ways here and the results must match.
+/// Element-wise arithmetic must match exactly. dot, length, normalized and cross accumulate in double when done
+/// one component at a time but in float in SIMD registers, so those only have to be within float precision.
+/// Built twice: `vec_test` uses simd.h's SIMD paths, `vec_test_no_simd` its scalar fallback (OPENGL_NO_SIMD).
+
+constexpr vec3<float> a3{ 1.5f, -2.25f, 3.0f }, b3{ 0.5f, 4.0f, -7.125f };
+constexpr vec4<float> a4{ 1.5f, -2.25f, 3.0f, 0.75f }, b4{ 0.5f, 4.0f, -7.125f, 2.5f };
+constexpr float s = 1.75f;
+
+// the operands are copied to non-const memory so the compiler must emit the runtime paths
+static vec3<float> x3 = a3, y3 = b3;
+static vec4<float> x4 = a4, y4 = b4;
+static float t = s;
+
+template<size_t N>
+static void same(const vec<float, N>& simd, const vec<float, N>& scalar, const std::string& what)
+{
+    for (unsigned char i = 0; i < N; i++)
+        check::that(simd[i] == scalar[i], what + " component " + std::to_string(i));
+}
+
+template<size_t N>
+static void near(const vec<double, N>& simd, const vec<double, N>& scalar, const std::string& what)
+{
+    for (unsigned char i = 0; i < N; i++)
+        check::near(simd[i], scalar[i], 1e-6, what + " component " + std::to_string(i));
+}
+
+static void vec3_ops()
+{
+    constexpr vec3<float> sum = a3 + b3, difference = a3 - b3, scaled = a3 * s, divided = a3 / s, shifted = a3 + s,
+                          fused = a3 + b3 * s - a3 / s;
+    same<3>(x3 + y3, sum, "vec3 + vec3");
+    same<3>(x3 - y3, difference, "vec3 - vec3");
+    same<3>(x3 * t, scaled, "vec3 * scalar");
+    same<3>(x3 / t, divided, "vec3 / scalar");
+    same<3>(x3 + t, shifted, "vec3 + scalar");
+    same<3>(x3 + y3 * t - x3 / t, fused, "vec3 fused expression");
+
+    constexpr vec3<float> compound = [] { vec3<float> v = a3; v += b3; v *= s; v -= a3; v /= s; return v; }();
+    vec3<float> v = x3;
+    v += y3; v *= t; v -= x3; v /= t;
+    same<3>(v, compound, "vec3 compound assignment");
+
+    constexpr double dot = a3.dot_mult(b3), length = a3.length();
+    check::near(x3.dot_mult(y3), dot, 1e-6, "vec3 dot_mult");
+    check::near(x3.length(), length, 1e-6, "vec3 length");
+    near<3>(x3.normalized(), a3.normalized(), "vec3 normalized");
+    near<3>(x3.cross_mult(y3), a3.cross_mult(b3), "vec3 cross_mult");
+}
+
+static void vec4_ops()
+{
+    constexpr vec4<float> sum = a4 + b4, difference = a4 - b4, scaled = a4 * s, divided = a4 / s, fused = a4 * s + b4 - a4;
+    same<4>(x4 + y4, sum, "vec4 + vec4");
+    same<4>(x4 - y4, difference, "vec4 - vec4");
+    same<4>(x4 * t, scaled, "vec4 * scalar");
+    same<4>(x4 / t, divided, "vec4 / scalar");
+    same<4>(x4 * t + y4 - x4, fused, "vec4 fused expression");
+
+    constexpr double dot = a4.dot_mult(b4), length = a4.length();
+    check::near(x4.dot_mult(y4), dot, 1e-6, "vec4 dot_mult");
+    check::near(x4.length(), length, 1e-6, "vec4 length");
+    near<4>(x4.normalized(), a4.normalized(), "vec4 normalized");
+}
+
+static void mixed_ops()
+{
+    // the 4th lane of a vec3 is 0, so it must not leak into the result
+    constexpr vec4<float> sum = a4 + b3;
+    constexpr vec3<float> truncated{ a4 - b3 };
+    same<4>(x4 + y3, sum, "vec4 + vec3");
+    same<3>(vec3<float>{ x4 - y3 }, truncated, "vec3 from vec4 - vec3");
+
+    constexpr vec3<float> dropped{ a4 };
+    const vec3<float> from_vec4{ x4 };
+    same<3>(from_vec4, dropped, "vec3 from vec4");
+    check::near(from_vec4.dot_mult(from_vec4), dropped.dot_mult(dropped), 1e-6, "vec3 from vec4 dot_mult");
+}
+
+int main()
+{
+    std::cout << "vec math: " << simd::isa() << '\n';
+    vec3_ops();
+    vec4_ops();
+    mixed_ops();
+    return check::result();
+}
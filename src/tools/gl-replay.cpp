@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+// glad must always be included before glfw
+#include "glad/glad.h"
+#include "GLFW/glfw3.h"
+#include "gl-backend.h"
+#include "gl-trace.h"
+
+/// Replays a trace captured with `OpenGL --capture <file>` (see gl-trace.h), without the application,
+/// and prints how long each GL function and each frame took.
+/// Usage: gl_replay <trace> [--null] [--from <frame>] [--repeat <n>]
+///     --null    replay with the null GL backend (no window or GPU), to measure the cost of the calls themselves
+///     --from    first frame to measure (default 1). Frames before it create the objects and are only replayed once
+///     --repeat  how many times to replay the measured frames (default 100)
+/// Frames are ended with glFinish() when replaying with a real context, so frame times include the GPU's work.
+/// Calls after the last complete frame (a trace stopped mid-frame, e.g. during teardown) are replayed once, after measuring.
+
+
+int main(int argc, char** argv)
+{
+    const char* filename = nullptr;
+    bool null = false;
+    long from = 1;
+    long repeat = 100;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--null")
+            null = true;
+        else if (arg == "--from" && has_value)
+            from = std::strtol(argv[++i], nullptr, 10);
+        else if (arg == "--repeat" && has_value)
+            repeat = std::strtol(argv[++i], nullptr, 10);
+        else if (!filename && arg[0] != '-')
+            filename = argv[i];
+        else
+        {
+            std::cerr << "Unknown argument \"" << arg << "\". See the top of src/tools/gl-replay.cpp for usage\n";
+            return 2;
+        }
+    }
+    if (!filename)
+    {
+        std::cerr << "Usage: gl_replay <trace> [--null] [--from <frame>] [--repeat <n>]\n";
+        return 2;
+    }
+
+    gl_trace::replayer trace{ filename };
+    // a partial last frame isn't measured: repeating it would replay e.g. deletes of objects the next repeat uses
+    const size_t frames = trace.frame_count() - (trace.last_frame_partial() && trace.frame_count() > 1 ? 1 : 0);
+    from = std::clamp<long>(from, 0, (long) frames - 1);
+
+    GLFWwindow* window = nullptr;
+    if (null)
+        gl_backend::install(gl_backend::mode::null);
+    else
+    {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        window = glfwCreateWindow(800, 600, "gl_replay", nullptr, nullptr);
+        if (window == nullptr)
+        {
+            std::cout << "Failed to create window. Use --null to replay without a GPU" << std::endl;
+            glfwTerminate();
+            return 1;
+        }
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
+    }
+
+    // -- frames that set up the objects
+    for (long frame = 0; frame < from; frame++)
+        trace.play_frame(frame);
+    if (!null)
+        glFinish();
+    trace.reset_timings();
+
+    // -- measured frames
+    using clock = std::chrono::steady_clock;
+    std::vector<double> frame_ms;
+    for (long r = 0; r < repeat; r++)
+        for (size_t frame = from; frame < frames; frame++)
+        {
+            const auto start = clock::now();
+            trace.play_frame(frame);
+            if (!null)
+                glFinish();
+            frame_ms.push_back((double) std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() / 1e6);
+        }
+
+    std::cout << filename << ": " << trace.frame_count() << " frames" << (frames < trace.frame_count() ? " (the last one partial)" : "")
+              << ", replayed frames " << from << ".." << frames - 1 << ' ' << repeat << " times " << (null ? "with the null backend" : "with a real context") << "\n\n";
+
+    // -- per call, most expensive first
+    const auto& timings = trace.timings();
+    std::vector<size_t> order(gl_backend::function_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&timings](size_t a, size_t b) { return timings[a].total_ns > timings[b].total_ns; });
+    std::cout << std::left << std::setw(28) << "function" << std::right << std::setw(12) << "calls"
+              << std::setw(14) << "total ms" << std::setw(12) << "ns/call" << '\n' << std::fixed;
+    for (size_t f : order)
+    {
+        const gl_trace::call_timing& t = timings[f];
+        if (t.calls == 0)
+            continue;
+        std::cout << std::left << std::setw(28) << gl_backend::function_name((gl_backend::function) f) << std::right
+                  << std::setw(12) << t.calls << std::setw(14) << std::setprecision(3) << t.total_ns / 1e6
+                  << std::setw(12) << std::setprecision(1) << t.total_ns / (double) t.calls << '\n';
+    }
+
+    // -- per frame
+    if (!frame_ms.empty())
+    {
+        const auto [min, max] = std::minmax_element(frame_ms.begin(), frame_ms.end());
+        const double mean = std::accumulate(frame_ms.begin(), frame_ms.end(), 0.0) / (double) frame_ms.size();
+        std::cout << '\n' << frame_ms.size() << " frames: min " << std::setprecision(3) << *min << " ms, mean " << mean
+                  << " ms, max " << *max << " ms (" << std::setprecision(1) << 1000 / mean << " frames/s)\n";
+    }
+
+    if (frames < trace.frame_count())
+        trace.play_frame(frames);
+    if (!null)
+        glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "stb_image.h"
+#include "baked-texture.h"
+#include "pixel-ops.h"
+
+/// Converts images into baked textures (see baked-texture.h), so the app doesn't decode them or build their mipmaps at startup.
+/// Usage: texture_baker [--no-flip] [--kaiser] [--linear] [--premultiply] [--out <dir>] <image>...
+///     --no-flip      keep the rows top to bottom. By default they are flipped, like the app's stbi_set_flip_vertically_on_load(true)
+///     --kaiser       build the mipmaps with the Kaiser filter instead of box (sharper, see pixel-ops.h)
+///     --linear       the colors are linear data (normal maps, masks...), not sRGB: average them as they are
+///     --premultiply  multiply the colors by alpha
+///     --out          directory to write the baked textures to (default: next to each image)
+/// Each image is written as <name>.gltx.
+
+
+int main(int argc, char** argv)
+{
+    bool flip = true;
+    baked_texture::options options;
+    const char* out_dir = nullptr;
+    std::vector<const char*> images;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--no-flip")
+            flip = false;
+        else if (arg == "--kaiser")
+            options.mipmaps = pixel_ops::mip_filter::kaiser;
+        else if (arg == "--linear")
+            options.srgb = false;
+        else if (arg == "--premultiply")
+            options.premultiply_alpha = true;
+        else if (arg == "--out" && i + 1 < argc)
+            out_dir = argv[++i];
+        else if (arg[0] != '-')
+            images.push_back(argv[i]);
+        else
+        {
+            std::cerr << "Unknown argument \"" << arg << "\". See the top of src/tools/texture-baker.cpp for usage\n";
+            return 2;
+        }
+    }
+    if (images.empty())
+    {
+        std::cerr << "Usage: texture_baker [--no-flip] [--kaiser] [--linear] [--premultiply] [--out <dir>] <image>...\n";
+        return 2;
+    }
+
+    stbi_set_flip_vertically_on_load(false);
+    int failed = 0;
+    for (const char* image : images)
+    {
+        std::filesystem::path out = image;
+        out.replace_extension(baked_texture::extension);
+        if (out_dir)
+            out = std::filesystem::path{ out_dir } / out.filename();
+
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(image, &width, &height, &channels, 0);
+        if (!pixels)
+        {
+            std::cerr << "Error loading image at path \"" << image << "\": " << stbi_failure_reason() << '\n';
+            failed++;
+            continue;
+        }
+        if (flip)
+            pixel_ops::flip_vertically(pixels, width, height, channels);
+        const std::vector<unsigned char> baked = baked_texture::bake(pixels, width, height, channels, options);
+        stbi_image_free(pixels);
+
+        std::ofstream file{ out, std::ios::binary | std::ios::trunc };
+        file.write((const char*) baked.data(), (std::streamsize) baked.size());
+        if (!file)
+        {
+            std::cerr << "Could not write \"" << out.string() << "\"\n";
+            failed++;
+            continue;
+        }
+        std::cout << image << " -> " << out.string() << ": " << width << "x" << height << ", " << channels
+                  << " channels, " << baked.size() / 1024 << " KiB\n";
+    }
+    return failed == 0 ? 0 : 1;
+}